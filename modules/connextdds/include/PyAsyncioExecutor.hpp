@@ -12,33 +12,209 @@
 #pragma once
 
 #include "PyConnext.hpp"
+#include <dds/domain/DomainParticipant.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace pyrti {
 
+/*
+    A pool of native threads owned by the DDS bindings that runs the
+    blocking part of the *_async APIs, so that they don't compete with the
+    application for the asyncio default executor.
+ */
+class PYRTI_SYMBOL_HIDDEN PyExecutorPool {
+public:
+    struct Metrics {
+        // Tasks submitted but not yet started
+        size_t queue_depth;
+        size_t max_queue_depth;
+        uint64_t submitted;
+        uint64_t completed;
+        // Time between submission and start of a task
+        std::chrono::nanoseconds total_queue_latency;
+        std::chrono::nanoseconds max_queue_latency;
+        // Time between start and completion of a task
+        std::chrono::nanoseconds total_run_time;
+        std::chrono::nanoseconds max_run_time;
+    };
+
+    PyExecutorPool(
+            size_t thread_count,
+            const std::string& name_prefix,
+            const std::vector<int32_t>& cpu_list);
+
+    ~PyExecutorPool();
+
+    // cancel is called instead of task if the pool is closed before task
+    // starts
+    void submit(
+            std::function<void()> task,
+            std::function<void()> cancel = nullptr);
+
+    // Stops the threads once the running tasks complete; tasks still queued
+    // are cancelled
+    void close();
+
+    bool closed() const;
+
+    size_t thread_count() const
+    {
+        return this->_thread_count;
+    }
+
+    const std::string& name_prefix() const
+    {
+        return this->_name_prefix;
+    }
+
+    const std::vector<int32_t>& cpu_list() const
+    {
+        return this->_cpu_list;
+    }
+
+    Metrics metrics() const;
+
+    void reset_metrics();
+
+    static size_t default_thread_count();
+
+    // Closes every pool still alive; called when the interpreter exits
+    static void close_all();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Task {
+        std::function<void()> func;
+        std::function<void()> cancel;
+        Clock::time_point submitted;
+    };
+
+    // Shared with the threads, which can outlive the pool when one of its
+    // own tasks closes or destroys it
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Task> queue;
+        bool closed;
+        Metrics metrics;
+    };
+
+    static void worker(
+            std::shared_ptr<State> state,
+            std::string name,
+            std::vector<int32_t> cpu_list);
+    static void configure_current_thread(
+            const std::string& name,
+            const std::vector<int32_t>& cpu_list);
+
+    size_t _thread_count;
+    std::string _name_prefix;
+    std::vector<int32_t> _cpu_list;
+    std::shared_ptr<State> _state;
+    std::vector<std::thread> _threads;
+
+    static std::mutex _pools_lock;
+    static std::vector<PyExecutorPool*> _pools;
+};
+
+
+/*
+    Completes an asyncio future with the outcome of a call made from a pool
+    thread. The call is a Python callable so that its result and any C++
+    exception are converted exactly as they would be in a regular binding.
+ */
+class PYRTI_SYMBOL_HIDDEN PyAsyncioCall {
+public:
+    PyAsyncioCall(py::object loop, py::object future, py::object call);
+
+    ~PyAsyncioCall();
+
+    void run();
+
+    // Cancels the future without making the call
+    void cancel();
+
+private:
+    py::object _loop;
+    py::object _future;
+    py::object _call;
+};
+
+
 class PYRTI_SYMBOL_HIDDEN PyAsyncioExecutor {
 public:
     template<typename T>
     static py::object run(std::function<T()> func)
     {
-        auto instance = PyAsyncioExecutor::get_instance();
-        py::object loop = instance.get_running_loop();
-        py::object run_in_executor = loop.attr("run_in_executor");
-        return run_in_executor(nullptr, std::function<T()>([func]() -> T {
-                                   py::gil_scoped_release release;
-                                   return func();
-                               }));
+        return PyAsyncioExecutor::run_in(
+                PyAsyncioExecutor::default_pool(),
+                func);
     }
 
+    // Runs in the pool selected for the participant, if any, or the default
+    template<typename T>
+    static py::object run(
+            const dds::domain::DomainParticipant& participant,
+            std::function<T()> func)
+    {
+        auto pool = PyAsyncioExecutor::participant_pool(participant);
+        if (!pool) {
+            pool = PyAsyncioExecutor::default_pool();
+        }
+        return PyAsyncioExecutor::run_in(pool, func);
+    }
+
+    static std::shared_ptr<PyExecutorPool> default_pool();
+
+    static void default_pool(std::shared_ptr<PyExecutorPool> pool);
+
+    static std::shared_ptr<PyExecutorPool> participant_pool(
+            const dds::domain::DomainParticipant& participant);
+
+    // A null pool makes the participant use the default pool again
+    static void participant_pool(
+            const dds::domain::DomainParticipant& participant,
+            std::shared_ptr<PyExecutorPool> pool);
+
 private:
     static std::unique_ptr<PyAsyncioExecutor> instance;
     static std::recursive_mutex lock;
+    static std::atomic<size_t> participant_pool_count;
     py::object asyncio;
     py::object get_running_loop;
+    std::shared_ptr<PyExecutorPool> _default_pool;
+    std::unordered_map<const void*, std::shared_ptr<PyExecutorPool>>
+            _participant_pools;
 
     PyAsyncioExecutor();
     static PyAsyncioExecutor& get_instance();
+
+    template<typename T>
+    static py::object run_in(
+            std::shared_ptr<PyExecutorPool> pool,
+            std::function<T()> func)
+    {
+        auto& instance = PyAsyncioExecutor::get_instance();
+        py::object loop = instance.get_running_loop();
+        py::object future = loop.attr("create_future")();
+        py::cpp_function call(std::function<T()>([func]() -> T {
+            py::gil_scoped_release release;
+            return func();
+        }));
+        auto state = std::make_shared<PyAsyncioCall>(loop, future, call);
+        pool->submit(
+                [state]() { state->run(); },
+                [state]() { state->cancel(); });
+        return future;
+    }
 };
 
 }  // namespace pyrti
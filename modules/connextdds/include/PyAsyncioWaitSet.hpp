@@ -0,0 +1,91 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <dds/core/cond/GuardCondition.hpp>
+#include <dds/core/cond/WaitSet.hpp>
+#include "PyCondition.hpp"
+
+namespace pyrti {
+
+/*
+    A set of conditions that can be awaited from an asyncio event loop.
+
+    A single native thread waits on a WaitSet and, when conditions trigger,
+    signals the event loop through a pipe registered with loop.add_reader.
+    Any number of coroutines can await the same AsyncioWaitSet without
+    holding an executor thread each.
+
+    Conditions stay triggered until the application acts on them, so the
+    native thread only waits again once a new wait() is pending after the
+    previous result was delivered.
+
+    If waiting on the WaitSet fails, the error is set on the pending
+    futures and on any future returned by a later wait().
+
+    Requires an event loop that supports add_reader, so it is not available
+    on Windows.
+ */
+class PYRTI_SYMBOL_HIDDEN PyAsyncioWaitSet {
+public:
+    PyAsyncioWaitSet();
+
+    ~PyAsyncioWaitSet();
+
+    void attach_condition(PyICondition& condition);
+
+    void detach_condition(PyICondition& condition);
+
+    // Returns an asyncio future completed with the triggered conditions
+    py::object wait();
+
+    // Same as wait(), cancelled with asyncio.TimeoutError after timeout
+    py::object wait(const dds::core::Duration& timeout);
+
+    void close();
+
+    bool closed();
+
+private:
+    void start(py::object& loop);
+
+    void run();
+
+    void notify_loop();
+
+    void on_readable();
+
+    dds::core::cond::WaitSet _waitset;
+    dds::core::cond::GuardCondition _wakeup;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _armed;
+    bool _stop;
+    bool _has_result;
+    std::vector<dds::core::cond::Condition> _result;
+    // Set when the native thread stops because the WaitSet failed
+    std::exception_ptr _error;
+    int _fds[2];
+    std::thread _thread;
+
+    // Only accessed from the event loop thread with the GIL held
+    py::object _loop;
+    py::object _on_readable;
+    std::vector<py::object> _futures;
+};
+
+}  // namespace pyrti
@@ -0,0 +1,165 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace pyrti {
+
+/*
+    Helpers shared by the builtin Bytes and String types to move payloads
+    between Python buffer objects (bytes, bytearray, memoryview, numpy
+    arrays...) and samples without going through a per-element conversion.
+ */
+
+// Requests a contiguous read-only view of any Python buffer as raw bytes
+inline py::buffer_info request_byte_buffer(const py::buffer& buffer)
+{
+    auto info = buffer.request();
+    if (info.ndim > 1 || (info.ndim == 1 && info.strides[0] != info.itemsize)) {
+        throw py::value_error("buffer must be contiguous");
+    }
+    if (static_cast<uint64_t>(info.size * info.itemsize)
+        > (std::numeric_limits<uint32_t>::max)()) {
+        throw py::value_error("buffer exceeds the maximum payload length");
+    }
+    return info;
+}
+
+inline size_t byte_buffer_length(const py::buffer_info& info)
+{
+    return static_cast<size_t>(info.size * info.itemsize);
+}
+
+// Number of open buffer exports of each Bytes or KeyedBytes sample,
+// guarded by the GIL
+inline std::unordered_map<const void*, size_t>& bytes_payload_exports()
+{
+    static std::unordered_map<const void*, size_t> exports;
+    return exports;
+}
+
+// Exposes the octet payload of a BytesTopicType or KeyedBytesTopicType
+// in place. Use track_bytes_payload_exports so that the payload can't be
+// resized while a view of it is open.
+template<typename T>
+py::buffer_info bytes_payload_buffer_info(T& sample)
+{
+    static uint8_t empty = 0;
+    auto length = sample.length();
+    return py::buffer_info(
+            length > 0 ? &sample[0] : &empty,
+            sizeof(uint8_t),
+            py::format_descriptor<uint8_t>::format(),
+            1,
+            { static_cast<ssize_t>(length) },
+            { static_cast<ssize_t>(sizeof(uint8_t)) });
+}
+
+// Wraps the buffer slots of a class bound with def_buffer to count the
+// exports of each sample
+template<typename T>
+void track_bytes_payload_exports(py::class_<T>& cls)
+{
+    auto buffer_procs =
+            reinterpret_cast<PyTypeObject*>(cls.ptr())->tp_as_buffer;
+    static getbufferproc base_getbuffer = buffer_procs->bf_getbuffer;
+    static releasebufferproc base_releasebuffer =
+            buffer_procs->bf_releasebuffer;
+
+    buffer_procs->bf_getbuffer = [](PyObject* obj, Py_buffer* view, int flags) {
+        if (base_getbuffer(obj, view, flags) != 0) {
+            return -1;
+        }
+        try {
+            ++bytes_payload_exports()[&py::handle(obj).cast<T&>()];
+        } catch (const py::cast_error&) {
+            base_releasebuffer(obj, view);
+            Py_CLEAR(view->obj);
+            PyErr_SetString(PyExc_BufferError, "invalid buffer exporter");
+            return -1;
+        }
+        return 0;
+    };
+    buffer_procs->bf_releasebuffer = [](PyObject* obj, Py_buffer* view) {
+        try {
+            auto& exports = bytes_payload_exports();
+            auto it = exports.find(&py::handle(obj).cast<T&>());
+            if (it != exports.end() && --it->second == 0) {
+                exports.erase(it);
+            }
+        } catch (const py::cast_error&) {
+        }
+        base_releasebuffer(obj, view);
+    };
+}
+
+// Throws BufferError if the payload would be resized while a view of it
+// is open
+template<typename T>
+void check_bytes_payload_resize(const T& sample, size_t length)
+{
+    if (length != sample.length()
+        && bytes_payload_exports().count(&sample) > 0) {
+        throw py::buffer_error(
+                "cannot resize the payload while a memoryview of it is "
+                "open");
+    }
+}
+
+// Throws BufferError if a view of the payload of the sample at this address
+// is open. Used before a sample is overwritten with a received one, whose
+// length isn't known in advance.
+inline void check_bytes_payload_unexported(const void* sample)
+{
+    auto& exports = bytes_payload_exports();
+    if (!exports.empty() && exports.count(sample) > 0) {
+        throw py::buffer_error(
+                "cannot copy a sample into one whose payload has an open "
+                "memoryview");
+    }
+}
+
+// Copies a Python buffer into the octet payload of a BytesTopicType or
+// KeyedBytesTopicType. When the length is unchanged the bytes are copied
+// straight into the existing payload; otherwise the payload is replaced.
+template<typename T, typename Setter>
+void assign_bytes_payload(T& sample, const py::buffer& buffer, Setter setter)
+{
+    auto info = request_byte_buffer(buffer);
+    auto length = byte_buffer_length(info);
+    auto data = static_cast<const uint8_t*>(info.ptr);
+    check_bytes_payload_resize(sample, length);
+    if (length > 0 && length == sample.length()) {
+        std::memmove(&sample[0], data, length);
+    } else {
+        setter(sample, std::vector<uint8_t>(data, data + length));
+    }
+}
+
+// Builds the string held by a StringTopicType or KeyedStringTopicType from
+// the bytes of a Python buffer (the encoding is not checked)
+inline dds::core::string byte_buffer_to_string(const py::buffer& buffer)
+{
+    auto info = request_byte_buffer(buffer);
+    auto length = byte_buffer_length(info);
+    auto data = static_cast<const char*>(info.ptr);
+    if (std::memchr(data, '\0', length) != nullptr) {
+        throw py::value_error("string payload cannot contain null bytes");
+    }
+    return dds::core::string(std::string(data, length));
+}
+
+}  // namespace pyrti
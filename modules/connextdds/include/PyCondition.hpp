@@ -22,6 +22,22 @@
 
 namespace pyrti {
 
+class PyTriggeredConditions {
+public:
+    PyTriggeredConditions(const std::vector<dds::core::cond::Condition>&& v)
+            : _v(v)
+    {
+    }
+
+    std::vector<dds::core::cond::Condition>& v()
+    {
+        return this->_v;
+    }
+
+private:
+    std::vector<dds::core::cond::Condition> _v;
+};
+
 class PyICondition {
 public:
     virtual dds::core::cond::Condition get_condition() = 0;
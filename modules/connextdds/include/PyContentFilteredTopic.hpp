@@ -26,7 +26,8 @@ public:
     using dds::topic::ContentFilteredTopic<T>::ContentFilteredTopic;
 
     PyContentFilteredTopic(PyTopic<T>& t, std::string& n, dds::topic::Filter& f)
-            : dds::topic::ContentFilteredTopic<T>(t, n, f)
+            : dds::topic::ContentFilteredTopic<T>(t, n, f),
+              _type_handle(t.type_handle())
     {
     }
 
@@ -130,6 +131,14 @@ public:
         auto t = dds::topic::Topic<T>(this->topic());
         t.qos(q);
     }
+
+    const PyDynamicTypeHandle<T>& type_handle() const
+    {
+        return this->_type_handle;
+    }
+
+private:
+    PyDynamicTypeHandle<T> _type_handle;
 };
 
 template<typename T>
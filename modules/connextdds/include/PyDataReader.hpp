@@ -12,6 +12,8 @@
 #pragma once
 
 #include "PyConnext.hpp"
+#include <deque>
+#include <memory>
 #include <pybind11/stl_bind.h>
 #include <pybind11/operators.h>
 #include <pybind11/functional.h>
@@ -29,6 +31,8 @@
 #include "PyContentFilteredTopic.hpp"
 #include "PyDynamicTypeMap.hpp"
 #include "PyAsyncioExecutor.hpp"
+#include "PyAsyncioWaitSet.hpp"
+#include "PyBuiltinTypeBuffer.hpp"
 
 namespace pyrti {
 
@@ -85,13 +89,20 @@ class PyDataReader : public dds::sub::DataReader<T>, public PyIDataReader {
 public:
     using dds::sub::DataReader<T>::DataReader;
 
+    PyDataReader(const PySubscriber& s, const PyTopic<T>& t)
+            : dds::sub::DataReader<T>(s, t),
+              _type_handle(t.type_handle())
+    {
+    }
+
     PyDataReader(
             const PySubscriber& s,
             const PyTopic<T>& t,
             const dds::sub::qos::DataReaderQos& q,
             PyDataReaderListenerPtr<T> l,
             const dds::core::status::StatusMask& m)
-            : dds::sub::DataReader<T>(s, t, q, l, m)
+            : dds::sub::DataReader<T>(s, t, q, l, m),
+              _type_handle(t.type_handle())
     {
         if (nullptr != l) {
             py::gil_scoped_acquire acquire;
@@ -107,7 +118,8 @@ public:
             const dds::sub::qos::DataReaderQos& q,
             PyDataReaderListenerPtr<T> l,
             const dds::core::status::StatusMask& m)
-            : dds::sub::DataReader<T>(s, t, q, l.get(), m)
+            : dds::sub::DataReader<T>(s, t, q, l.get(), m),
+              _type_handle(t.type_handle())
     {
         if (nullptr != l) {
             // switch to shared_ptr
@@ -126,7 +138,8 @@ public:
             const dds::sub::qos::DataReaderQos& q,
             PyDataReaderListenerPtr<T> l,
             const dds::core::status::StatusMask& m)
-            : dds::sub::DataReader<T>(s, t, q, l, m)
+            : dds::sub::DataReader<T>(s, t, q, l, m),
+              _type_handle(t.type_handle())
     {
         if (nullptr != l) {
             py::gil_scoped_acquire acquire;
@@ -135,6 +148,14 @@ public:
     }
 #endif
 
+    PyDataReader(
+            const PySubscriber& s,
+            const PyContentFilteredTopic<T>& t)
+            : dds::sub::DataReader<T>(s, t),
+              _type_handle(t.type_handle())
+    {
+    }
+
     virtual ~PyDataReader() {}
 
     void py_destroy_managed_resources() override
@@ -255,6 +276,15 @@ public:
     {
         return dds::sub::Query(*this, expression, params);
     }
+
+    // Only available when T is DynamicData
+    const dds::core::xtypes::DynamicType& dynamic_type() const
+    {
+        return this->_type_handle.get(*this);
+    }
+
+private:
+    PyDynamicTypeHandle<T> _type_handle;
 };
 
 
@@ -264,6 +294,291 @@ void py_destroy(PyDataReader<T>* ptr) {
 }
 
 
+/*
+    Asynchronous iterator over the samples of a DataReader.
+
+    A single ReadCondition is attached to an AsyncioWaitSet for the whole
+    lifetime of the iterator, so waiting for data does not take an executor
+    thread or create a WaitSet per batch. Samples are taken in batches of at
+    most max_batch_size into a queue bounded by queue_size; once the queue is
+    full nothing else is taken until the application consumes it, leaving
+    the remaining samples (and the resource limits that apply to them) in
+    the DataReader.
+
+    All methods are called from the event loop thread with the GIL held.
+ */
+template<typename T>
+class PyDataReaderAsyncIterator
+        : public std::enable_shared_from_this<PyDataReaderAsyncIterator<T>> {
+public:
+    PyDataReaderAsyncIterator(
+            const PyDataReader<T>& reader,
+            const dds::sub::status::DataState& state,
+            size_t max_batch_size,
+            size_t queue_size,
+            bool batches)
+            : _reader(reader),
+              _condition(dds::sub::cond::ReadCondition(reader, state)),
+              _max_batch_size(max_batch_size),
+              _queue_size(queue_size),
+              _batches(batches),
+              _wait_pending(false),
+              _closed(false)
+    {
+        if (max_batch_size == 0 || queue_size == 0) {
+            throw dds::core::InvalidArgumentError(
+                    "max_batch_size and queue_size must be greater than 0");
+        }
+        this->_waitset.attach_condition(this->_condition);
+    }
+
+    ~PyDataReaderAsyncIterator()
+    {
+        this->close();
+    }
+
+    // Returns a future completed with the next sample (or batch)
+    py::object next()
+    {
+        py::object loop =
+                py::module::import("asyncio").attr("get_running_loop")();
+        py::object future = loop.attr("create_future")();
+        if (this->_closed) {
+            future.attr("set_exception")(
+                    py::reinterpret_borrow<py::object>(
+                            PyExc_StopAsyncIteration));
+            return future;
+        }
+        this->_waiters.push_back(future);
+        this->pump();
+        return future;
+    }
+
+    void close()
+    {
+        if (this->_closed) return;
+        this->_closed = true;
+        this->_waitset.close();
+        if (Py_IsInitialized()) {
+            for (auto& waiter : this->_waiters) {
+                if (!waiter.attr("done")().template cast<bool>()) {
+                    waiter.attr("set_exception")(
+                            py::reinterpret_borrow<py::object>(
+                                    PyExc_StopAsyncIteration));
+                }
+            }
+        } else {
+            for (auto& waiter : this->_waiters) {
+                waiter.release();
+            }
+            for (auto& item : this->_queue) {
+                item.release();
+            }
+        }
+        this->_waiters.clear();
+        this->_queue.clear();
+    }
+
+    bool closed() const
+    {
+        return this->_closed;
+    }
+
+    size_t max_batch_size() const
+    {
+        return this->_max_batch_size;
+    }
+
+    size_t queue_size() const
+    {
+        return this->_queue_size;
+    }
+
+    size_t queued() const
+    {
+        return this->_queue.size();
+    }
+
+private:
+    // Hands queued samples to waiters, refills the queue and, if there is
+    // still room, waits for more data
+    void pump()
+    {
+        this->deliver();
+        while (!this->_closed && this->_queue.size() < this->_queue_size) {
+            if (this->take() == 0) break;
+            this->deliver();
+        }
+        if (!this->_closed && !this->_wait_pending
+            && this->_queue.size() < this->_queue_size) {
+            this->_wait_pending = true;
+            std::weak_ptr<PyDataReaderAsyncIterator<T>> weak =
+                    this->shared_from_this();
+            this->_waitset.wait().attr("add_done_callback")(
+                    py::cpp_function([weak](py::object future) {
+                        auto self = weak.lock();
+                        if (self) self->on_wait_done(future);
+                    }));
+        }
+    }
+
+    void deliver()
+    {
+        while (!this->_queue.empty() && !this->_waiters.empty()) {
+            py::object waiter = this->_waiters.front();
+            this->_waiters.pop_front();
+            // Skip waiters that were cancelled by the application
+            if (waiter.attr("done")().template cast<bool>()) continue;
+            waiter.attr("set_result")(this->pop());
+        }
+    }
+
+    py::object pop()
+    {
+        if (!this->_batches) {
+            py::object sample = this->_queue.front();
+            this->_queue.pop_front();
+            return sample;
+        }
+        py::list batch;
+        while (!this->_queue.empty()
+               && batch.size() < this->_max_batch_size) {
+            batch.append(this->_queue.front());
+            this->_queue.pop_front();
+        }
+        return batch;
+    }
+
+    size_t take()
+    {
+        size_t max = std::min(
+                this->_max_batch_size,
+                this->_queue_size - this->_queue.size());
+        std::vector<dds::sub::Sample<T>> samples;
+        {
+            py::gil_scoped_release release;
+            auto loaned = this->_reader.select()
+                                  .condition(this->_condition)
+                                  .max_samples(static_cast<int32_t>(max))
+                                  .take();
+            samples.reserve(loaned.length());
+            for (const auto& sample : loaned) {
+                samples.push_back(
+                        dds::sub::Sample<T>(sample.data(), sample.info()));
+            }
+        }
+        for (auto& sample : samples) {
+            this->_queue.push_back(py::cast(std::move(sample)));
+        }
+        return samples.size();
+    }
+
+    void on_wait_done(py::object& future)
+    {
+        this->_wait_pending = false;
+        if (this->_closed || future.attr("cancelled")().template cast<bool>()) {
+            return;
+        }
+        // Run through a Python callable so that DDS exceptions are
+        // translated before they are handed to the waiters
+        auto self = this->shared_from_this();
+        try {
+            future.attr("result")();
+            py::cpp_function([self]() { self->pump(); })();
+        } catch (py::error_already_set& ex) {
+            for (auto& waiter : this->_waiters) {
+                if (!waiter.attr("done")().template cast<bool>()) {
+                    waiter.attr("set_exception")(ex.value());
+                }
+            }
+            this->_waiters.clear();
+            this->close();
+        }
+    }
+
+    PyDataReader<T> _reader;
+    PyReadCondition _condition;
+    PyAsyncioWaitSet _waitset;
+    size_t _max_batch_size;
+    size_t _queue_size;
+    bool _batches;
+    bool _wait_pending;
+    bool _closed;
+    std::deque<py::object> _queue;
+    std::deque<py::object> _waiters;
+};
+
+
+// Storage for up to N elements on the stack, on the heap past that
+template<typename T, size_t N>
+class PyBoundedScratch {
+public:
+    explicit PyBoundedScratch(size_t size)
+            : _data(size <= N ? _local : new T[size]),
+              _heap(size <= N ? nullptr : _data)
+    {
+    }
+
+    T& operator[](size_t i)
+    {
+        return this->_data[i];
+    }
+
+private:
+    T _local[N];
+    T* _data;
+    std::unique_ptr<T[]> _heap;
+};
+
+
+// Reads or takes up to len(samples) samples and copies them into the
+// caller's samples and infos, reusing their storage. Returns the number of
+// samples read or taken; the data of invalid samples is left untouched.
+// Polling up to 64 samples at a time doesn't allocate.
+template<typename T>
+size_t py_loan_into(
+        PyDataReader<T>& dr,
+        py::list& samples,
+        py::list& infos,
+        bool take)
+{
+    static const size_t STACK_SAMPLES = 64;
+
+    size_t max = std::min(py::len(samples), py::len(infos));
+    if (max == 0) {
+        return 0;
+    }
+    // Check the containers before anything is taken from the reader. The
+    // objects are referenced here so that they stay alive if the lists are
+    // modified while the GIL is released.
+    PyBoundedScratch<py::object, 2 * STACK_SAMPLES> targets(2 * max);
+    PyBoundedScratch<T*, STACK_SAMPLES> data(max);
+    PyBoundedScratch<dds::sub::SampleInfo*, STACK_SAMPLES> info(max);
+    for (size_t i = 0; i < max; ++i) {
+        targets[2 * i] = samples[i];
+        data[i] = &targets[2 * i].template cast<T&>();
+        check_bytes_payload_unexported(data[i]);
+        targets[2 * i + 1] = infos[i];
+        info[i] = &targets[2 * i + 1].template cast<dds::sub::SampleInfo&>();
+    }
+    auto selector = dr.select().max_samples(static_cast<int32_t>(max));
+    // The loan is returned, when loaned is destroyed, before the GIL is
+    // reacquired and the targets are released
+    py::gil_scoped_release release;
+    dds::sub::LoanedSamples<T> loaned =
+            take ? selector.take() : selector.read();
+    size_t count = static_cast<size_t>(loaned.length());
+    for (size_t i = 0; i < count; ++i) {
+        const auto& sample = loaned[static_cast<uint32_t>(i)];
+        *info[i] = sample.info();
+        if (sample.info().valid()) {
+            *data[i] = sample.data();
+        }
+    }
+    return count;
+}
+
+
 template<typename T>
 void init_dds_typed_datareader_base_template(
         py::class_<
@@ -504,6 +819,7 @@ void init_dds_typed_datareader_base_template(
                     [](PyDataReader<T>& dr,
                        const dds::core::Duration& max_wait) {
                         return PyAsyncioExecutor::run<void>(
+                                dr.subscriber().participant(),
                                 std::function<void()>([&dr, &max_wait]() {
                                     dr.wait_for_historical_data(max_wait);
                                 }));
@@ -516,6 +832,106 @@ void init_dds_typed_datareader_base_template(
                     "that have a non-VOLATILE Durability Qos kind. This call "
                     "is "
                     "awaitable and only for use with asyncio.")
+            .def(
+                    "read_next_into",
+                    [](PyDataReader<T>& dr,
+                       T& sample,
+                       dds::sub::SampleInfo& info) {
+                        check_bytes_payload_unexported(&sample);
+                        py::gil_scoped_release release;
+                        return dr->read(sample, info);
+                    },
+                    py::arg("sample"),
+                    py::arg("info"),
+                    "Copy the next not-previously-accessed data value into "
+                    "the provided sample and SampleInfo via a read operation. "
+                    "Returns False if there was no sample to read.")
+            .def(
+                    "take_next_into",
+                    [](PyDataReader<T>& dr,
+                       T& sample,
+                       dds::sub::SampleInfo& info) {
+                        check_bytes_payload_unexported(&sample);
+                        py::gil_scoped_release release;
+                        return dr->take(sample, info);
+                    },
+                    py::arg("sample"),
+                    py::arg("info"),
+                    "Copy the next not-previously-accessed data value into "
+                    "the provided sample and SampleInfo via a take operation. "
+                    "Returns False if there was no sample to take.")
+            .def(
+                    "read_into",
+                    [](PyDataReader<T>& dr, py::list& samples, py::list& infos) {
+                        return py_loan_into(dr, samples, infos, false);
+                    },
+                    py::arg("samples"),
+                    py::arg("infos"),
+                    "Read up to len(samples) samples, copying them into the "
+                    "provided lists of samples and SampleInfos, which are "
+                    "reused across calls. Returns the number of samples "
+                    "read. The data of samples without valid data is not "
+                    "modified.")
+            .def(
+                    "take_into",
+                    [](PyDataReader<T>& dr, py::list& samples, py::list& infos) {
+                        return py_loan_into(dr, samples, infos, true);
+                    },
+                    py::arg("samples"),
+                    py::arg("infos"),
+                    "Take up to len(samples) samples, copying them into the "
+                    "provided lists of samples and SampleInfos, which are "
+                    "reused across calls. Returns the number of samples "
+                    "taken. The data of samples without valid data is not "
+                    "modified.")
+            .def(
+                    "take_async_iter",
+                    [](PyDataReader<T>& dr,
+                       const dds::sub::status::DataState& state,
+                       size_t max_batch_size,
+                       size_t queue_size) {
+                        return std::make_shared<PyDataReaderAsyncIterator<T>>(
+                                dr,
+                                state,
+                                max_batch_size,
+                                queue_size,
+                                false);
+                    },
+                    py::arg_v(
+                            "state",
+                            dds::sub::status::DataState::any(),
+                            "DataState.any"),
+                    py::arg("max_batch_size") = 32,
+                    py::arg("queue_size") = 256,
+                    "Create an asynchronous iterator that takes the samples "
+                    "matching a DataState as they are received. Samples are "
+                    "taken in batches of up to max_batch_size and at most "
+                    "queue_size samples are held by the iterator before the "
+                    "application consumes them. Only for use with asyncio.")
+            .def(
+                    "take_async_batches",
+                    [](PyDataReader<T>& dr,
+                       const dds::sub::status::DataState& state,
+                       size_t max_batch_size,
+                       size_t queue_size) {
+                        return std::make_shared<PyDataReaderAsyncIterator<T>>(
+                                dr,
+                                state,
+                                max_batch_size,
+                                queue_size,
+                                true);
+                    },
+                    py::arg_v(
+                            "state",
+                            dds::sub::status::DataState::any(),
+                            "DataState.any"),
+                    py::arg("max_batch_size") = 32,
+                    py::arg("queue_size") = 256,
+                    "Create an asynchronous iterator that yields lists of up "
+                    "to max_batch_size samples matching a DataState as they "
+                    "are received. At most queue_size samples are held by the "
+                    "iterator before the application consumes them. Only for "
+                    "use with asyncio.")
             .def_property_readonly(
                     "liveliness_changed_status",
                     [](PyDataReader<T>& dr) {
@@ -913,6 +1329,53 @@ void init_dds_typed_datareader_template(
                     "DataReader via a take operation.");
 }
 
+template<typename T>
+void init_datareader_async_iterator(
+        py::class_<
+            PyDataReaderAsyncIterator<T>,
+            std::shared_ptr<PyDataReaderAsyncIterator<T>>>& cls)
+{
+    cls.def("__aiter__",
+            [](py::object self) { return self; },
+            "Return this iterator.")
+            .def("__anext__",
+                 &PyDataReaderAsyncIterator<T>::next,
+                 "Return an awaitable for the next sample (or list of "
+                 "samples).")
+            .def("close",
+                 &PyDataReaderAsyncIterator<T>::close,
+                 "Stop iterating. Samples already taken but not yet consumed "
+                 "are discarded.")
+            .def_property_readonly(
+                    "closed",
+                    &PyDataReaderAsyncIterator<T>::closed,
+                    "Whether this iterator has been closed.")
+            .def_property_readonly(
+                    "max_batch_size",
+                    &PyDataReaderAsyncIterator<T>::max_batch_size,
+                    "The maximum number of samples taken at once.")
+            .def_property_readonly(
+                    "queue_size",
+                    &PyDataReaderAsyncIterator<T>::queue_size,
+                    "The maximum number of samples held by this iterator.")
+            .def_property_readonly(
+                    "queued",
+                    &PyDataReaderAsyncIterator<T>::queued,
+                    "The number of samples taken and not yet consumed.")
+            .def(
+                    "__enter__",
+                    [](py::object self) { return self; },
+                    "Enter a context for this iterator, to be closed on "
+                    "context exit.")
+            .def(
+                    "__exit__",
+                    [](PyDataReaderAsyncIterator<T>& it,
+                       py::object,
+                       py::object,
+                       py::object) { it.close(); },
+                    "Exit the context for this iterator, closing it.");
+}
+
 template<typename T>
 void init_datareader(
         py::class_<
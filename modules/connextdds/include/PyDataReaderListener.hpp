@@ -12,7 +12,14 @@
 #pragma once
 
 #include "PyConnext.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <dds/core/WeakReference.hpp>
 #include <dds/sub/DataReaderListener.hpp>
+#include <dds/sub/Sample.hpp>
 
 namespace pyrti {
 
@@ -334,6 +341,303 @@ public:
     }
 };
 
+/*
+    A listener that takes samples natively on the middleware thread and queues
+    them, so that Python is only entered from a dedicated dispatch thread once
+    per batch: on_data_batch is called when max_batch_size samples are pending
+    or max_delay has elapsed since the first pending sample arrived.
+
+    The queue is a lock-free stack of per-notification batches; the mutex and
+    condition variable are only used to wake up the dispatch thread. They are
+    shared with the dispatch thread, which can outlive the listener when the
+    listener is destroyed from on_data_batch.
+ */
+template<typename T>
+class PyDataReaderBatchListener : public PyNoOpDataReaderListener<T> {
+public:
+    using PyNoOpDataReaderListener<T>::on_data_available;
+
+    PyDataReaderBatchListener(
+            size_t max_batch_size,
+            const dds::core::Duration& max_delay)
+            : _state(std::make_shared<State>(
+                    max_batch_size > 0 ? max_batch_size : 1,
+                    max_delay.to_microsecs()))
+    {
+    }
+
+    virtual ~PyDataReaderBatchListener()
+    {
+        this->stop();
+    }
+
+    size_t max_batch_size() const
+    {
+        return this->_state->max_batch_size;
+    }
+
+    dds::core::Duration max_delay() const
+    {
+        return dds::core::Duration::from_microsecs(
+                this->_state->max_delay.count());
+    }
+
+    virtual void on_data_batch(PyDataReader<T>& reader, py::list& samples) = 0;
+
+    // Called on the middleware thread in place of on_data_available
+    void enqueue(dds::sub::DataReader<T>& reader)
+    {
+        auto& state = *this->_state;
+        // Once stopped, samples are left in the reader rather than dropped
+        if (state.stop.load()) return;
+
+        auto samples = reader.take();
+        if (samples.length() == 0) return;
+
+        Batch* batch = new Batch(reader);
+        batch->samples.reserve(samples.length());
+        for (size_t i = 0; i < samples.length(); ++i) {
+            auto sample = samples[i];
+            batch->samples.emplace_back(
+                    new dds::sub::Sample<T>(sample.data(), sample.info()));
+        }
+        samples.return_loan();
+
+        // Count before publishing so that the dispatch thread never
+        // subtracts samples that haven't been added yet
+        size_t count = batch->samples.size();
+        size_t previous = state.pending.fetch_add(count);
+        batch->next = state.head.load(std::memory_order_relaxed);
+        while (!state.head.compare_exchange_weak(
+                batch->next,
+                batch,
+                std::memory_order_release,
+                std::memory_order_relaxed)) {
+        }
+
+        if (previous == 0 || previous + count >= state.max_batch_size) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.stop.load()) return;
+            // Started with the first sample rather than in the constructor,
+            // so that it never calls on_data_batch before the trampoline
+            // that forwards it to Python is constructed
+            if (!this->_thread.joinable()) {
+                this->_thread = std::thread(
+                        &PyDataReaderBatchListener::run,
+                        this->_state,
+                        this);
+            }
+            state.cv.notify_one();
+        }
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_state->mutex);
+            if (this->_state->stop.load()) return;
+            this->_state->stop.store(true);
+            this->_state->cv.notify_one();
+        }
+        if (!this->_thread.joinable()) return;
+        if (std::this_thread::get_id() == this->_thread.get_id()) {
+            // Destroyed from a callback; the thread owns the shared state
+            // and exits without touching this listener again
+            this->_thread.detach();
+        } else if (PyGILState_Check()) {
+            py::gil_scoped_release release;
+            this->_thread.join();
+        } else {
+            this->_thread.join();
+        }
+    }
+
+private:
+    struct Batch {
+        Batch(dds::sub::DataReader<T>& r) : reader(r), next(nullptr)
+        {
+        }
+
+        dds::core::WeakReference<dds::sub::DataReader<T>> reader;
+        std::vector<std::unique_ptr<dds::sub::Sample<T>>> samples;
+        Batch* next;
+    };
+
+    // Returns the number of samples deleted
+    static size_t delete_batches(Batch* batch)
+    {
+        size_t count = 0;
+        while (batch != nullptr) {
+            Batch* next = batch->next;
+            count += batch->samples.size();
+            delete batch;
+            batch = next;
+        }
+        return count;
+    }
+
+    struct State {
+        State(size_t batch_size, uint64_t delay)
+                : max_batch_size(batch_size),
+                  max_delay(delay),
+                  head(nullptr),
+                  pending(0),
+                  stop(false)
+        {
+        }
+
+        ~State()
+        {
+            delete_batches(this->head.exchange(nullptr));
+        }
+
+        size_t max_batch_size;
+        std::chrono::microseconds max_delay;
+        std::atomic<Batch*> head;
+        std::atomic<size_t> pending;
+        std::atomic<bool> stop;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    // listener is only used while state->stop is false
+    static void run(
+            std::shared_ptr<State> state,
+            PyDataReaderBatchListener* listener)
+    {
+        size_t undelivered = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->cv.wait(lock, [&state]() {
+                    return state->stop.load() || state->pending.load() > 0;
+                });
+                if (!state->stop.load()
+                    && state->pending.load() < state->max_batch_size) {
+                    state->cv.wait_for(lock, state->max_delay, [&state]() {
+                        return state->stop.load()
+                                || state->pending.load()
+                                >= state->max_batch_size;
+                    });
+                }
+                if (state->stop.load()) break;
+            }
+            undelivered = dispatch(*state, listener);
+            if (undelivered > 0) break;
+        }
+
+        undelivered += delete_batches(state->head.exchange(nullptr));
+        if (undelivered > 0 && Py_IsInitialized()) {
+            py::gil_scoped_acquire acquire;
+            if (PyErr_WarnFormat(
+                        PyExc_RuntimeWarning,
+                        1,
+                        "BatchListener stopped with %zu undelivered samples",
+                        undelivered)
+                != 0) {
+                PyErr_WriteUnraisable(nullptr);
+            }
+        }
+    }
+
+    // Delivers the queued batches. If the listener is stopped, possibly by
+    // on_data_batch itself, it's not called again and the number of samples
+    // left undelivered is returned.
+    static size_t dispatch(State& state, PyDataReaderBatchListener* listener)
+    {
+        // Take everything queued so far and restore arrival order
+        Batch* batch = state.head.exchange(nullptr, std::memory_order_acquire);
+        Batch* ordered = nullptr;
+        size_t count = 0;
+        while (batch != nullptr) {
+            Batch* next = batch->next;
+            batch->next = ordered;
+            ordered = batch;
+            count += batch->samples.size();
+            batch = next;
+        }
+        state.pending.fetch_sub(count);
+        if (ordered == nullptr) return 0;
+
+        if (!Py_IsInitialized()) {
+            delete_batches(ordered);
+            return 0;
+        }
+
+        py::gil_scoped_acquire acquire;
+        batch = ordered;
+        while (batch != nullptr) {
+            if (state.stop.load()) {
+                return delete_batches(batch);
+            }
+
+            // Consecutive batches from the same reader are delivered together
+            auto reader = batch->reader.lock();
+            py::list samples;
+            Batch* next = batch;
+            while (next != nullptr && next->reader.lock() == reader) {
+                for (auto& sample : next->samples) {
+                    samples.append(py::cast(std::move(sample)));
+                }
+                Batch* done = next;
+                next = next->next;
+                delete done;
+            }
+            batch = next;
+
+            if (reader == dds::core::null) continue;
+            try {
+                PyDataReader<T> dr(reader);
+                listener->on_data_batch(dr, samples);
+            } catch (py::error_already_set& e) {
+                e.restore();
+                PyErr_WriteUnraisable(nullptr);
+            } catch (std::exception& e) {
+                PyErr_SetString(PyExc_RuntimeError, e.what());
+                PyErr_WriteUnraisable(nullptr);
+            }
+        }
+        return 0;
+    }
+
+    std::shared_ptr<State> _state;
+    std::thread _thread;
+};
+
+template<typename T>
+class PyDataReaderBatchListenerTrampoline
+        : public PyNoOpDataReaderListenerTrampoline<
+                  T,
+                  PyDataReaderBatchListener<T>> {
+public:
+    using PyNoOpDataReaderListenerTrampoline<T, PyDataReaderBatchListener<T>>::
+            PyNoOpDataReaderListenerTrampoline;
+
+    using PyNoOpDataReaderListenerTrampoline<T, PyDataReaderBatchListener<T>>::
+            on_data_available;
+
+    ~PyDataReaderBatchListenerTrampoline()
+    {
+        // The dispatch thread must not call into a partially destroyed object
+        this->stop();
+    }
+
+    void on_data_available(dds::sub::DataReader<T>& reader) override
+    {
+        this->enqueue(reader);
+    }
+
+    void on_data_batch(PyDataReader<T>& reader, py::list& samples) override
+    {
+        PYBIND11_OVERLOAD_PURE(
+                void,
+                PyDataReaderBatchListener<T>,
+                on_data_batch,
+                reader,
+                samples);
+    }
+};
+
 template<typename T>
 void init_class_defs(
         py::class_<
@@ -442,6 +746,39 @@ void init_class_defs(py::class_<
                  "Sample lost callback.");
 }
 
+template<typename T>
+void init_class_defs(py::class_<
+                     PyDataReaderBatchListener<T>,
+                     PyNoOpDataReaderListener<T>,
+                     PyDataReaderBatchListenerTrampoline<T>,
+                     std::shared_ptr<PyDataReaderBatchListener<T>>>& cls)
+{
+    cls.def(py::init<size_t, const dds::core::Duration&>(),
+            py::arg("max_batch_size") = 1024,
+            py::arg_v(
+                    "max_delay",
+                    dds::core::Duration::from_millisecs(10),
+                    "Duration.from_milliseconds(10)"),
+            "Create a listener that takes samples as they arrive and "
+            "delivers them to on_data_batch from a dispatch thread once "
+            "max_batch_size samples are pending or max_delay has elapsed "
+            "since the first one.")
+            .def("on_data_batch",
+                 &PyDataReaderBatchListener<T>::on_data_batch,
+                 py::arg("reader"),
+                 py::arg("samples"),
+                 "Batch of samples callback; samples is a list of Sample "
+                 "objects taken from the reader.")
+            .def_property_readonly(
+                    "max_batch_size",
+                    &PyDataReaderBatchListener<T>::max_batch_size,
+                    "Number of pending samples that triggers a dispatch.")
+            .def_property_readonly(
+                    "max_delay",
+                    &PyDataReaderBatchListener<T>::max_delay,
+                    "Maximum time a sample waits before being dispatched.");
+}
+
 template<typename T>
 void init_datareader_listener(
         py::class_<
@@ -452,10 +789,16 @@ void init_datareader_listener(
                 PyNoOpDataReaderListener<T>,
                 PyDataReaderListener<T>,
                 PyNoOpDataReaderListenerTrampoline<T>,
-                std::shared_ptr<PyNoOpDataReaderListener<T>>>& nodrl)
+                std::shared_ptr<PyNoOpDataReaderListener<T>>>& nodrl,
+        py::class_<
+                PyDataReaderBatchListener<T>,
+                PyNoOpDataReaderListener<T>,
+                PyDataReaderBatchListenerTrampoline<T>,
+                std::shared_ptr<PyDataReaderBatchListener<T>>>& bdrl)
 {
     init_class_defs(drl);
     init_class_defs(nodrl);
+    init_class_defs(bdrl);
 }
 
 }  // namespace pyrti
@@ -12,11 +12,13 @@
 #pragma once
 
 #include "PyConnext.hpp"
+#include <mutex>
 #include <pybind11/stl_bind.h>
 #include <pybind11/functional.h>
 #include <dds/pub/DataWriter.hpp>
 #include <dds/pub/discovery.hpp>
 #include <dds/topic/TopicInstance.hpp>
+#include <dds/core/xtypes/DynamicData.hpp>
 #include <dds/pub/find.hpp>
 #include "PyEntity.hpp"
 #include "PyAnyDataWriter.hpp"
@@ -67,6 +69,85 @@ inline PyDataWriterListenerPtr<T> downcast_dw_listener_ptr(DataWriterListenerPtr
     return downcast_listener_ptr<PyDataWriterListenerPtr<T>, DataWriterListenerPtr<T>>(l);
 }
 
+/*
+    Type-specific state kept by each PyDataWriter; empty unless specialized.
+ */
+template<typename T>
+class PyDataWriterCache {
+public:
+    void type_handle(const PyDynamicTypeHandle<T>&)
+    {
+    }
+};
+
+struct DynamicDataDictPlan;
+
+/*
+    DynamicData writers resolve their type once and keep a few scratch
+    samples and the dict conversion plan of the type for writing
+    dictionaries, so that write(dict) doesn't look up the type or its plan
+    or allocate a new sample on every call. Samples are leased so that
+    concurrent (e.g. asyncio) writes never share one.
+ */
+template<>
+class PyDataWriterCache<dds::core::xtypes::DynamicData> {
+public:
+    static const size_t MAX_POOL_SIZE = 4;
+
+    const dds::core::xtypes::DynamicType& type(
+            const dds::pub::DataWriter<dds::core::xtypes::DynamicData>& dw)
+    {
+        return this->_type.get(dw);
+    }
+
+    // Shares the type of the Topic the writer was created from
+    void type_handle(
+            const PyDynamicTypeHandle<dds::core::xtypes::DynamicData>& type)
+    {
+        this->_type = type;
+    }
+
+    std::unique_ptr<dds::core::xtypes::DynamicData> acquire_sample(
+            const dds::pub::DataWriter<dds::core::xtypes::DynamicData>& dw)
+    {
+        std::unique_ptr<dds::core::xtypes::DynamicData> sample;
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (!this->_pool.empty()) {
+                sample = std::move(this->_pool.back());
+                this->_pool.pop_back();
+            }
+        }
+        if (sample) {
+            sample->clear_all_members();
+        } else {
+            sample.reset(new dds::core::xtypes::DynamicData(this->type(dw)));
+        }
+        return sample;
+    }
+
+    void release_sample(std::unique_ptr<dds::core::xtypes::DynamicData> sample)
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        if (this->_pool.size() < MAX_POOL_SIZE) {
+            this->_pool.push_back(std::move(sample));
+        }
+    }
+
+    // Set on the first write(dict); only accessed with the GIL held
+    std::shared_ptr<DynamicDataDictPlan>& dict_plan()
+    {
+        return this->_dict_plan;
+    }
+
+private:
+    std::mutex _mutex;
+    PyDynamicTypeHandle<dds::core::xtypes::DynamicData> _type;
+    std::vector<std::unique_ptr<dds::core::xtypes::DynamicData>> _pool;
+    std::shared_ptr<DynamicDataDictPlan> _dict_plan;
+};
+
+
 template<typename T>
 class PyDataWriter : public dds::pub::DataWriter<T>,
                      public PyIAnyDataWriter,
@@ -74,6 +155,12 @@ class PyDataWriter : public dds::pub::DataWriter<T>,
 public:
     using dds::pub::DataWriter<T>::DataWriter;
 
+    PyDataWriter(const PyPublisher& p, const PyTopic<T>& t)
+            : dds::pub::DataWriter<T>(p, t)
+    {
+        this->_cache->type_handle(t.type_handle());
+    }
+
     PyDataWriter(
             const PyPublisher& p,
             const PyTopic<T>& t,
@@ -82,6 +169,7 @@ public:
             const dds::core::status::StatusMask& m)
             : dds::pub::DataWriter<T>(p, t, q, l, m)
     {
+        this->_cache->type_handle(t.type_handle());
         if (nullptr != l) {
             py::gil_scoped_acquire acquire;
             py::cast(l).inc_ref();
@@ -201,6 +289,16 @@ public:
     {
         this->delegate()->unretain();
     }
+
+    PyDataWriterCache<T>& cache()
+    {
+        return *this->_cache;
+    }
+
+private:
+    // Shared so that copies of this object see the same cache
+    std::shared_ptr<PyDataWriterCache<T>> _cache =
+            std::make_shared<PyDataWriterCache<T>>();
 };
 
 
@@ -210,6 +308,69 @@ void py_destroy(PyDataWriter<T>* ptr) {
 }
 
 
+// Vectorized instance operations: one native loop per call, meant to run
+// without the GIL. They stop at the first instance that fails.
+template<typename T>
+std::vector<dds::core::InstanceHandle> register_instances(
+        dds::pub::DataWriter<T>& dw,
+        const std::vector<T>& key_holders,
+        const dds::core::optional<dds::core::Time>& timestamp)
+{
+    std::vector<dds::core::InstanceHandle> handles;
+    handles.reserve(key_holders.size());
+    for (auto& key_holder : key_holders) {
+        handles.push_back(
+                has_value(timestamp)
+                        ? dw.register_instance(key_holder, get_value(timestamp))
+                        : dw.register_instance(key_holder));
+    }
+    return handles;
+}
+
+template<typename T>
+std::vector<dds::core::InstanceHandle> lookup_instances(
+        dds::pub::DataWriter<T>& dw,
+        const std::vector<T>& key_holders)
+{
+    std::vector<dds::core::InstanceHandle> handles;
+    handles.reserve(key_holders.size());
+    for (auto& key_holder : key_holders) {
+        handles.push_back(dw.lookup_instance(key_holder));
+    }
+    return handles;
+}
+
+template<typename T>
+void dispose_instances(
+        dds::pub::DataWriter<T>& dw,
+        const std::vector<dds::core::InstanceHandle>& handles,
+        const dds::core::optional<dds::core::Time>& timestamp)
+{
+    for (auto& handle : handles) {
+        if (has_value(timestamp)) {
+            dw.dispose_instance(handle, get_value(timestamp));
+        } else {
+            dw.dispose_instance(handle);
+        }
+    }
+}
+
+template<typename T>
+void unregister_instances(
+        dds::pub::DataWriter<T>& dw,
+        const std::vector<dds::core::InstanceHandle>& handles,
+        const dds::core::optional<dds::core::Time>& timestamp)
+{
+    for (auto& handle : handles) {
+        if (has_value(timestamp)) {
+            dw.unregister_instance(handle, get_value(timestamp));
+        } else {
+            dw.unregister_instance(handle);
+        }
+    }
+}
+
+
 template<typename T>
 void init_dds_typed_datawriter_base_template(
         py::class_<
@@ -623,6 +784,85 @@ void init_dds_typed_datawriter_base_template(
                     py::call_guard<py::gil_scoped_release>(),
                     "Retrieve the instance handle that corresponds to an instance "
                     "key_holder")
+            .def(
+                    "register_instances",
+                    [](PyDataWriter<T>& dw,
+                       const std::vector<T>& key_holders,
+                       const dds::core::optional<dds::core::Time>& timestamp) {
+                        return register_instances<T>(dw, key_holders, timestamp);
+                    },
+                    py::arg("key_holders"),
+                    py::arg("timestamp") = py::none(),
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Register the instance of each key holder and return "
+                    "their handles, in order.")
+            .def(
+                    "lookup_instances",
+                    [](PyDataWriter<T>& dw, const std::vector<T>& key_holders) {
+                        return lookup_instances<T>(dw, key_holders);
+                    },
+                    py::arg("key_holders"),
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Retrieve the instance handle of each key holder, in "
+                    "order. Unknown instances get a nil handle.")
+            .def(
+                    "dispose_instances",
+                    [](PyDataWriter<T>& dw,
+                       const std::vector<dds::core::InstanceHandle>& handles,
+                       const dds::core::optional<dds::core::Time>& timestamp)
+                            -> PyDataWriter<T>& {
+                        dispose_instances<T>(dw, handles, timestamp);
+                        return dw;
+                    },
+                    py::arg("handles"),
+                    py::arg("timestamp") = py::none(),
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Dispose a sequence of instances.")
+            .def(
+                    "dispose_instances",
+                    [](PyDataWriter<T>& dw,
+                       const std::vector<T>& key_holders,
+                       const dds::core::optional<dds::core::Time>& timestamp)
+                            -> PyDataWriter<T>& {
+                        dispose_instances<T>(
+                                dw,
+                                lookup_instances<T>(dw, key_holders),
+                                timestamp);
+                        return dw;
+                    },
+                    py::arg("key_holders"),
+                    py::arg("timestamp") = py::none(),
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Dispose the instance of each key holder.")
+            .def(
+                    "unregister_instances",
+                    [](PyDataWriter<T>& dw,
+                       const std::vector<dds::core::InstanceHandle>& handles,
+                       const dds::core::optional<dds::core::Time>& timestamp)
+                            -> PyDataWriter<T>& {
+                        unregister_instances<T>(dw, handles, timestamp);
+                        return dw;
+                    },
+                    py::arg("handles"),
+                    py::arg("timestamp") = py::none(),
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Unregister a sequence of instances.")
+            .def(
+                    "unregister_instances",
+                    [](PyDataWriter<T>& dw,
+                       const std::vector<T>& key_holders,
+                       const dds::core::optional<dds::core::Time>& timestamp)
+                            -> PyDataWriter<T>& {
+                        unregister_instances<T>(
+                                dw,
+                                lookup_instances<T>(dw, key_holders),
+                                timestamp);
+                        return dw;
+                    },
+                    py::arg("key_holders"),
+                    py::arg("timestamp") = py::none(),
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Unregister the instance of each key holder.")
             .def_property(
                     "qos",
                     [](const PyDataWriter<T>& dw) {
@@ -693,6 +933,22 @@ void init_dds_typed_datawriter_base_template(
                  "Blocks the calling thread until all data written by a "
                  "realiable DataWriter is acknowledged or until the timeout "
                  "expires.")
+            .def(
+                    "wait_for_acknowledgments_async",
+                    [](PyDataWriter<T>& dw,
+                       const dds::core::Duration& max_wait) {
+                        return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
+                                std::function<void()>([&dw, &max_wait]() {
+                                    dw.wait_for_acknowledgments(max_wait);
+                                }));
+                    },
+                    py::arg("max_wait"),
+                    py::keep_alive<0, 1>(),
+                    py::keep_alive<0, 2>(),
+                    "Wait until all data written by a reliable DataWriter is "
+                    "acknowledged or until the timeout expires. This call is "
+                    "awaitable and only for use with asyncio.")
             .def_property_readonly(
                     "listener",
                     [](PyDataWriter<T>& dw) {
@@ -834,12 +1090,14 @@ void init_dds_typed_datawriter_base_template(
                     [](PyDataWriter<T>& writer,
                        const dds::core::Duration& max_wait) {
                         return PyAsyncioExecutor::run<void>(
+                                writer.publisher().participant(),
                                 std::function<void()>([&writer, &max_wait]() {
                                     writer->wait_for_asynchronous_publishing(max_wait);
                                 }));
                     },
                     py::arg("max_wait"),
-                    py::call_guard<py::gil_scoped_release>(),
+                    py::keep_alive<0, 1>(),
+                    py::keep_alive<0, 2>(),
                     "This function is awaitable until either a timeout of "
                     "max_wait or all data written by the asynchronous "
                     "DataWriter is sent and acknowledged (if reliable) by all "
@@ -1050,6 +1308,7 @@ void init_dds_typed_datawriter_base_template(
                     "write_async",
                     [](PyDataWriter<T>& dw, const T& sample) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>([&dw, &sample]() {
                                     dw.write(sample);
                                 }));
@@ -1067,6 +1326,7 @@ void init_dds_typed_datawriter_base_template(
                        const T& sample,
                        const dds::core::Time& timestamp) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>(
                                         [&dw, &sample, &timestamp]() {
                                             dw.write(sample, timestamp);
@@ -1086,6 +1346,7 @@ void init_dds_typed_datawriter_base_template(
                        const T& sample,
                        const dds::core::InstanceHandle& handle) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>(
                                         [&dw, &sample, &handle]() {
                                             dw.write(sample, handle);
@@ -1106,6 +1367,7 @@ void init_dds_typed_datawriter_base_template(
                        const dds::core::InstanceHandle& handle,
                        const dds::core::Time& timestamp) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>(
                                         [&dw, &sample, &handle, &timestamp]() {
                                             dw.write(sample, handle, timestamp);
@@ -1126,6 +1388,7 @@ void init_dds_typed_datawriter_base_template(
                     [](PyDataWriter<T>& dw,
                        const dds::topic::TopicInstance<T>& topic_instance) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>([&dw, &topic_instance]() {
                                     dw.write(topic_instance);
                                 }));
@@ -1142,6 +1405,7 @@ void init_dds_typed_datawriter_base_template(
                        const dds::topic::TopicInstance<T>& topic_instance,
                        const dds::core::Time& timestamp) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>(
                                         [&dw, &topic_instance, &timestamp]() {
                                             dw.write(topic_instance, timestamp);
@@ -1159,6 +1423,7 @@ void init_dds_typed_datawriter_base_template(
                     "write_async",
                     [](PyDataWriter<T>& dw, const std::vector<T>& values) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>([&dw, &values]() {
                                     dw.write(values.begin(), values.end());
                                 }));
@@ -1175,6 +1440,7 @@ void init_dds_typed_datawriter_base_template(
                        const std::vector<dds::topic::TopicInstance<T>>&
                                values) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>([&dw, &values]() {
                                     for (auto ti : values) {
                                         dw.write(ti);
@@ -1193,6 +1459,7 @@ void init_dds_typed_datawriter_base_template(
                        const std::vector<T>& values,
                        const dds::core::Time& timestamp) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>(
                                         [&dw, &values, &timestamp]() {
                                             dw.write(
@@ -1215,6 +1482,7 @@ void init_dds_typed_datawriter_base_template(
                        const std::vector<dds::topic::TopicInstance<T>>& values,
                        const dds::core::Time& timestamp) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>(
                                         [&dw, &values, &timestamp]() {
                                             for (auto ti : values) {
@@ -1236,6 +1504,7 @@ void init_dds_typed_datawriter_base_template(
                        const std::vector<T>& values,
                        const std::vector<dds::core::InstanceHandle>& handles) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>(
                                         [&dw, &values, &handles]() {
                                             dw.write(
@@ -1260,6 +1529,7 @@ void init_dds_typed_datawriter_base_template(
                        const std::vector<dds::core::InstanceHandle>& handles,
                        const dds::core::Time& timestamp) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>(
                                         [&dw, &values, &handles, &timestamp]() {
                                             dw.write(
@@ -1287,6 +1557,7 @@ void init_dds_typed_datawriter_base_template(
                        const T& instance_data,
                        rti::pub::WriteParams& params) {
                         return PyAsyncioExecutor::run<void>(
+                                writer.publisher().participant(),
                                 std::function<void()>([&writer, &instance_data, &params]() {
                                     writer->write(instance_data, params);
                                 }));
@@ -1302,6 +1573,7 @@ void init_dds_typed_datawriter_base_template(
                     [](PyDataWriter<T>& dw,
                        const dds::core::InstanceHandle& h) {
                         return PyAsyncioExecutor::run<PyDataWriter<T>&>(
+                                dw.publisher().participant(),
                                 std::function<PyDataWriter<T>&()>(
                                         [&dw, &h]() -> PyDataWriter<T>& {
                                             dw.unregister_instance(h);
@@ -1318,6 +1590,7 @@ void init_dds_typed_datawriter_base_template(
                        const dds::core::InstanceHandle& h,
                        const dds::core::Time& t) {
                         return PyAsyncioExecutor::run<PyDataWriter<T>&>(
+                                dw.publisher().participant(),
                                 std::function<PyDataWriter<T>&()>(
                                         [&dw, &h, &t]() -> PyDataWriter<T>& {
                                             dw.unregister_instance(h, t);
@@ -1335,6 +1608,7 @@ void init_dds_typed_datawriter_base_template(
                     [](PyDataWriter<T>& dw,
                        const T& key_holder) {
                         return PyAsyncioExecutor::run<PyDataWriter<T>&>(
+                                dw.publisher().participant(),
                                 std::function<PyDataWriter<T>&()>(
                                         [&dw, &key_holder]() -> PyDataWriter<T>& {
                                             auto h = dw.lookup_instance(key_holder);
@@ -1352,6 +1626,7 @@ void init_dds_typed_datawriter_base_template(
                        const T& key_holder,
                        const dds::core::Time& t) {
                         return PyAsyncioExecutor::run<PyDataWriter<T>&>(
+                                dw.publisher().participant(),
                                 std::function<PyDataWriter<T>&()>(
                                         [&dw, &key_holder, &t]() -> PyDataWriter<T>& {
                                             auto h = dw.lookup_instance(key_holder);
@@ -1370,6 +1645,7 @@ void init_dds_typed_datawriter_base_template(
                     "unregister_instance_async",
                     [](PyDataWriter<T>& writer, rti::pub::WriteParams& params) {
                         return PyAsyncioExecutor::run<void>(
+                                writer.publisher().participant(),
                                 std::function<void()>(
                                         [&writer, &params]() {
                                             writer->unregister_instance(params);
@@ -1384,6 +1660,7 @@ void init_dds_typed_datawriter_base_template(
                     [](PyDataWriter<T>& dw,
                        const dds::core::InstanceHandle& h) {
                         return PyAsyncioExecutor::run<PyDataWriter<T>&>(
+                                dw.publisher().participant(),
                                 std::function<PyDataWriter<T>&()>(
                                         [&dw, &h]() -> PyDataWriter<T>& {
                                             dw.dispose_instance(h);
@@ -1400,6 +1677,7 @@ void init_dds_typed_datawriter_base_template(
                        const dds::core::InstanceHandle& h,
                        const dds::core::Time& t) {
                         return PyAsyncioExecutor::run<PyDataWriter<T>&>(
+                                dw.publisher().participant(),
                                 std::function<PyDataWriter<T>&()>(
                                         [&dw, &h, &t]() -> PyDataWriter<T>& {
                                             dw.dispose_instance(h, t);
@@ -1417,6 +1695,7 @@ void init_dds_typed_datawriter_base_template(
                     [](PyDataWriter<T>& dw,
                        const T& key_holder) {
                         return PyAsyncioExecutor::run<PyDataWriter<T>&>(
+                                dw.publisher().participant(),
                                 std::function<PyDataWriter<T>&()>(
                                         [&dw, &key_holder]() -> PyDataWriter<T>& {
                                             auto h = dw.lookup_instance(key_holder);
@@ -1434,6 +1713,7 @@ void init_dds_typed_datawriter_base_template(
                        const T& key_holder,
                        const dds::core::Time& t) {
                         return PyAsyncioExecutor::run<PyDataWriter<T>&>(
+                                dw.publisher().participant(),
                                 std::function<PyDataWriter<T>&()>(
                                         [&dw, &key_holder, &t]() -> PyDataWriter<T>& {
                                             auto h = dw.lookup_instance(key_holder);
@@ -1452,6 +1732,7 @@ void init_dds_typed_datawriter_base_template(
                     "dispose_instance_async",
                     [](PyDataWriter<T>& writer, rti::pub::WriteParams& params) {
                         return PyAsyncioExecutor::run<void>(
+                                writer.publisher().participant(),
                                 std::function<void()>(
                                         [&writer, &params]() {
                                             writer->dispose_instance(params);
@@ -0,0 +1,94 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <dds/core/xtypes/DynamicData.hpp>
+
+namespace pyrti {
+
+/*
+    A field path ("a.b[3].c") resolved against a DynamicType once, so that
+    repeated accesses on samples of that type can walk member indexes
+    directly instead of tokenizing the path and looking up names each time.
+ */
+class PyDynamicDataPath {
+public:
+    struct Step {
+        // 1-based member index (struct) or element index (array/sequence)
+        uint32_t index;
+        // Member name (empty for elements); union members are accessed by
+        // name so that the discriminator is updated
+        std::string name;
+        bool by_name;
+        // Kind of the member/element with aliases resolved
+        dds::core::xtypes::TypeKind::inner_enum kind;
+        // Content kind when the member/element is an array or sequence
+        dds::core::xtypes::TypeKind::inner_enum element_kind;
+    };
+
+    static PyDynamicDataPath compile(
+            const dds::core::xtypes::DynamicType& type,
+            const std::string& path);
+
+    const std::string& path() const
+    {
+        return this->_path;
+    }
+
+    const dds::core::xtypes::DynamicType& type() const
+    {
+        return this->_type;
+    }
+
+    const std::vector<Step>& steps() const
+    {
+        return this->_steps;
+    }
+
+    // Loans every intermediate member and returns the parent of the last step
+    dds::core::xtypes::DynamicData& resolve_parent(
+            dds::core::xtypes::DynamicData& dd,
+            std::list<rti::core::xtypes::LoanedDynamicData>& loans) const
+    {
+        dds::core::xtypes::DynamicData* current = &dd;
+        for (size_t i = 0; i + 1 < this->_steps.size(); ++i) {
+            auto& step = this->_steps[i];
+            if (step.by_name) {
+                loans.push_back(current->loan_value(step.name));
+            } else {
+                loans.push_back(current->loan_value(step.index));
+            }
+            current = &loans.back().get();
+        }
+        return *current;
+    }
+
+    const Step& last() const
+    {
+        return this->_steps.back();
+    }
+
+private:
+    PyDynamicDataPath(
+            const dds::core::xtypes::DynamicType& type,
+            const std::string& path)
+            : _type(type), _path(path)
+    {
+    }
+
+    dds::core::xtypes::DynamicType _type;
+    std::string _path;
+    std::vector<Step> _steps;
+};
+
+}  // namespace pyrti
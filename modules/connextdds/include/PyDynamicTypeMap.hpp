@@ -11,8 +11,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <dds/core/InstanceHandle.hpp>
 #include <dds/core/xtypes/DynamicType.hpp>
 #include <pybind11/pybind11.h>
@@ -20,32 +24,109 @@
 
 namespace pyrti {
 
-class PyDynamicTypeMap {
-private:
-    static std::unordered_map<std::string, dds::core::xtypes::DynamicType>
-            type_map;
+/*
+    Types registered by name from Python (Topic constructors, QosProvider).
 
+    Lookups happen from calls that have released the GIL, so the map is
+    published as an immutable snapshot: readers load the current snapshot
+    without locking, and add() copies it, inserts and swaps in the new one.
+    Types are rarely added, and entries are shared between snapshots.
+ */
+class PyDynamicTypeMap {
 public:
+    typedef std::shared_ptr<const dds::core::xtypes::DynamicType> TypePtr;
+
     static bool add(
             const std::string& name,
             const dds::core::xtypes::DynamicType& type)
     {
-        auto p = type_map.insert(
-                std::pair<std::string, dds::core::xtypes::DynamicType>(
-                        name,
-                        type));
-        return p.second;
+        std::lock_guard<std::mutex> lock(write_mutex);
+        auto current = std::atomic_load(&type_map);
+        if (current->find(name) != current->end()) {
+            return false;
+        }
+        auto next = std::make_shared<TypeMap>(*current);
+        next->emplace(
+                name,
+                std::make_shared<const dds::core::xtypes::DynamicType>(type));
+        std::atomic_store(
+                &type_map,
+                std::shared_ptr<const TypeMap>(std::move(next)));
+        return true;
     }
 
-    static dds::core::xtypes::DynamicType get(const std::string& name)
+    static TypePtr get_shared(const std::string& name)
     {
-        std::unordered_map<std::string, dds::core::xtypes::DynamicType>::
-                iterator it(type_map.find(name));
-        if (it == type_map.end())
+        auto snapshot = std::atomic_load(&type_map);
+        auto it = snapshot->find(name);
+        if (it == snapshot->end())
             throw pybind11::key_error(
-                    name + std::string("not found in type map."));
+                    name + std::string(" not found in type map."));
         return it->second;
     }
+
+    static dds::core::xtypes::DynamicType get(const std::string& name)
+    {
+        return *get_shared(name);
+    }
+
+private:
+    typedef std::unordered_map<std::string, TypePtr> TypeMap;
+
+    static std::shared_ptr<const TypeMap> type_map;
+    static std::mutex write_mutex;
+};
+
+
+/*
+    The DynamicType of a Topic, DataReader or DataWriter wrapper. Topics
+    created with a DynamicType are seeded with it, and the entities created
+    from a Topic share its handle; otherwise the type is resolved through
+    the PyDynamicTypeMap the first time it is needed. Copies of a handle
+    share the resolved type. Empty unless T is DynamicData.
+ */
+template<typename T>
+class PyDynamicTypeHandle {
+};
+
+template<>
+class PyDynamicTypeHandle<dds::core::xtypes::DynamicData> {
+public:
+    PyDynamicTypeHandle() : _slot(std::make_shared<Slot>())
+    {
+    }
+
+    template<typename Entity>
+    const dds::core::xtypes::DynamicType& get(const Entity& entity) const
+    {
+        auto type = std::atomic_load(&this->_slot->type);
+        if (!type) {
+            type = this->set(PyDynamicTypeMap::get_shared(
+                    entity->type_name()));
+        }
+        // Once set, the slot keeps the type alive for its whole lifetime
+        return *type;
+    }
+
+    // Sets the type unless it was already resolved; returns the one in use
+    PyDynamicTypeMap::TypePtr set(PyDynamicTypeMap::TypePtr type) const
+    {
+        PyDynamicTypeMap::TypePtr expected;
+        if (std::atomic_compare_exchange_strong(
+                    &this->_slot->type,
+                    &expected,
+                    type)) {
+            return type;
+        }
+        return expected;
+    }
+
+private:
+    struct Slot {
+        PyDynamicTypeMap::TypePtr type;
+    };
+
+    std::shared_ptr<Slot> _slot;
 };
 
 }  // namespace pyrti
@@ -32,7 +32,12 @@
 #include "PyContentFilter.hpp"
 #include "PyWriterContentFilter.hpp"
 #include "PyWriterContentFilterHelper.hpp"
+#include "PyWriterContentFilterBatch.hpp"
 #include "PyBindVector.hpp"
+#include "PyInstanceMap.hpp"
+#include "PyLastValueCache.hpp"
+#include "PyMergedReader.hpp"
+#include "PySampleRecorder.hpp"
 
 #if rti_connext_version_gte(6, 0, 0, 0)
     #include "PyValidLoanedSamples.hpp"
@@ -40,13 +45,14 @@
 
 namespace pyrti {
 
-template<typename T, typename... Bases>
+template<typename T, typename... Bases, typename... Extra>
 DefInitFunc init_type_class(
         py::object& parent,
         ClassInitList& l,
-        const std::string& cls_name)
+        const std::string& cls_name,
+        const Extra&... extra)
 {
-    py::class_<T, Bases...> cls(parent, cls_name.c_str());
+    py::class_<T, Bases...> cls(parent, cls_name.c_str(), extra...);
     pyrti::bind_vector<T>(parent, (cls_name + "Seq").c_str());
     py::implicitly_convertible<py::iterable, std::vector<T>>();
 
@@ -62,9 +68,15 @@ DefInitFunc init_type_class(
                 PyNoOpDataReaderListenerTrampoline<T>,
                 std::shared_ptr<PyNoOpDataReaderListener<T>>>
                 nodrl(cls, "NoOpDataReaderListener");
+        py::class_<
+                PyDataReaderBatchListener<T>,
+                PyNoOpDataReaderListener<T>,
+                PyDataReaderBatchListenerTrampoline<T>,
+                std::shared_ptr<PyDataReaderBatchListener<T>>>
+                bdrl(cls, "DataReaderBatchListener");
 
-        return ([drl, nodrl]() mutable {
-            init_datareader_listener<T>(drl, nodrl);
+        return ([drl, nodrl, bdrl]() mutable {
+            init_datareader_listener<T>(drl, nodrl, bdrl);
         });
     });
 
@@ -249,6 +261,18 @@ DefInitFunc init_type_class(
         });
     });
 
+    l.push_back([cls] {
+        py::class_<
+                typename PyWriterContentFilterBatch<T>::Base,
+                rti::topic::ContentFilter<T, dds::core::optional<py::object>>,
+                PyWriterContentFilterBatch<T>>
+                wcfb(cls, "WriterContentFilterBatch");
+
+        return ([wcfb]() mutable {
+            init_writer_content_filter_batch<T>(wcfb);
+        });
+    });
+
     l.push_back([cls] {
         py::class_<
             PyDataReader<T>,
@@ -264,6 +288,60 @@ DefInitFunc init_type_class(
         return ([dr]() mutable { init_datareader<T>(dr); });
     });
 
+    l.push_back([cls] {
+        py::class_<
+            PyDataReaderAsyncIterator<T>,
+            std::shared_ptr<PyDataReaderAsyncIterator<T>>> it(
+                cls,
+                "DataReaderAsyncIterator");
+
+        return ([it]() mutable { init_datareader_async_iterator<T>(it); });
+    });
+
+    l.push_back([cls] {
+        py::class_<PyInstanceMap<T>> im(cls, "InstanceMap");
+
+        return ([im]() mutable { init_instance_map<T>(im); });
+    });
+
+    l.push_back([cls] {
+        py::class_<
+            PyLastValueCache<T>,
+            std::unique_ptr<PyLastValueCache<T>, no_gil_delete<PyLastValueCache<T>>>> lvc(
+                cls,
+                "LastValueCache");
+
+        return ([lvc]() mutable { init_last_value_cache<T>(lvc); });
+    });
+
+    l.push_back([cls] {
+        py::class_<PyMergedReader<T>, std::shared_ptr<PyMergedReader<T>>> mr(
+                cls,
+                "MergedReader");
+
+        return ([mr]() mutable { init_merged_reader<T>(mr); });
+    });
+
+    l.push_back([cls] {
+        py::class_<
+            PySampleRecorder<T>,
+            std::unique_ptr<PySampleRecorder<T>, no_gil_delete<PySampleRecorder<T>>>> sr(
+                cls,
+                "SampleRecorder");
+
+        return ([sr]() mutable { init_sample_recorder<T>(sr); });
+    });
+
+    l.push_back([cls] {
+        py::class_<
+            PySampleReplayer<T>,
+            std::unique_ptr<PySampleReplayer<T>, no_gil_delete<PySampleReplayer<T>>>> sp(
+                cls,
+                "SampleReplayer");
+
+        return ([sp]() mutable { init_sample_replayer<T>(sp); });
+    });
+
     l.push_back([cls] {
         py::class_<
             PyDataWriter<T>,
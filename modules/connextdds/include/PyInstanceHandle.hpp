@@ -0,0 +1,33 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <dds/core/InstanceHandle.hpp>
+
+namespace pyrti {
+
+// Hash of the instance's key hash, consistent with InstanceHandle equality
+struct PyInstanceHandleHash {
+    std::size_t operator()(const dds::core::InstanceHandle& handle) const
+    {
+        const DDS_InstanceHandle_t& native = handle->native();
+        uint64_t hash = 14695981039346656037ULL;
+        for (DDS_UnsignedLong i = 0; i < native.keyHash.length; ++i) {
+            hash ^= native.keyHash.value[i];
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+}  // namespace pyrti
@@ -0,0 +1,222 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <unordered_map>
+#include <dds/sub/LoanedSamples.hpp>
+#include "PyInstanceHandle.hpp"
+
+namespace pyrti {
+
+/*
+    Maps the instances of a type to Python objects, hashing the handles'
+    key hashes natively. update() stores the data of a whole loan in one
+    call.
+ */
+template<typename T>
+class PyInstanceMap {
+public:
+    typedef std::unordered_map<
+            dds::core::InstanceHandle,
+            py::object,
+            PyInstanceHandleHash>
+            Map;
+
+    py::object get(const dds::core::InstanceHandle& handle) const
+    {
+        auto it = this->_map.find(handle);
+        if (it == this->_map.end()) {
+            throw py::key_error("instance not in map");
+        }
+        return it->second;
+    }
+
+    py::object get(
+            const dds::core::InstanceHandle& handle,
+            py::object default_value) const
+    {
+        auto it = this->_map.find(handle);
+        return it == this->_map.end() ? default_value : it->second;
+    }
+
+    void set(const dds::core::InstanceHandle& handle, py::object value)
+    {
+        if (handle.is_nil()) {
+            throw dds::core::InvalidArgumentError("nil instance handle");
+        }
+        this->_map[handle] = value;
+    }
+
+    void erase(const dds::core::InstanceHandle& handle)
+    {
+        if (this->_map.erase(handle) == 0) {
+            throw py::key_error("instance not in map");
+        }
+    }
+
+    py::object pop(
+            const dds::core::InstanceHandle& handle,
+            py::object default_value)
+    {
+        auto it = this->_map.find(handle);
+        if (it == this->_map.end()) return default_value;
+        auto value = it->second;
+        this->_map.erase(it);
+        return value;
+    }
+
+    bool contains(const dds::core::InstanceHandle& handle) const
+    {
+        return this->_map.count(handle) > 0;
+    }
+
+    size_t size() const
+    {
+        return this->_map.size();
+    }
+
+    void clear()
+    {
+        this->_map.clear();
+    }
+
+    const Map& map() const
+    {
+        return this->_map;
+    }
+
+    // Stores the data of each valid sample under its instance and, if
+    // remove_not_alive, removes the disposed and unregistered instances.
+    // Returns the number of entries stored or removed.
+    size_t update(
+            const dds::sub::LoanedSamples<T>& samples,
+            bool remove_not_alive)
+    {
+        size_t count = 0;
+        for (const auto& sample : samples) {
+            auto& info = sample.info();
+            if (remove_not_alive
+                && info.state().instance_state()
+                        != dds::sub::status::InstanceState::alive()) {
+                count += this->_map.erase(info.instance_handle());
+            } else if (info.valid()) {
+                this->_map[info.instance_handle()] = py::cast(sample.data());
+                ++count;
+            }
+        }
+        return count;
+    }
+
+private:
+    Map _map;
+};
+
+
+template<typename T>
+void init_instance_map(py::class_<PyInstanceMap<T>>& cls)
+{
+    cls.def(py::init<>(), "Create an empty InstanceMap.")
+            .def("__getitem__",
+                 (py::object(PyInstanceMap<T>::*)(
+                         const dds::core::InstanceHandle&) const)
+                         & PyInstanceMap<T>::get,
+                 py::arg("handle"),
+                 "Get the value of an instance.")
+            .def("__setitem__",
+                 &PyInstanceMap<T>::set,
+                 py::arg("handle"),
+                 py::arg("value"),
+                 "Set the value of an instance.")
+            .def("__delitem__",
+                 &PyInstanceMap<T>::erase,
+                 py::arg("handle"),
+                 "Remove an instance.")
+            .def("__contains__",
+                 &PyInstanceMap<T>::contains,
+                 py::arg("handle"),
+                 "Whether the map has a value for an instance.")
+            .def("__len__",
+                 &PyInstanceMap<T>::size,
+                 "The number of instances in the map.")
+            .def("__bool__",
+                 [](const PyInstanceMap<T>& map) { return map.size() > 0; })
+            .def(
+                    "__iter__",
+                    [](py::object self) {
+                        return py::iter(self.attr("keys")());
+                    },
+                    "Iterate over a snapshot of the instance handles.")
+            .def("get",
+                 (py::object(PyInstanceMap<T>::*)(
+                         const dds::core::InstanceHandle&,
+                         py::object) const)
+                         & PyInstanceMap<T>::get,
+                 py::arg("handle"),
+                 py::arg("default") = py::none(),
+                 "Get the value of an instance, or default if it is not in "
+                 "the map.")
+            .def("pop",
+                 &PyInstanceMap<T>::pop,
+                 py::arg("handle"),
+                 py::arg("default") = py::none(),
+                 "Remove an instance and return its value, or default if it "
+                 "is not in the map.")
+            .def(
+                    "keys",
+                    [](const PyInstanceMap<T>& map) {
+                        std::vector<dds::core::InstanceHandle> keys;
+                        keys.reserve(map.size());
+                        for (auto& entry : map.map()) {
+                            keys.push_back(entry.first);
+                        }
+                        return keys;
+                    },
+                    "The instance handles in the map.")
+            .def(
+                    "values",
+                    [](const PyInstanceMap<T>& map) {
+                        py::list values(map.size());
+                        size_t i = 0;
+                        for (auto& entry : map.map()) {
+                            values[i++] = entry.second;
+                        }
+                        return values;
+                    },
+                    "The values in the map.")
+            .def(
+                    "items",
+                    [](const PyInstanceMap<T>& map) {
+                        py::list items(map.size());
+                        size_t i = 0;
+                        for (auto& entry : map.map()) {
+                            items[i++] = py::make_tuple(
+                                    entry.first,
+                                    entry.second);
+                        }
+                        return items;
+                    },
+                    "The (handle, value) pairs in the map.")
+            .def("clear",
+                 &PyInstanceMap<T>::clear,
+                 "Remove all the instances.")
+            .def("update",
+                 &PyInstanceMap<T>::update,
+                 py::arg("samples"),
+                 py::arg("remove_not_alive") = true,
+                 "Set the value of the instance of each valid sample to "
+                 "its data. If remove_not_alive is True, the disposed and "
+                 "unregistered instances are removed. Returns the number of "
+                 "instances set or removed.");
+}
+
+}  // namespace pyrti
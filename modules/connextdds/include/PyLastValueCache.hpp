@@ -0,0 +1,313 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <dds/core/cond/GuardCondition.hpp>
+#include <dds/core/cond/WaitSet.hpp>
+#include <dds/sub/cond/ReadCondition.hpp>
+#include "PyDataReader.hpp"
+#include "PyInstanceHandle.hpp"
+
+namespace pyrti {
+
+/*
+    Keeps the newest sample of each instance of a DataReader.
+
+    A native thread waits for data and reads or takes it without the GIL,
+    replacing the entry of each instance. Every update is stamped with an
+    increasing generation so that changed_since() only visits the instances
+    that changed after a given generation.
+ */
+template<typename T>
+class PyLastValueCache {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    PyLastValueCache(const PyDataReader<T>& reader, bool take)
+            : _reader(reader),
+              _condition(dds::sub::cond::ReadCondition(
+                      reader,
+                      take ? dds::sub::status::DataState::any()
+                           : dds::sub::status::DataState(
+                                   dds::sub::status::SampleState::not_read(),
+                                   dds::sub::status::ViewState::any(),
+                                   dds::sub::status::InstanceState::any()))),
+              _take(take),
+              _generation(0),
+              _stop(false)
+    {
+        this->_waitset.attach_condition(this->_condition);
+        this->_waitset.attach_condition(this->_wakeup);
+        this->_thread = std::thread(&PyLastValueCache<T>::run, this);
+    }
+
+    ~PyLastValueCache()
+    {
+        this->close();
+    }
+
+    dds::core::optional<dds::sub::Sample<T>> get(
+            const dds::core::InstanceHandle& handle)
+    {
+        dds::core::optional<dds::sub::Sample<T>> retval;
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        auto it = this->_entries.find(handle);
+        if (it != this->_entries.end()) {
+            retval = it->second.sample;
+        }
+        return retval;
+    }
+
+    bool contains(const dds::core::InstanceHandle& handle)
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_entries.count(handle) > 0;
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_entries.size();
+    }
+
+    uint64_t generation()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_generation;
+    }
+
+    std::vector<dds::sub::Sample<T>> snapshot()
+    {
+        return this->changed_since(0).first;
+    }
+
+    // The samples of the instances updated after generation, oldest update
+    // first, and the generation of the cache at that point
+    std::pair<std::vector<dds::sub::Sample<T>>, uint64_t> changed_since(
+            uint64_t generation)
+    {
+        std::vector<dds::sub::Sample<T>> samples;
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        auto it = this->_by_generation.upper_bound(generation);
+        for (; it != this->_by_generation.end(); ++it) {
+            samples.push_back(this->_entries.at(it->second).sample);
+        }
+        return std::make_pair(std::move(samples), this->_generation);
+    }
+
+    // Instances that haven't been updated for longer than max_age
+    std::vector<dds::core::InstanceHandle> stale(
+            const dds::core::Duration& max_age)
+    {
+        std::vector<dds::core::InstanceHandle> handles;
+        auto limit = Clock::now()
+                - std::chrono::seconds(max_age.sec())
+                - std::chrono::nanoseconds(max_age.nanosec());
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        // Sorted by generation, hence by update time
+        for (auto& entry : this->_by_generation) {
+            auto& updated = this->_entries.at(entry.second).updated;
+            if (updated >= limit) break;
+            handles.push_back(entry.second);
+        }
+        return handles;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (this->_stop) return;
+            this->_stop = true;
+        }
+        this->_wakeup.trigger_value(true);
+        if (this->_thread.joinable()) {
+            if (PyGILState_Check()) {
+                py::gil_scoped_release release;
+                this->_thread.join();
+            } else {
+                this->_thread.join();
+            }
+        }
+        this->_waitset.detach_condition(this->_condition);
+    }
+
+    bool closed()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_stop;
+    }
+
+private:
+    struct Entry {
+        dds::sub::Sample<T> sample;
+        uint64_t generation;
+        Clock::time_point updated;
+    };
+
+    void run()
+    {
+        try {
+            while (true) {
+                this->_waitset.wait();
+                if (this->closed()) return;
+                while (this->drain() > 0) {
+                }
+            }
+        } catch (const std::exception&) {
+            // The reader was closed
+        }
+    }
+
+    size_t drain()
+    {
+        auto selector = this->_reader.select()
+                                .condition(this->_condition)
+                                .max_samples(MAX_BATCH);
+        auto loaned = this->_take ? selector.take() : selector.read();
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        for (const auto& sample : loaned) {
+            this->update(sample.data(), sample.info(), now);
+        }
+        return loaned.length();
+    }
+
+    void update(
+            const T& data,
+            const dds::sub::SampleInfo& info,
+            Clock::time_point now)
+    {
+        auto handle = info.instance_handle();
+        auto it = this->_entries.find(handle);
+        if (it == this->_entries.end()) {
+            // Nothing to keep from a dispose or unregister without a value
+            if (!info.valid()) return;
+            it = this->_entries
+                         .emplace(
+                                 handle,
+                                 Entry { dds::sub::Sample<T>(data, info),
+                                         0,
+                                         now })
+                         .first;
+        } else {
+            this->_by_generation.erase(it->second.generation);
+            if (info.valid()) {
+                it->second.sample.data(data);
+            }
+            it->second.sample.info(info);
+            it->second.updated = now;
+        }
+        it->second.generation = ++this->_generation;
+        this->_by_generation[it->second.generation] = handle;
+    }
+
+    static const int32_t MAX_BATCH = 256;
+
+    PyDataReader<T> _reader;
+    dds::sub::cond::ReadCondition _condition;
+    dds::core::cond::GuardCondition _wakeup;
+    dds::core::cond::WaitSet _waitset;
+    bool _take;
+    std::mutex _mutex;
+    std::unordered_map<
+            dds::core::InstanceHandle,
+            Entry,
+            PyInstanceHandleHash>
+            _entries;
+    std::map<uint64_t, dds::core::InstanceHandle> _by_generation;
+    uint64_t _generation;
+    bool _stop;
+    std::thread _thread;
+};
+
+
+template<typename T>
+void init_last_value_cache(
+        py::class_<
+            PyLastValueCache<T>,
+            std::unique_ptr<PyLastValueCache<T>, no_gil_delete<PyLastValueCache<T>>>>& cls)
+{
+    cls.def(py::init<const PyDataReader<T>&, bool>(),
+            py::arg("reader"),
+            py::arg("take") = true,
+            py::keep_alive<1, 2>(),
+            py::call_guard<py::gil_scoped_release>(),
+            "Keep the newest sample of each instance received by the "
+            "DataReader, updated from a native thread. If take is True the "
+            "samples are taken from the DataReader, otherwise they are read "
+            "and left in it.")
+            .def("get",
+                 &PyLastValueCache<T>::get,
+                 py::arg("handle"),
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Get a copy of the newest sample of an instance, or None if "
+                 "no sample of that instance has been received.")
+            .def("__contains__",
+                 &PyLastValueCache<T>::contains,
+                 py::call_guard<py::gil_scoped_release>())
+            .def("__len__",
+                 &PyLastValueCache<T>::size,
+                 py::call_guard<py::gil_scoped_release>())
+            .def_property_readonly(
+                    "generation",
+                    &PyLastValueCache<T>::generation,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The generation of the last update; it increases with "
+                    "every sample received.")
+            .def("snapshot",
+                 &PyLastValueCache<T>::snapshot,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Get a copy of the newest sample of every instance.")
+            .def("changed_since",
+                 &PyLastValueCache<T>::changed_since,
+                 py::arg("generation"),
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Get a copy of the newest sample of the instances updated "
+                 "after the given generation, and the current generation to "
+                 "pass to the next call.")
+            .def("stale",
+                 &PyLastValueCache<T>::stale,
+                 py::arg("max_age"),
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Get the handles of the instances that haven't been updated "
+                 "in more than max_age.")
+            .def("close",
+                 &PyLastValueCache<T>::close,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Stop updating the cache.")
+            .def_property_readonly(
+                    "closed",
+                    &PyLastValueCache<T>::closed,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Whether this cache has been closed.")
+            .def(
+                    "__enter__",
+                    [](py::object self) { return self; },
+                    "Enter a context for this cache, to be closed on context "
+                    "exit.")
+            .def(
+                    "__exit__",
+                    [](PyLastValueCache<T>& cache,
+                       py::object,
+                       py::object,
+                       py::object) { cache.close(); },
+                    "Exit the context for this cache, closing it.");
+}
+
+}  // namespace pyrti
@@ -0,0 +1,694 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <dds/core/cond/GuardCondition.hpp>
+#include <dds/core/cond/WaitSet.hpp>
+#include <dds/sub/cond/ReadCondition.hpp>
+#include "PyDataReader.hpp"
+
+namespace pyrti {
+
+/*
+    Merges the samples of several DataReaders into a single stream ordered
+    by source (or reception) timestamp.
+
+    A native thread takes the samples of every reader without the GIL into
+    a reorder buffer, a heap ordered by timestamp. The oldest sample is
+    released once every reader has received a newer one (the k-way merge
+    condition), once a sample has waited max_latency in the buffer, or when
+    the buffer holds more than buffer_size samples. Released samples are
+    queued for the application, which consumes them in batches either
+    synchronously or from asyncio; when that queue is full the thread stops
+    taking samples until the application catches up.
+
+    Samples released after a newer one, because they arrived too late for
+    the reorder buffer, are still delivered and counted in late_count.
+ */
+template<typename T>
+class PyMergedReader {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    PyMergedReader(
+            const std::vector<PyDataReader<T>>& readers,
+            const std::string& order_by,
+            const dds::core::Duration& max_latency,
+            size_t max_batch_size,
+            size_t buffer_size)
+            : _readers(readers),
+              _by_reception(order_by == "reception_timestamp"),
+              _max_latency(
+                      std::chrono::duration_cast<Clock::duration>(
+                              std::chrono::seconds(max_latency.sec())
+                              + std::chrono::nanoseconds(
+                                      max_latency.nanosec()))),
+              _max_batch_size(max_batch_size),
+              _buffer_size(buffer_size),
+              _sequence(0),
+              _released((std::numeric_limits<int64_t>::min)()),
+              _merged_count(0),
+              _late_count(0),
+              _async_waiting(0),
+              _stop(false),
+              _closed(std::make_shared<std::atomic<bool>>(false))
+    {
+        if (readers.empty()) {
+            throw dds::core::InvalidArgumentError("no readers to merge");
+        }
+        if (order_by != "source_timestamp"
+            && order_by != "reception_timestamp") {
+            throw dds::core::InvalidArgumentError(
+                    "order_by must be source_timestamp or "
+                    "reception_timestamp");
+        }
+        if (max_batch_size == 0 || buffer_size == 0) {
+            throw dds::core::InvalidArgumentError(
+                    "max_batch_size and buffer_size must be greater than 0");
+        }
+        for (auto& reader : this->_readers) {
+            this->_conditions.push_back(dds::sub::cond::ReadCondition(
+                    reader,
+                    dds::sub::status::DataState::any()));
+            this->_waitset.attach_condition(this->_conditions.back());
+            this->_newest.push_back((std::numeric_limits<int64_t>::min)());
+        }
+        this->_waitset.attach_condition(this->_wakeup);
+        this->_thread = std::thread(&PyMergedReader<T>::run, this);
+    }
+
+    ~PyMergedReader()
+    {
+        this->close();
+    }
+
+    // Lets the thread schedule async deliveries without owning this object;
+    // set by the owner right after construction
+    void self(const std::shared_ptr<PyMergedReader<T>>& self)
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_self = self;
+    }
+
+    // Up to max_batch_size samples, in order, without blocking
+    std::vector<dds::sub::Sample<T>> take()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->pop_batch();
+    }
+
+    // Blocks until samples are available, the timeout expires or the
+    // merged reader is closed
+    std::vector<dds::sub::Sample<T>> wait(const dds::core::Duration& timeout)
+    {
+        auto deadline = Clock::now()
+                + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::seconds(timeout.sec())
+                        + std::chrono::nanoseconds(timeout.nanosec()));
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_cv.wait_until(lock, deadline, [this]() {
+            return this->_stop || !this->_ready.empty();
+        });
+        return this->pop_batch();
+    }
+
+    // Blocks until samples are available; an empty batch means the merged
+    // reader was closed
+    std::vector<dds::sub::Sample<T>> next()
+    {
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        this->_cv.wait(lock, [this]() {
+            return this->_stop || !this->_ready.empty();
+        });
+        return this->pop_batch();
+    }
+
+    // Returns a future completed with the next batch. Called from the event
+    // loop thread with the GIL held.
+    py::object next_async()
+    {
+        py::object loop =
+                py::module::import("asyncio").attr("get_running_loop")();
+        py::object future = loop.attr("create_future")();
+        this->_waiters.push_back(std::make_pair(loop, future));
+        {
+            // Counted before deliver() so that a release racing with it
+            // schedules another delivery
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            ++this->_async_waiting;
+        }
+        this->deliver();
+        return future;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (this->_stop) return;
+            this->_stop = true;
+            this->_ready.clear();
+        }
+        this->_closed->store(true);
+        this->_cv.notify_all();
+        this->_wakeup.trigger_value(true);
+        if (this->_thread.joinable()) {
+            if (this->_thread.get_id() == std::this_thread::get_id()) {
+                // Destroyed when the thread released the last reference to
+                // a Python object; the thread exits without using this object
+                this->_thread.detach();
+            } else if (PyGILState_Check()) {
+                py::gil_scoped_release release;
+                this->_thread.join();
+            } else {
+                this->_thread.join();
+            }
+        }
+        for (auto& condition : this->_conditions) {
+            this->_waitset.detach_condition(condition);
+        }
+        this->_buffer.clear();
+        this->_arrivals.clear();
+
+        if (!PyGILState_Check()) return;
+        if (!Py_IsInitialized()) {
+            for (auto& waiter : this->_waiters) {
+                waiter.first.release();
+                waiter.second.release();
+            }
+            this->_waiters.clear();
+            return;
+        }
+        // End the pending async iterations
+        std::deque<std::pair<py::object, py::object>> waiters;
+        waiters.swap(this->_waiters);
+        for (auto& waiter : waiters) {
+            try {
+                waiter.first.attr("call_soon_threadsafe")(
+                        py::cpp_function([](py::object future) {
+                            if (!future.attr("done")().cast<bool>()) {
+                                future.attr("set_exception")(
+                                        py::reinterpret_borrow<py::object>(
+                                                PyExc_StopAsyncIteration));
+                            }
+                        }),
+                        waiter.second);
+            } catch (py::error_already_set&) {
+                // The event loop is closed
+            }
+        }
+    }
+
+    bool closed()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_stop;
+    }
+
+    size_t max_batch_size() const
+    {
+        return this->_max_batch_size;
+    }
+
+    size_t buffer_size() const
+    {
+        return this->_buffer_size;
+    }
+
+    dds::core::Duration max_latency() const
+    {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          this->_max_latency)
+                          .count();
+        return dds::core::Duration(
+                static_cast<int32_t>(ns / 1000000000),
+                static_cast<uint32_t>(ns % 1000000000));
+    }
+
+    std::string order_by() const
+    {
+        return this->_by_reception ? "reception_timestamp"
+                                   : "source_timestamp";
+    }
+
+    const std::vector<PyDataReader<T>>& readers() const
+    {
+        return this->_readers;
+    }
+
+    // Samples in the reorder buffer
+    size_t pending()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_buffer.size();
+    }
+
+    // Samples released and not yet consumed
+    size_t ready()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_ready.size();
+    }
+
+    uint64_t merged_count()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_merged_count;
+    }
+
+    uint64_t late_count()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_late_count;
+    }
+
+private:
+    struct Entry {
+        int64_t timestamp;
+        // Breaks ties in the order the samples were taken
+        uint64_t sequence;
+        Clock::time_point received;
+        dds::sub::Sample<T> sample;
+    };
+
+    // Orders the heap with the oldest sample on top
+    struct Newer {
+        bool operator()(const Entry& a, const Entry& b) const
+        {
+            return a.timestamp != b.timestamp ? a.timestamp > b.timestamp
+                                              : a.sequence > b.sequence;
+        }
+    };
+
+    static int64_t to_nanosecs(const dds::core::Time& t)
+    {
+        return static_cast<int64_t>(t.sec()) * 1000000000 + t.nanosec();
+    }
+
+    std::vector<dds::sub::Sample<T>> pop_batch()
+    {
+        std::vector<dds::sub::Sample<T>> batch;
+        while (!this->_ready.empty() && batch.size() < this->_max_batch_size) {
+            batch.push_back(std::move(this->_ready.front()));
+            this->_ready.pop_front();
+        }
+        if (!batch.empty()) {
+            // Room for the thread to take more samples
+            this->_cv.notify_all();
+        }
+        return batch;
+    }
+
+    void run()
+    {
+        // notify() may release the last reference to this object
+        auto closed = this->_closed;
+        try {
+            while (true) {
+                Clock::time_point deadline;
+                bool has_deadline = false;
+                {
+                    std::unique_lock<std::mutex> lock(this->_mutex);
+                    this->_cv.wait(lock, [this]() {
+                        return this->_stop
+                                || this->_ready.size() < this->_buffer_size;
+                    });
+                    if (this->_stop) return;
+                    if (!this->_arrivals.empty()) {
+                        deadline = *this->_arrivals.begin()
+                                + this->_max_latency;
+                        has_deadline = true;
+                    }
+                }
+
+                if (has_deadline) {
+                    auto now = Clock::now();
+                    if (deadline > now) {
+                        auto ns = std::chrono::duration_cast<
+                                          std::chrono::nanoseconds>(
+                                          deadline - now)
+                                          .count();
+                        try {
+                            this->_waitset.wait(dds::core::Duration(
+                                    static_cast<int32_t>(ns / 1000000000),
+                                    static_cast<uint32_t>(ns % 1000000000)));
+                        } catch (const dds::core::TimeoutError&) {
+                            // A sample reached max_latency
+                        }
+                    }
+                } else {
+                    this->_waitset.wait();
+                }
+                if (this->closed()) return;
+
+                size_t released = this->drain();
+                released += this->release();
+                if (released > 0) {
+                    this->notify();
+                    if (closed->load()) return;
+                }
+            }
+        } catch (const std::exception&) {
+            // A reader was closed
+        }
+    }
+
+    // Takes from every reader until they are empty or the queue of
+    // released samples is full; returns the number of samples released
+    size_t drain()
+    {
+        size_t released = 0;
+        bool more = true;
+        while (more) {
+            more = false;
+            for (size_t i = 0; i < this->_readers.size(); ++i) {
+                auto loaned = this->_readers[i]
+                                      .select()
+                                      .condition(this->_conditions[i])
+                                      .max_samples(MAX_BATCH)
+                                      .take();
+                if (loaned.length() == 0) continue;
+                more = more
+                        || static_cast<int32_t>(loaned.length()) == MAX_BATCH;
+
+                auto now = Clock::now();
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                for (const auto& sample : loaned) {
+                    int64_t timestamp = to_nanosecs(
+                            this->_by_reception
+                                    ? sample.info()->reception_timestamp()
+                                    : sample.info().source_timestamp());
+                    this->_newest[i] = (std::max)(this->_newest[i], timestamp);
+                    this->_buffer.push_back(Entry {
+                            timestamp,
+                            this->_sequence++,
+                            now,
+                            dds::sub::Sample<T>(sample.data(), sample.info()) });
+                    std::push_heap(
+                            this->_buffer.begin(),
+                            this->_buffer.end(),
+                            Newer());
+                    this->_arrivals.insert(now);
+                }
+                released += this->release_locked(now);
+                if (this->_ready.size() >= this->_buffer_size) {
+                    return released;
+                }
+            }
+        }
+        return released;
+    }
+
+    size_t release()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->release_locked(Clock::now());
+    }
+
+    size_t release_locked(Clock::time_point now)
+    {
+        int64_t watermark = *std::min_element(
+                this->_newest.begin(),
+                this->_newest.end());
+        size_t count = 0;
+        while (!this->_buffer.empty()) {
+            const Entry& oldest = this->_buffer.front();
+            bool expired = *this->_arrivals.begin() + this->_max_latency <= now;
+            if (this->_buffer.size() <= this->_buffer_size
+                && oldest.timestamp > watermark && !expired) {
+                break;
+            }
+            if (oldest.timestamp < this->_released) {
+                ++this->_late_count;
+            }
+            this->_released = (std::max)(this->_released, oldest.timestamp);
+            this->_arrivals.erase(this->_arrivals.find(oldest.received));
+            std::pop_heap(this->_buffer.begin(), this->_buffer.end(), Newer());
+            this->_ready.push_back(std::move(this->_buffer.back().sample));
+            this->_buffer.pop_back();
+            ++this->_merged_count;
+            ++count;
+        }
+        return count;
+    }
+
+    // Wakes up the synchronous and asynchronous consumers
+    void notify()
+    {
+        bool async_waiting;
+        std::weak_ptr<PyMergedReader<T>> weak;
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            async_waiting = this->_async_waiting > 0;
+            weak = this->_self;
+        }
+        this->_cv.notify_all();
+        if (!async_waiting || !Py_IsInitialized()) return;
+
+        py::gil_scoped_acquire acquire;
+        py::cpp_function deliver([weak]() {
+            auto self = weak.lock();
+            if (self) self->deliver();
+        });
+        // Python calls can switch threads, so don't iterate the waiters
+        std::vector<py::object> loops;
+        for (auto& waiter : this->_waiters) {
+            loops.push_back(waiter.first);
+        }
+        for (auto& loop : loops) {
+            try {
+                loop.attr("call_soon_threadsafe")(deliver);
+            } catch (py::error_already_set&) {
+                // The event loop is closed
+            }
+        }
+    }
+
+    // Completes pending async iterations; from an event loop with the GIL
+    void deliver()
+    {
+        while (!this->_waiters.empty()) {
+            py::object future = this->_waiters.front().second;
+            if (future.attr("done")().template cast<bool>()) {
+                // Cancelled by the application
+                this->_waiters.pop_front();
+                continue;
+            }
+            std::vector<dds::sub::Sample<T>> batch;
+            bool stopped;
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                batch = this->pop_batch();
+                stopped = this->_stop;
+                if (batch.empty() && !stopped) {
+                    // In the same critical section, so that samples released
+                    // after the pop see the waiters and schedule a delivery
+                    this->_async_waiting = this->_waiters.size();
+                    return;
+                }
+            }
+            if (batch.empty()) {
+                future.attr("set_exception")(
+                        py::reinterpret_borrow<py::object>(
+                                PyExc_StopAsyncIteration));
+            } else {
+                future.attr("set_result")(py::cast(std::move(batch)));
+            }
+            this->_waiters.pop_front();
+        }
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_async_waiting = this->_waiters.size();
+    }
+
+    static const int32_t MAX_BATCH = 256;
+
+    std::vector<PyDataReader<T>> _readers;
+    std::vector<dds::sub::cond::ReadCondition> _conditions;
+    dds::core::cond::GuardCondition _wakeup;
+    dds::core::cond::WaitSet _waitset;
+    bool _by_reception;
+    Clock::duration _max_latency;
+    size_t _max_batch_size;
+    size_t _buffer_size;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    // Reorder buffer, a heap with the oldest sample first
+    std::vector<Entry> _buffer;
+    // When each buffered sample was taken, to enforce max_latency
+    std::multiset<Clock::time_point> _arrivals;
+    // Newest timestamp taken from each reader
+    std::vector<int64_t> _newest;
+    std::deque<dds::sub::Sample<T>> _ready;
+    uint64_t _sequence;
+    int64_t _released;
+    uint64_t _merged_count;
+    uint64_t _late_count;
+    size_t _async_waiting;
+    bool _stop;
+    // Shared with the thread, which can outlive this object
+    std::shared_ptr<std::atomic<bool>> _closed;
+    std::weak_ptr<PyMergedReader<T>> _self;
+    std::thread _thread;
+
+    // Only accessed with the GIL held
+    std::deque<std::pair<py::object, py::object>> _waiters;
+};
+
+
+template<typename T>
+void init_merged_reader(
+        py::class_<PyMergedReader<T>, std::shared_ptr<PyMergedReader<T>>>& cls)
+{
+    cls.def(py::init([](py::iterable readers,
+                        const std::string& order_by,
+                        const dds::core::Duration& max_latency,
+                        size_t max_batch_size,
+                        size_t buffer_size) {
+                std::vector<PyDataReader<T>> v;
+                for (auto reader : readers) {
+                    v.push_back(py::cast<PyDataReader<T>>(reader));
+                }
+                py::gil_scoped_release release;
+                auto mr = std::make_shared<PyMergedReader<T>>(
+                        v,
+                        order_by,
+                        max_latency,
+                        max_batch_size,
+                        buffer_size);
+                mr->self(mr);
+                return mr;
+            }),
+            py::arg("readers"),
+            py::arg("order_by") = "source_timestamp",
+            py::arg_v(
+                    "max_latency",
+                    dds::core::Duration::from_millisecs(100),
+                    "Duration.from_milliseconds(100)"),
+            py::arg("max_batch_size") = 32,
+            py::arg("buffer_size") = 1024,
+            "Merge the samples of several DataReaders into a single stream "
+            "ordered by source_timestamp or reception_timestamp. Samples "
+            "are taken from the readers by a native thread and held in a "
+            "reorder buffer of up to buffer_size samples for at most "
+            "max_latency. Iterate (synchronously or with async for) to get "
+            "lists of up to max_batch_size samples in order.")
+            .def("take",
+                 &PyMergedReader<T>::take,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Get the next samples in order, up to max_batch_size, "
+                 "without blocking.")
+            .def("wait",
+                 &PyMergedReader<T>::wait,
+                 py::arg("timeout"),
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Wait for the next samples in order, up to max_batch_size. "
+                 "Returns an empty list if none are available before the "
+                 "timeout.")
+            .def("__iter__",
+                 [](py::object self) { return self; },
+                 "Return this merged reader.")
+            .def("__next__",
+                 [](PyMergedReader<T>& mr) {
+                     std::vector<dds::sub::Sample<T>> batch;
+                     {
+                         py::gil_scoped_release release;
+                         batch = mr.next();
+                     }
+                     if (batch.empty()) throw py::stop_iteration();
+                     return batch;
+                 },
+                 "Wait for the next list of samples in order. Iteration "
+                 "ends when the merged reader is closed.")
+            .def("__aiter__",
+                 [](py::object self) { return self; },
+                 "Return this merged reader.")
+            .def("__anext__",
+                 &PyMergedReader<T>::next_async,
+                 "Return an awaitable for the next list of samples in "
+                 "order.")
+            .def_property_readonly(
+                    "readers",
+                    &PyMergedReader<T>::readers,
+                    "The DataReaders being merged.")
+            .def_property_readonly(
+                    "order_by",
+                    &PyMergedReader<T>::order_by,
+                    "The timestamp the samples are ordered by.")
+            .def_property_readonly(
+                    "max_latency",
+                    &PyMergedReader<T>::max_latency,
+                    "The longest time a sample is held for reordering.")
+            .def_property_readonly(
+                    "max_batch_size",
+                    &PyMergedReader<T>::max_batch_size,
+                    "The maximum number of samples returned at once.")
+            .def_property_readonly(
+                    "buffer_size",
+                    &PyMergedReader<T>::buffer_size,
+                    "The maximum number of samples held for reordering.")
+            .def_property_readonly(
+                    "pending",
+                    &PyMergedReader<T>::pending,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The number of samples held for reordering.")
+            .def_property_readonly(
+                    "ready",
+                    &PyMergedReader<T>::ready,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The number of samples in order not yet consumed.")
+            .def_property_readonly(
+                    "merged_count",
+                    &PyMergedReader<T>::merged_count,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The number of samples released in order.")
+            .def_property_readonly(
+                    "late_count",
+                    &PyMergedReader<T>::late_count,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The number of samples released after a newer sample "
+                    "because they arrived too late to be reordered.")
+            .def("close",
+                 &PyMergedReader<T>::close,
+                 "Stop merging and end the iterations. Samples not yet "
+                 "consumed are discarded.")
+            .def_property_readonly(
+                    "closed",
+                    &PyMergedReader<T>::closed,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Whether this merged reader has been closed.")
+            .def(
+                    "__enter__",
+                    [](py::object self) { return self; },
+                    "Enter a context for this merged reader, to be closed on "
+                    "context exit.")
+            .def(
+                    "__exit__",
+                    [](PyMergedReader<T>& mr,
+                       py::object,
+                       py::object,
+                       py::object) { mr.close(); },
+                    "Exit the context for this merged reader, closing it.");
+}
+
+}  // namespace pyrti
@@ -0,0 +1,88 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <memory>
+#include <rti/topic/ContentFilter.hpp>
+#include <dds/core/xtypes/DynamicData.hpp>
+
+namespace pyrti {
+
+/*
+    A predicate over the fields of a DynamicData type, compiled from a
+    prefix expression such as
+
+        (and (< pos.x 10.5) (in color ("RED" "BLUE")) (all_bits flags 5))
+
+    Fields are compiled to member indexes once; evaluation only reads the
+    sample and never calls into Python. %N atoms stand for the N-th
+    parameter, which holds a literal or a list of literals.
+ */
+class PYRTI_SYMBOL_HIDDEN PyPredicate {
+public:
+    struct Node;
+
+    static std::unique_ptr<PyPredicate> compile(
+            const std::string& expression,
+            const std::vector<std::string>& parameters,
+            const dds::core::xtypes::DynamicType& type);
+
+    ~PyPredicate();
+
+    // False if a field can't be read, e.g. an unset optional member
+    bool evaluate(const dds::core::xtypes::DynamicData& sample) const;
+
+    // Writes a predicate tree of Python tuples as an expression
+    static std::string expression(py::handle predicate);
+
+private:
+    explicit PyPredicate(std::unique_ptr<Node> root);
+
+    std::unique_ptr<Node> _root;
+};
+
+
+// A reference to a filter parameter in a predicate tree
+struct PyPredicateParameter {
+    uint32_t index;
+};
+
+
+/*
+    Content filter evaluating PyPredicate expressions natively. It can be
+    registered on the participants of both the DataReaders and the
+    DataWriters, so that writers filter on behalf of the readers.
+ */
+class PYRTI_SYMBOL_HIDDEN PyPredicateFilter
+        : public rti::topic::
+                  ContentFilter<dds::core::xtypes::DynamicData, PyPredicate> {
+public:
+    static const char* const FILTER_NAME;
+
+    PyPredicate& compile(
+            const std::string& expression,
+            const std::vector<std::string>& parameters,
+            const dds::core::optional<dds::core::xtypes::DynamicType>&
+                    type_code,
+            const std::string& type_class_name,
+            PyPredicate* old_compile_data) override;
+
+    bool evaluate(
+            PyPredicate& compile_data,
+            const dds::core::xtypes::DynamicData& sample,
+            const rti::topic::FilterSampleInfo& meta_data) override;
+
+    void finalize(PyPredicate& compile_data) override;
+};
+
+}  // namespace pyrti
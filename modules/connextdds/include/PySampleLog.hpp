@@ -0,0 +1,201 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <string>
+#include <vector>
+
+namespace pyrti {
+
+/*
+    On-disk layout of a sample log, in the byte order of the host.
+
+    The log starts with a PySampleLogHeader followed by the type name and
+    the name of each stream (one per recorded DataReader), NUL-terminated.
+    Records start at data_offset, each a PySampleLogRecord followed by the
+    CDR serialization of the sample, padded to a multiple of 8 bytes.
+    Samples without valid data hold the serialized key, if known.
+
+    The header's end and record_count are only updated after a record is
+    complete, so a log left by a process that didn't close it can still be
+    read up to the last complete record.
+
+    The index, written to <path>.idx when the log is closed, holds the
+    offset of every record sorted by source timestamp, and sorted by key
+    hash and source timestamp. Logs without a valid index are indexed by
+    scanning them when opened.
+ */
+struct PySampleLogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t stream_count;
+    uint64_t data_offset;
+    uint64_t end;
+    uint64_t record_count;
+    uint8_t reserved[24];
+};
+
+
+struct PySampleLogRecord {
+    enum Flags : uint32_t {
+        VALID_DATA = 1,
+        DISPOSED = 2,
+        NO_WRITERS = 4,
+        HAS_KEY = 8
+    };
+
+    // Size of the whole record, including this header and the padding
+    uint32_t size;
+    uint32_t data_length;
+    uint32_t stream;
+    uint32_t flags;
+    int64_t source_timestamp;
+    int64_t reception_timestamp;
+    uint8_t key_hash[16];
+};
+
+
+/*
+    Appends records to a memory-mapped log file, doubling the mapping when
+    it is full, and keeps the index of the records written. Not thread-safe.
+ */
+class PYRTI_SYMBOL_HIDDEN PySampleLogWriter {
+public:
+    struct TimeEntry {
+        int64_t timestamp;
+        uint64_t offset;
+    };
+
+    struct InstanceEntry {
+        uint8_t key_hash[16];
+        int64_t timestamp;
+        uint64_t offset;
+    };
+
+    PySampleLogWriter(
+            const std::string& path,
+            const std::string& type_name,
+            const std::vector<std::string>& streams,
+            size_t initial_size);
+
+    ~PySampleLogWriter();
+
+    // Fills in record.size
+    void append(PySampleLogRecord& record, const char* data);
+
+    // Flushes the mapped pages to the file
+    void sync();
+
+    // Truncates the file to its contents and writes the index
+    void close();
+
+    uint64_t record_count() const;
+
+    uint64_t size() const;
+
+    const std::string& path() const
+    {
+        return this->_path;
+    }
+
+private:
+    PySampleLogHeader* header() const
+    {
+        return reinterpret_cast<PySampleLogHeader*>(this->_map);
+    }
+
+    void reserve(size_t size);
+
+    void write_index();
+
+    std::string _path;
+    int _fd;
+    char* _map;
+    size_t _capacity;
+    uint64_t _end;
+    std::vector<TimeEntry> _time_index;
+    std::vector<InstanceEntry> _instance_index;
+};
+
+
+/*
+    Read-only view of a sample log mapped in memory, with its index.
+ */
+class PYRTI_SYMBOL_HIDDEN PySampleLogReader {
+public:
+    explicit PySampleLogReader(const std::string& path);
+
+    ~PySampleLogReader();
+
+    const std::string& type_name() const
+    {
+        return this->_type_name;
+    }
+
+    const std::vector<std::string>& streams() const
+    {
+        return this->_streams;
+    }
+
+    uint64_t record_count() const
+    {
+        return this->_time_index.size();
+    }
+
+    // Offsets of the records with a source timestamp in [start, end), in
+    // source timestamp order
+    std::vector<uint64_t> by_time(int64_t start, int64_t end) const;
+
+    // Same as by_time() for the records of one instance
+    std::vector<uint64_t> by_instance(
+            const uint8_t* key_hash,
+            int64_t start,
+            int64_t end) const;
+
+    const PySampleLogRecord& record(uint64_t offset) const
+    {
+        return *reinterpret_cast<const PySampleLogRecord*>(
+                this->_map + offset);
+    }
+
+    const char* data(uint64_t offset) const
+    {
+        return this->_map + offset + sizeof(PySampleLogRecord);
+    }
+
+private:
+    typedef PySampleLogWriter::TimeEntry TimeEntry;
+    typedef PySampleLogWriter::InstanceEntry InstanceEntry;
+
+    // Fails if the index doesn't match the records in [data_offset, end)
+    bool read_index(
+            const std::string& path,
+            uint64_t record_count,
+            uint64_t data_offset,
+            uint64_t end);
+
+    void build_index(uint64_t data_offset, uint64_t end);
+
+    // Whether a complete record starts at offset
+    bool valid_record(uint64_t offset, uint64_t data_offset, uint64_t end)
+            const;
+
+    const char* _map;
+    size_t _size;
+    std::string _type_name;
+    std::vector<std::string> _streams;
+    std::vector<TimeEntry> _time_index;
+    std::vector<InstanceEntry> _instance_index;
+};
+
+}  // namespace pyrti
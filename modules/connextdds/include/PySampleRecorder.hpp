@@ -0,0 +1,777 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <dds/core/cond/GuardCondition.hpp>
+#include <dds/core/cond/WaitSet.hpp>
+#include <dds/sub/cond/ReadCondition.hpp>
+#include "PyDataReader.hpp"
+#include "PyDataWriter.hpp"
+#include "PySampleLog.hpp"
+
+namespace pyrti {
+
+// CDR serialization of the samples of a sample log
+template<typename T>
+struct PySampleLogCdr {
+    static T create(PyDataReader<T>&)
+    {
+        return T();
+    }
+
+    static T create(PyDataWriter<T>&)
+    {
+        return T();
+    }
+
+    static void serialize(const T& sample, std::vector<char>& buffer)
+    {
+        rti::topic::to_cdr_buffer(buffer, sample);
+    }
+
+    static void deserialize(T& sample, const char* data, size_t length)
+    {
+        rti::topic::from_cdr_buffer(
+                sample,
+                std::vector<char>(data, data + length));
+    }
+};
+
+
+template<>
+struct PySampleLogCdr<dds::core::xtypes::DynamicData> {
+    typedef dds::core::xtypes::DynamicData DynamicData;
+
+    static DynamicData create(PyDataReader<DynamicData>& dr)
+    {
+        return DynamicData(dr.dynamic_type());
+    }
+
+    static DynamicData create(PyDataWriter<DynamicData>& dw)
+    {
+        return DynamicData(dw.cache().type(dw));
+    }
+
+    static void serialize(const DynamicData& sample, std::vector<char>& buffer)
+    {
+        rti::core::xtypes::to_cdr_buffer(buffer, sample);
+    }
+
+    // Deserializes straight from the mapped log
+    static void deserialize(
+            DynamicData& sample,
+            const char* data,
+            size_t length)
+    {
+        auto rc = DDS_DynamicData_from_cdr_buffer(
+                &sample.native(),
+                data,
+                static_cast<DDS_UnsignedLong>(length));
+        rti::core::check_return_code(rc, "Failed to deserialize CDR buffer");
+    }
+};
+
+
+inline int64_t sample_log_nanosecs(const dds::core::Time& t)
+{
+    return static_cast<int64_t>(t.sec()) * 1000000000 + t.nanosec();
+}
+
+
+inline dds::core::Time sample_log_time(int64_t ns)
+{
+    return dds::core::Time(
+            static_cast<int32_t>(ns / 1000000000),
+            static_cast<uint32_t>(ns % 1000000000));
+}
+
+
+/*
+    Records the samples received by one or more DataReaders to a sample log.
+
+    A native thread waits for data on all the readers, takes (or reads) it
+    without the GIL and appends each sample, serialized to CDR, with its
+    timestamps, instance key hash and state to the memory-mapped log.
+ */
+template<typename T>
+class PySampleRecorder {
+public:
+    PySampleRecorder(
+            const std::string& path,
+            const std::vector<PyDataReader<T>>& readers,
+            bool take,
+            size_t initial_size)
+            : _readers(readers),
+              _log(path,
+                   PySampleRecorder<T>::type_name(readers),
+                   PySampleRecorder<T>::topic_names(readers),
+                   initial_size),
+              _take(take),
+              _stop(false)
+    {
+        for (auto& reader : this->_readers) {
+            this->_conditions.push_back(dds::sub::cond::ReadCondition(
+                    reader,
+                    take ? dds::sub::status::DataState::any()
+                         : dds::sub::status::DataState(
+                                 dds::sub::status::SampleState::not_read(),
+                                 dds::sub::status::ViewState::any(),
+                                 dds::sub::status::InstanceState::any())));
+            this->_waitset.attach_condition(this->_conditions.back());
+        }
+        this->_waitset.attach_condition(this->_wakeup);
+        this->_thread = std::thread(&PySampleRecorder<T>::run, this);
+    }
+
+    ~PySampleRecorder()
+    {
+        try {
+            this->close();
+        } catch (const std::exception&) {
+            // Already reported by the thread
+        }
+    }
+
+    const std::string& path() const
+    {
+        return this->_log.path();
+    }
+
+    uint64_t record_count()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_log.record_count();
+    }
+
+    uint64_t size()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_log.size();
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->check_error();
+        this->_log.sync();
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (this->_stop) return;
+            this->_stop = true;
+        }
+        this->_wakeup.trigger_value(true);
+        if (this->_thread.joinable()) {
+            if (PyGILState_Check()) {
+                py::gil_scoped_release release;
+                this->_thread.join();
+            } else {
+                this->_thread.join();
+            }
+        }
+        for (auto& condition : this->_conditions) {
+            this->_waitset.detach_condition(condition);
+        }
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_log.close();
+        this->check_error();
+    }
+
+    bool closed()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_stop;
+    }
+
+private:
+    static std::string type_name(const std::vector<PyDataReader<T>>& readers)
+    {
+        if (readers.empty()) {
+            throw dds::core::InvalidArgumentError("no readers to record");
+        }
+        return readers[0].topic_description().type_name();
+    }
+
+    static std::vector<std::string> topic_names(
+            const std::vector<PyDataReader<T>>& readers)
+    {
+        std::vector<std::string> names;
+        for (auto& reader : readers) {
+            names.push_back(reader.topic_description().name());
+        }
+        return names;
+    }
+
+    void check_error()
+    {
+        if (!this->_error.empty()) {
+            throw dds::core::Error("sample recorder failed: " + this->_error);
+        }
+    }
+
+    void run()
+    {
+        try {
+            while (true) {
+                this->_waitset.wait();
+                if (this->closed()) return;
+                bool more = true;
+                while (more) {
+                    more = false;
+                    for (size_t i = 0; i < this->_readers.size(); ++i) {
+                        more = this->drain(i) > 0 || more;
+                    }
+                }
+            }
+        } catch (const dds::core::AlreadyClosedError&) {
+            // A reader was closed
+        } catch (const std::exception& ex) {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_error = ex.what();
+        }
+    }
+
+    size_t drain(size_t index)
+    {
+        auto selector = this->_readers[index]
+                                .select()
+                                .condition(this->_conditions[index])
+                                .max_samples(MAX_BATCH);
+        auto loaned = this->_take ? selector.take() : selector.read();
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        for (const auto& sample : loaned) {
+            this->append(index, sample.data(), sample.info());
+        }
+        return loaned.length();
+    }
+
+    void append(
+            size_t index,
+            const T& data,
+            const dds::sub::SampleInfo& info)
+    {
+        PySampleLogRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.stream = static_cast<uint32_t>(index);
+        record.source_timestamp = sample_log_nanosecs(info.source_timestamp());
+        record.reception_timestamp =
+                sample_log_nanosecs(info->reception_timestamp());
+        auto& key_hash = info.instance_handle()->native().keyHash;
+        std::memcpy(
+                record.key_hash,
+                key_hash.value,
+                (std::min)(
+                        static_cast<size_t>(key_hash.length),
+                        sizeof(record.key_hash)));
+
+        auto state = info.state().instance_state();
+        if (state == dds::sub::status::InstanceState::not_alive_disposed()) {
+            record.flags |= PySampleLogRecord::DISPOSED;
+        } else if (
+                state
+                == dds::sub::status::InstanceState::not_alive_no_writers()) {
+            record.flags |= PySampleLogRecord::NO_WRITERS;
+        }
+
+        this->_buffer.clear();
+        if (info.valid()) {
+            record.flags |= PySampleLogRecord::VALID_DATA;
+            PySampleLogCdr<T>::serialize(data, this->_buffer);
+        } else {
+            // Keep the key so that disposes and unregistrations can be
+            // replayed
+            try {
+                auto& reader = this->_readers[index];
+                T key = PySampleLogCdr<T>::create(reader);
+                reader.key_value(key, info.instance_handle());
+                PySampleLogCdr<T>::serialize(key, this->_buffer);
+                record.flags |= PySampleLogRecord::HAS_KEY;
+            } catch (const dds::core::Exception&) {
+                // Unkeyed type or unknown instance
+                this->_buffer.clear();
+            }
+        }
+        record.data_length = static_cast<uint32_t>(this->_buffer.size());
+        this->_log.append(record, this->_buffer.data());
+    }
+
+    static const int32_t MAX_BATCH = 256;
+
+    std::vector<PyDataReader<T>> _readers;
+    PySampleLogWriter _log;
+    std::vector<dds::sub::cond::ReadCondition> _conditions;
+    dds::core::cond::GuardCondition _wakeup;
+    dds::core::cond::WaitSet _waitset;
+    bool _take;
+    std::mutex _mutex;
+    std::vector<char> _buffer;
+    std::string _error;
+    bool _stop;
+    std::thread _thread;
+};
+
+
+/*
+    Writes the samples of a sample log back through DataWriters from a
+    native thread, in source timestamp order, at the recorded rate scaled
+    by a factor or as fast as possible.
+ */
+template<typename T>
+class PySampleReplayer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    PySampleReplayer(
+            const std::string& path,
+            const std::vector<PyDataWriter<T>>& writers,
+            double rate,
+            const dds::core::optional<dds::core::Time>& start,
+            const dds::core::optional<dds::core::Time>& end,
+            const dds::core::InstanceHandle& instance,
+            bool source_timestamps)
+            : _log(path),
+              _writers(writers),
+              _rate(rate),
+              _source_timestamps(source_timestamps),
+              _replayed(0),
+              _finished(false),
+              _stop(false)
+    {
+        if (writers.empty()) {
+            throw dds::core::InvalidArgumentError("no writers to replay to");
+        }
+        if (writers.size() != 1
+            && writers.size() != this->_log.streams().size()) {
+            throw dds::core::InvalidArgumentError(
+                    "expected one writer, or one writer per recorded reader");
+        }
+        for (auto& writer : writers) {
+            auto writer_type_name = writer.topic().type_name();
+            if (writer_type_name != this->_log.type_name()) {
+                throw dds::core::InvalidArgumentError(
+                        "the log was recorded with type "
+                        + this->_log.type_name() + ", not "
+                        + writer_type_name);
+            }
+        }
+        if (!(rate >= 0)) {
+            throw dds::core::InvalidArgumentError(
+                    "rate must be positive, or 0 to replay as fast as "
+                    "possible");
+        }
+
+        int64_t first = start.has_value()
+                ? sample_log_nanosecs(start.value())
+                : (std::numeric_limits<int64_t>::min)();
+        int64_t last = end.has_value()
+                ? sample_log_nanosecs(end.value())
+                : (std::numeric_limits<int64_t>::max)();
+        if (instance.is_nil()) {
+            this->_offsets = this->_log.by_time(first, last);
+        } else {
+            uint8_t key_hash[16] = { 0 };
+            auto& native = instance->native().keyHash;
+            std::memcpy(
+                    key_hash,
+                    native.value,
+                    (std::min)(
+                            static_cast<size_t>(native.length),
+                            sizeof(key_hash)));
+            this->_offsets = this->_log.by_instance(key_hash, first, last);
+        }
+
+        for (auto& writer : this->_writers) {
+            this->_samples.push_back(PySampleLogCdr<T>::create(writer));
+        }
+        this->_thread = std::thread(&PySampleReplayer<T>::run, this);
+    }
+
+    ~PySampleReplayer()
+    {
+        this->close();
+    }
+
+    const std::string& type_name() const
+    {
+        return this->_log.type_name();
+    }
+
+    const std::vector<std::string>& streams() const
+    {
+        return this->_log.streams();
+    }
+
+    double rate() const
+    {
+        return this->_rate;
+    }
+
+    // Number of records selected for replay
+    size_t record_count() const
+    {
+        return this->_offsets.size();
+    }
+
+    uint64_t replayed_count()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_replayed;
+    }
+
+    bool finished()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_finished;
+    }
+
+    // Waits for the replay to finish; false on timeout
+    bool wait(const dds::core::Duration& timeout)
+    {
+        auto deadline = Clock::now()
+                + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::seconds(timeout.sec())
+                        + std::chrono::nanoseconds(timeout.nanosec()));
+        std::unique_lock<std::mutex> lock(this->_mutex);
+        bool finished = this->_cv.wait_until(lock, deadline, [this]() {
+            return this->_finished;
+        });
+        if (!this->_error.empty()) {
+            throw dds::core::Error("sample replay failed: " + this->_error);
+        }
+        return finished;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (this->_stop) return;
+            this->_stop = true;
+        }
+        this->_cv.notify_all();
+        if (this->_thread.joinable()) {
+            if (PyGILState_Check()) {
+                py::gil_scoped_release release;
+                this->_thread.join();
+            } else {
+                this->_thread.join();
+            }
+        }
+    }
+
+    bool closed()
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        return this->_stop;
+    }
+
+private:
+    void run()
+    {
+        try {
+            auto begin = Clock::now();
+            int64_t first = this->_offsets.empty()
+                    ? 0
+                    : this->_log.record(this->_offsets.front())
+                              .source_timestamp;
+            for (auto offset : this->_offsets) {
+                auto& record = this->_log.record(offset);
+                if (this->_rate > 0) {
+                    auto delay = std::chrono::nanoseconds(
+                            static_cast<int64_t>(
+                                    (record.source_timestamp - first)
+                                    / this->_rate));
+                    std::unique_lock<std::mutex> lock(this->_mutex);
+                    this->_cv.wait_until(
+                            lock,
+                            begin
+                                    + std::chrono::duration_cast<
+                                            Clock::duration>(delay),
+                            [this]() { return this->_stop; });
+                }
+                if (this->closed()) break;
+                this->replay(offset, record);
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                ++this->_replayed;
+            }
+        } catch (const std::exception& ex) {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_error = ex.what();
+        }
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_finished = true;
+        }
+        this->_cv.notify_all();
+    }
+
+    void replay(uint64_t offset, const PySampleLogRecord& record)
+    {
+        size_t index = this->_writers.size() == 1 ? 0 : record.stream;
+        if (index >= this->_writers.size()) return;
+        auto& writer = this->_writers[index];
+        auto& sample = this->_samples[index];
+        auto timestamp = sample_log_time(record.source_timestamp);
+
+        if (record.flags & PySampleLogRecord::VALID_DATA) {
+            PySampleLogCdr<T>::deserialize(
+                    sample,
+                    this->_log.data(offset),
+                    record.data_length);
+            if (this->_source_timestamps) {
+                writer.write(sample, timestamp);
+            } else {
+                writer.write(sample);
+            }
+            return;
+        }
+
+        bool disposed = (record.flags & PySampleLogRecord::DISPOSED) != 0;
+        bool unregistered = (record.flags & PySampleLogRecord::NO_WRITERS) != 0;
+        if (!(record.flags & PySampleLogRecord::HAS_KEY)
+            || (!disposed && !unregistered)) {
+            return;
+        }
+        PySampleLogCdr<T>::deserialize(
+                sample,
+                this->_log.data(offset),
+                record.data_length);
+        auto handle = writer.lookup_instance(sample);
+        if (handle.is_nil()) return;
+        if (disposed) {
+            if (this->_source_timestamps) {
+                writer.dispose_instance(handle, timestamp);
+            } else {
+                writer.dispose_instance(handle);
+            }
+        } else {
+            if (this->_source_timestamps) {
+                writer.unregister_instance(handle, timestamp);
+            } else {
+                writer.unregister_instance(handle);
+            }
+        }
+    }
+
+    PySampleLogReader _log;
+    std::vector<PyDataWriter<T>> _writers;
+    std::vector<T> _samples;
+    double _rate;
+    bool _source_timestamps;
+    std::vector<uint64_t> _offsets;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    uint64_t _replayed;
+    std::string _error;
+    bool _finished;
+    bool _stop;
+    std::thread _thread;
+};
+
+
+// A single entity or any iterable of entities
+template<typename E>
+std::vector<E> sample_log_entities(py::object& entities)
+{
+    std::vector<E> retval;
+    if (py::isinstance<E>(entities)) {
+        retval.push_back(py::cast<E>(entities));
+        return retval;
+    }
+    for (auto entity : entities) {
+        retval.push_back(py::cast<E>(entity));
+    }
+    return retval;
+}
+
+
+template<typename T>
+void init_sample_recorder(
+        py::class_<
+            PySampleRecorder<T>,
+            std::unique_ptr<PySampleRecorder<T>, no_gil_delete<PySampleRecorder<T>>>>& cls)
+{
+    cls.def(py::init([](const std::string& path,
+                        py::object readers,
+                        bool take,
+                        size_t initial_size) {
+                auto v = sample_log_entities<PyDataReader<T>>(readers);
+                py::gil_scoped_release release;
+                return new PySampleRecorder<T>(path, v, take, initial_size);
+            }),
+            py::arg("path"),
+            py::arg("readers"),
+            py::arg("take") = true,
+            py::arg("initial_size") = 64 * 1024 * 1024,
+            py::keep_alive<1, 3>(),
+            "Record the samples received by a DataReader, or a list of "
+            "DataReaders of this type, to a memory-mapped sample log at "
+            "path, from a native thread. The log starts with initial_size "
+            "bytes and doubles when full. If take is True the samples are "
+            "taken from the DataReaders, otherwise they are read and left "
+            "in them.")
+            .def_property_readonly(
+                    "path",
+                    &PySampleRecorder<T>::path,
+                    "The path of the sample log.")
+            .def_property_readonly(
+                    "record_count",
+                    &PySampleRecorder<T>::record_count,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The number of samples recorded.")
+            .def_property_readonly(
+                    "size",
+                    &PySampleRecorder<T>::size,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The size in bytes of the recorded data.")
+            .def("flush",
+                 &PySampleRecorder<T>::flush,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Write the recorded samples to disk.")
+            .def("close",
+                 &PySampleRecorder<T>::close,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Stop recording, truncate the log to its contents and "
+                 "write its index.")
+            .def_property_readonly(
+                    "closed",
+                    &PySampleRecorder<T>::closed,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Whether this recorder has been closed.")
+            .def(
+                    "__enter__",
+                    [](py::object self) { return self; },
+                    "Enter a context for this recorder, to be closed on "
+                    "context exit.")
+            .def(
+                    "__exit__",
+                    [](PySampleRecorder<T>& recorder,
+                       py::object,
+                       py::object,
+                       py::object) { recorder.close(); },
+                    "Exit the context for this recorder, closing it.");
+}
+
+
+template<typename T>
+void init_sample_replayer(
+        py::class_<
+            PySampleReplayer<T>,
+            std::unique_ptr<PySampleReplayer<T>, no_gil_delete<PySampleReplayer<T>>>>& cls)
+{
+    cls.def(py::init([](const std::string& path,
+                        py::object writers,
+                        double rate,
+                        const dds::core::optional<dds::core::Time>& start,
+                        const dds::core::optional<dds::core::Time>& end,
+                        const dds::core::InstanceHandle& instance,
+                        bool source_timestamps) {
+                auto v = sample_log_entities<PyDataWriter<T>>(writers);
+                py::gil_scoped_release release;
+                return new PySampleReplayer<T>(
+                        path,
+                        v,
+                        rate,
+                        start,
+                        end,
+                        instance,
+                        source_timestamps);
+            }),
+            py::arg("path"),
+            py::arg("writers"),
+            py::arg("rate") = 1.0,
+            py::arg("start") = py::none(),
+            py::arg("end") = py::none(),
+            py::arg_v(
+                    "instance",
+                    dds::core::InstanceHandle::nil(),
+                    "InstanceHandle.nil()"),
+            py::arg("source_timestamps") = true,
+            py::keep_alive<1, 3>(),
+            "Replay a sample log from a native thread, in source timestamp "
+            "order, through a DataWriter or a list with one DataWriter per "
+            "recorded DataReader, whose Topics must have the recorded type "
+            "name. A rate of 1 replays at the recorded pace, "
+            "2 twice as fast and 0 as fast as possible. start and end "
+            "select a range of source timestamps and instance the samples "
+            "of a single instance. If source_timestamps is True the samples "
+            "are written with their recorded source timestamp.")
+            .def_property_readonly(
+                    "type_name",
+                    &PySampleReplayer<T>::type_name,
+                    "The name of the recorded type.")
+            .def_property_readonly(
+                    "topic_names",
+                    &PySampleReplayer<T>::streams,
+                    "The topics of the recorded DataReaders.")
+            .def_property_readonly(
+                    "rate",
+                    &PySampleReplayer<T>::rate,
+                    "The replay rate relative to the recorded pace.")
+            .def_property_readonly(
+                    "record_count",
+                    &PySampleReplayer<T>::record_count,
+                    "The number of samples selected for replay.")
+            .def_property_readonly(
+                    "replayed_count",
+                    &PySampleReplayer<T>::replayed_count,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The number of samples replayed so far.")
+            .def_property_readonly(
+                    "finished",
+                    &PySampleReplayer<T>::finished,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Whether the replay has finished.")
+            .def("wait",
+                 &PySampleReplayer<T>::wait,
+                 py::arg_v(
+                         "timeout",
+                         dds::core::Duration::infinite(),
+                         "Duration.infinite"),
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Wait for the replay to finish. Returns False if the "
+                 "timeout expires first.")
+            .def("close",
+                 &PySampleReplayer<T>::close,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Stop replaying.")
+            .def_property_readonly(
+                    "closed",
+                    &PySampleReplayer<T>::closed,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Whether this replayer has been closed.")
+            .def(
+                    "__enter__",
+                    [](py::object self) { return self; },
+                    "Enter a context for this replayer, to be closed on "
+                    "context exit.")
+            .def(
+                    "__exit__",
+                    [](PySampleReplayer<T>& replayer,
+                       py::object,
+                       py::object,
+                       py::object) { replayer.close(); },
+                    "Exit the context for this replayer, closing it.");
+}
+
+}  // namespace pyrti
@@ -311,6 +311,22 @@ public:
     {
         this->qos(q);
     }
+
+    // Only available when T is DynamicData
+    const dds::core::xtypes::DynamicType& dynamic_type() const
+    {
+        return this->_type_handle.get(*this);
+    }
+
+    // Shared with the DataReaders, DataWriters and ContentFilteredTopics
+    // created from this Topic
+    const PyDynamicTypeHandle<T>& type_handle() const
+    {
+        return this->_type_handle;
+    }
+
+private:
+    PyDynamicTypeHandle<T> _type_handle;
 };
 
 
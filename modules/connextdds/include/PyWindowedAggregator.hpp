@@ -0,0 +1,157 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <dds/core/cond/GuardCondition.hpp>
+#include <dds/core/cond/WaitSet.hpp>
+#include <dds/sub/cond/ReadCondition.hpp>
+#include "PyDataReader.hpp"
+#include "PyDynamicDataPath.hpp"
+#include "PyInstanceHandle.hpp"
+
+namespace pyrti {
+
+/*
+    Computes aggregates of numeric fields over sliding windows of source
+    time, per instance.
+
+    A native thread takes (or reads) the samples of a DynamicData reader
+    without the GIL and appends the value of every aggregated field to a
+    time-ordered series. Windows end at the newest source timestamp received
+    by the aggregator, so instances that stop publishing age out. Aggregates
+    are computed when results are requested, either by polling or from the
+    native thread once per period.
+ */
+class PYRTI_SYMBOL_HIDDEN PyWindowedAggregator {
+public:
+    enum class Function { COUNT, SUM, MEAN, MIN, MAX, STDDEV, PERCENTILE };
+
+    struct Spec {
+        PyDynamicDataPath path;
+        std::string aggregate;
+        Function function;
+        // Only for PERCENTILE, in [0, 100]
+        double percentile;
+        dds::core::Duration window;
+        // Index of the series of this spec's path
+        size_t series;
+    };
+
+    struct Result {
+        dds::core::InstanceHandle instance_handle;
+        std::string path;
+        std::string aggregate;
+        dds::core::Duration window;
+        double value;
+        uint64_t count;
+        dds::core::Time window_end;
+    };
+
+    PyWindowedAggregator(
+            const PyDataReader<dds::core::xtypes::DynamicData>& reader,
+            const std::vector<std::tuple<
+                    py::object,
+                    std::string,
+                    dds::core::Duration>>& specs,
+            bool take,
+            const dds::core::optional<dds::core::Duration>& period,
+            py::object callback);
+
+    ~PyWindowedAggregator();
+
+    std::vector<Result> results();
+
+    const std::vector<Spec>& specs() const
+    {
+        return this->_specs;
+    }
+
+    const dds::core::optional<dds::core::Duration>& period() const
+    {
+        return this->_period;
+    }
+
+    uint64_t sample_count();
+
+    void close();
+
+    bool closed();
+
+    // Drops the callback; must be called with the GIL held
+    void release_callback();
+
+private:
+    typedef std::deque<std::pair<int64_t, double>> Series;
+
+    struct Instance {
+        // One series per distinct path
+        std::vector<Series> series;
+    };
+
+    void run();
+
+    size_t drain();
+
+    void add(
+            dds::core::xtypes::DynamicData& data,
+            const dds::sub::SampleInfo& info);
+
+    void evict(Instance& instance);
+
+    void publish();
+
+    static const int32_t MAX_BATCH = 256;
+
+    PyDataReader<dds::core::xtypes::DynamicData> _reader;
+    std::vector<Spec> _specs;
+    // The compiled path of each series
+    std::vector<PyDynamicDataPath> _paths;
+    // Longest window of the specs of each series
+    std::vector<int64_t> _horizons;
+    dds::core::optional<dds::core::Duration> _period;
+    py::object _callback;
+    dds::sub::cond::ReadCondition _condition;
+    dds::core::cond::GuardCondition _wakeup;
+    dds::core::cond::WaitSet _waitset;
+    bool _take;
+    std::mutex _mutex;
+    std::unordered_map<
+            dds::core::InstanceHandle,
+            Instance,
+            PyInstanceHandleHash>
+            _instances;
+    // Newest source timestamp received, in nanoseconds
+    int64_t _watermark;
+    uint64_t _sample_count;
+    // Shared with the thread, which outlives this object when the callback
+    // destroys it
+    std::shared_ptr<std::atomic<bool>> _stop;
+    std::thread _thread;
+};
+
+
+template<>
+inline void py_destroy(PyWindowedAggregator* ptr)
+{
+    ptr->close();
+    ptr->release_callback();
+}
+
+}  // namespace pyrti
@@ -0,0 +1,277 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#pragma once
+
+#include "PyConnext.hpp"
+#include "PyContentFilter.hpp"
+#include <algorithm>
+
+namespace pyrti {
+
+// The DataReaders matched by a PyWriterContentFilterBatch
+struct PyWriterContentFilterBatchState {
+    struct Reader {
+        rti::core::Cookie cookie;
+        dds::core::optional<py::object>* compile_data;
+    };
+
+    std::vector<Reader> readers;
+    dds::core::vector<rti::core::Cookie> matched;
+
+    // Tuple of the readers' compile data, rebuilt when readers change
+    py::object compile_data;
+};
+
+
+// Decodes the result of evaluate_batch: an int whose bit i is the result
+// of reader i, a 1-byte buffer such as a bytearray or a numpy bool array,
+// or a sequence of truth values.
+inline std::vector<uint8_t> writer_filter_batch_matches(
+        py::handle result,
+        size_t count)
+{
+    std::vector<uint8_t> matches(count, 0);
+    if (py::isinstance<py::int_>(result)) {
+        auto bytes = py::cast<std::string>(
+                result.attr("to_bytes")((count + 7) / 8, "little"));
+        for (size_t i = 0; i < count; ++i) {
+            matches[i] = (bytes[i / 8] >> (i % 8)) & 1;
+        }
+    } else if (PyObject_CheckBuffer(result.ptr())) {
+        auto info = py::reinterpret_borrow<py::buffer>(result).request();
+        if (info.ndim != 1 || info.itemsize != 1
+            || static_cast<size_t>(info.shape[0]) != count) {
+            throw py::value_error(
+                    "evaluate_batch must return one byte per DataReader");
+        }
+        auto data = static_cast<const uint8_t*>(info.ptr);
+        for (size_t i = 0; i < count; ++i) {
+            matches[i] = data[i * info.strides[0]] != 0;
+        }
+    } else {
+        size_t i = 0;
+        for (auto item : result) {
+            if (i < count) {
+                int truth = PyObject_IsTrue(item.ptr());
+                if (truth < 0) throw py::error_already_set();
+                matches[i] = static_cast<uint8_t>(truth);
+            }
+            ++i;
+        }
+        if (i != count) {
+            throw py::value_error(
+                    "evaluate_batch must return one result per DataReader");
+        }
+    }
+    return matches;
+}
+
+
+/*
+    Writer-side content filter that evaluates a sample for all the matched
+    DataReaders with a single call into Python. The DataReaders' compile
+    data is kept natively and passed to evaluate_batch as a tuple; if
+    evaluate_batch is not overridden, evaluate is called for each reader
+    under one acquisition of the GIL.
+ */
+template<typename T>
+class PyWriterContentFilterBatch
+        : public PyContentFilter<
+                  T,
+                  rti::topic::WriterContentFilter<
+                          T,
+                          dds::core::optional<py::object>,
+                          PyWriterContentFilterBatchState>> {
+public:
+    typedef rti::topic::WriterContentFilter<
+            T,
+            dds::core::optional<py::object>,
+            PyWriterContentFilterBatchState>
+            Base;
+
+    explicit PyWriterContentFilterBatch(bool key_only = false)
+            : _key_only(key_only)
+    {
+    }
+
+    bool key_only() const
+    {
+        return this->_key_only;
+    }
+
+    void key_only(bool value)
+    {
+        this->_key_only = value;
+    }
+
+    PyWriterContentFilterBatchState& writer_attach() override
+    {
+        return *(new PyWriterContentFilterBatchState());
+    }
+
+    void writer_detach(PyWriterContentFilterBatchState& state) override
+    {
+        py::gil_scoped_acquire acquire;
+        for (auto& reader : state.readers) {
+            delete reader.compile_data;
+        }
+        delete &state;
+    }
+
+    void writer_compile(
+            PyWriterContentFilterBatchState& state,
+            rti::topic::ExpressionProperty& prop,
+            const std::string& expression,
+            const std::vector<std::string>& parameters,
+            const dds::core::optional<dds::core::xtypes::DynamicType>&
+                    type_code,
+            const std::string& type_class_name,
+            const rti::core::Cookie& cookie) override
+    {
+        py::gil_scoped_acquire acquire;
+        // A key-only filter lets the writer cache its result per instance
+        prop.key_only_filter(this->_key_only);
+        auto it = find_reader(state, cookie);
+        auto& compile_data = this->compile(
+                expression,
+                parameters,
+                type_code,
+                type_class_name,
+                it == state.readers.end() ? nullptr : it->compile_data);
+        if (it == state.readers.end()) {
+            state.readers.push_back({ cookie, &compile_data });
+        } else {
+            it->compile_data = &compile_data;
+        }
+        state.compile_data = py::object();
+    }
+
+    void writer_finalize(
+            PyWriterContentFilterBatchState& state,
+            const rti::core::Cookie& cookie) override
+    {
+        py::gil_scoped_acquire acquire;
+        auto it = find_reader(state, cookie);
+        if (it == state.readers.end()) return;
+        auto compile_data = it->compile_data;
+        state.readers.erase(it);
+        state.compile_data = py::object();
+        this->finalize(*compile_data);
+    }
+
+    dds::core::vector<rti::core::Cookie>& writer_evaluate(
+            PyWriterContentFilterBatchState& state,
+            const T& sample,
+            const rti::topic::FilterSampleInfo& meta_data) override
+    {
+        py::gil_scoped_acquire acquire;
+        auto& readers = state.readers;
+        state.matched.resize(readers.size());
+        size_t count = 0;
+        py::function overload = py::get_overload(
+                static_cast<const Base*>(this),
+                "evaluate_batch");
+        if (overload) {
+            auto result =
+                    overload(compile_data_tuple(state), sample, meta_data);
+            auto matches = writer_filter_batch_matches(result, readers.size());
+            for (size_t i = 0; i < readers.size(); ++i) {
+                if (matches[i]) state.matched[count++] = readers[i].cookie;
+            }
+        } else {
+            for (auto& reader : readers) {
+                if (this->evaluate(*reader.compile_data, sample, meta_data)) {
+                    state.matched[count++] = reader.cookie;
+                }
+            }
+        }
+        state.matched.resize(count);
+        return state.matched;
+    }
+
+    void writer_return_loan(
+            PyWriterContentFilterBatchState&,
+            dds::core::vector<rti::core::Cookie>&) override
+    {
+        // The matched cookies are reused by the next writer_evaluate
+    }
+
+private:
+    static std::vector<PyWriterContentFilterBatchState::Reader>::iterator
+    find_reader(
+            PyWriterContentFilterBatchState& state,
+            const rti::core::Cookie& cookie)
+    {
+        return std::find_if(
+                state.readers.begin(),
+                state.readers.end(),
+                [&cookie](const PyWriterContentFilterBatchState::Reader& r) {
+                    return r.cookie == cookie;
+                });
+    }
+
+    static py::object& compile_data_tuple(
+            PyWriterContentFilterBatchState& state)
+    {
+        if (!state.compile_data) {
+            py::tuple tuple(state.readers.size());
+            for (size_t i = 0; i < state.readers.size(); ++i) {
+                auto& data = *state.readers[i].compile_data;
+                tuple[i] = has_value(data) ? get_value(data) : py::none();
+            }
+            state.compile_data = tuple;
+        }
+        return state.compile_data;
+    }
+
+    bool _key_only;
+};
+
+template<typename T>
+void init_writer_content_filter_batch(
+        py::class_<
+                typename PyWriterContentFilterBatch<T>::Base,
+                rti::topic::ContentFilter<T, dds::core::optional<py::object>>,
+                PyWriterContentFilterBatch<T>>& cls)
+{
+    typedef typename PyWriterContentFilterBatch<T>::Base Base;
+
+    cls.def(py::init<bool>(),
+            py::arg("key_only") = false,
+            "Create a writer-side filter that evaluates each sample for all "
+            "the matched DataReaders with one call to evaluate_batch. "
+            "key_only declares that the filter only reads the key fields, "
+            "so the DataWriter can cache the result of each instance.")
+            .def_property(
+                    "key_only",
+                    [](Base& self) {
+                        return static_cast<PyWriterContentFilterBatch<T>&>(
+                                       self)
+                                .key_only();
+                    },
+                    [](Base& self, bool value) {
+                        static_cast<PyWriterContentFilterBatch<T>&>(self)
+                                .key_only(value);
+                    },
+                    "Whether the filter only reads the key fields. Applies "
+                    "to the DataReaders matched after it is set.")
+            .doc() =
+            "Writer-side content filter evaluated in batches. Subclasses "
+            "implement compile, evaluate and finalize as for a ContentFilter "
+            "and may implement evaluate_batch(compile_data, sample, "
+            "meta_data), which receives a tuple with the compile data of "
+            "every matched DataReader and returns which of them pass: an "
+            "int bitmap, a bytes-like object or numpy bool array, or a "
+            "sequence of bools, in the order of compile_data.";
+}
+
+}  // namespace pyrti
@@ -14,15 +14,37 @@
 #include <dds/core/BuiltinTopicTypes.hpp>
 #include "PyInitType.hpp"
 #include "PyInitOpaqueTypeContainers.hpp"
+#include "PyBuiltinTypeBuffer.hpp"
 
 INIT_OPAQUE_TYPE_CONTAINERS(dds::core::BytesTopicType);
 
 namespace pyrti {
 
+static void set_bytes_data(
+        dds::core::BytesTopicType& sample,
+        const py::buffer& data)
+{
+    assign_bytes_payload(
+            sample,
+            data,
+            [](dds::core::BytesTopicType& s, const std::vector<uint8_t>& v) {
+                s.data(v);
+            });
+}
+
+
 template<>
 void init_class_defs(py::class_<dds::core::BytesTopicType>& cls)
 {
     cls.def(py::init<>(), "Creates a sample with an empty array of bytes.")
+            .def(py::init([](const py::buffer& data) {
+                     dds::core::BytesTopicType sample;
+                     set_bytes_data(sample, data);
+                     return sample;
+                 }),
+                 py::arg("data"),
+                 "Creates a sample from the contents of a bytes-like object "
+                 "(bytes, bytearray, memoryview...).")
             .def(py::init<const std::vector<uint8_t>&>(),
                  py::arg("data"),
                  "Creates a sample from the provided byte sequence.")
@@ -30,12 +52,35 @@ void init_class_defs(py::class_<dds::core::BytesTopicType>& cls)
                     "data",
                     (std::vector<uint8_t>(dds::core::BytesTopicType::*)() const)
                             & dds::core::BytesTopicType::data,
-                    (void (dds::core::BytesTopicType::*)(
-                            const std::vector<uint8_t>&))
-                            & dds::core::BytesTopicType::data,
+                    [](dds::core::BytesTopicType& b, const py::object& data) {
+                        if (py::isinstance<py::buffer>(data)) {
+                            set_bytes_data(
+                                    b,
+                                    py::reinterpret_borrow<py::buffer>(data));
+                        } else {
+                            auto bytes = data.cast<std::vector<uint8_t>>();
+                            check_bytes_payload_resize(b, bytes.size());
+                            b.data(bytes);
+                        }
+                    },
                     "The byte sequence."
                     "\n\n"
-                    "This property's getter returns a deep copy.")
+                    "This property's getter returns a deep copy. The setter "
+                    "also accepts any bytes-like object, which is copied in "
+                    "place when its length matches the current length. Use "
+                    "memoryview(sample) to access the bytes without copying; "
+                    "the length can't change while the memoryview is open.")
+            .def("__bytes__",
+                 [](dds::core::BytesTopicType& b) {
+                     auto info = bytes_payload_buffer_info(b);
+                     return py::bytes(
+                             static_cast<const char*>(info.ptr),
+                             static_cast<size_t>(info.size));
+                 },
+                 "Copy the byte sequence into a bytes object.")
+            .def_buffer([](dds::core::BytesTopicType& b) {
+                return bytes_payload_buffer_info(b);
+            })
             .def("length",
                  &dds::core::BytesTopicType::length,
                  "Get the number of bytes.")
@@ -50,7 +95,8 @@ void init_class_defs(py::class_<dds::core::BytesTopicType>& cls)
             .def("__len__", &dds::core::BytesTopicType::length)
             .def(py::self == py::self, "Test for equality.")
             .def(py::self != py::self, "Test for inequality.");
-    ;
+
+    track_bytes_payload_exports(cls);
 
     py::implicitly_convertible<
             std::vector<uint8_t>,
@@ -65,7 +111,8 @@ void process_inits<dds::core::BytesTopicType>(py::module& m, ClassInitList& l)
         return init_type_class<dds::core::BytesTopicType>(
                 m,
                 l,
-                "BytesTopicType");
+                "BytesTopicType",
+                py::buffer_protocol());
     });
 }
 
@@ -13,6 +13,7 @@
 #include "PyConnext.hpp"
 #include "PySeq.hpp"
 #include "PyEntity.hpp"
+#include "PyInstanceHandle.hpp"
 #include <dds/core/InstanceHandle.hpp>
 
 using namespace dds::core;
@@ -43,7 +44,15 @@ void init_class_defs(py::class_<InstanceHandle>& cls)
                     &InstanceHandle::nil,
                     "Create a nil InstanceHandle.")
             .def(py::self == py::self, "Test for equality.")
-            .def(py::self != py::self, "Test for inequality.");
+            .def(py::self != py::self, "Test for inequality.")
+            .def(
+                    "__hash__",
+                    [](const InstanceHandle& h) {
+                        return static_cast<py::ssize_t>(
+                                PyInstanceHandleHash()(h));
+                    },
+                    "Hash of the instance's key hash, stable across "
+                    "processes.");
 }
 
 template<>
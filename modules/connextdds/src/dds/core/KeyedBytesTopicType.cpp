@@ -14,19 +14,51 @@
 #include <dds/core/BuiltinTopicTypes.hpp>
 #include "PyInitType.hpp"
 #include "PyInitOpaqueTypeContainers.hpp"
+#include "PyBuiltinTypeBuffer.hpp"
 
 INIT_OPAQUE_TYPE_CONTAINERS(dds::core::KeyedBytesTopicType);
 
 namespace pyrti {
 
+static void set_keyed_bytes_value(
+        dds::core::KeyedBytesTopicType& sample,
+        const py::buffer& value)
+{
+    assign_bytes_payload(
+            sample,
+            value,
+            [](dds::core::KeyedBytesTopicType& s,
+               const std::vector<uint8_t>& v) { s.value(v); });
+}
+
+
 template<>
 void init_class_defs(py::class_<dds::core::KeyedBytesTopicType>& cls)
 {
     cls.def(py::init<>(), "Creates a sample with an empty array of bytes.")
+            .def(py::init([](const std::string& key, const py::buffer& value) {
+                     dds::core::KeyedBytesTopicType sample;
+                     sample.key(dds::core::string(key));
+                     set_keyed_bytes_value(sample, value);
+                     return sample;
+                 }),
+                 py::arg("key"),
+                 py::arg("value"),
+                 "Creates a sample from the provided key and the contents of "
+                 "a bytes-like object (bytes, bytearray, memoryview...).")
             .def(py::init<const std::string&, const std::vector<uint8_t>&>(),
                  py::arg("key"),
                  py::arg("value"),
                  "Creates a sample from the provided key and value.")
+            .def(py::init([](const std::pair<std::string, py::buffer>& p) {
+                     dds::core::KeyedBytesTopicType sample;
+                     sample.key(dds::core::string(p.first));
+                     set_keyed_bytes_value(sample, p.second);
+                     return sample;
+                 }),
+                 py::arg("pair"),
+                 "Creates a sample from the provided key and bytes-like "
+                 "value.")
             .def(py::init([](const std::pair<std::string, std::vector<uint8_t>>&
                                      p) {
                      return dds::core::KeyedBytesTopicType(p.first, p.second);
@@ -48,12 +80,36 @@ void init_class_defs(py::class_<dds::core::KeyedBytesTopicType>& cls)
                     (std::vector<uint8_t>(dds::core::KeyedBytesTopicType::*)()
                              const)
                             & dds::core::KeyedBytesTopicType::value,
-                    (void (dds::core::KeyedBytesTopicType::*)(
-                            const std::vector<uint8_t>&))
-                            & dds::core::KeyedBytesTopicType::value,
+                    [](dds::core::KeyedBytesTopicType& b,
+                       const py::object& value) {
+                        if (py::isinstance<py::buffer>(value)) {
+                            set_keyed_bytes_value(
+                                    b,
+                                    py::reinterpret_borrow<py::buffer>(value));
+                        } else {
+                            auto bytes = value.cast<std::vector<uint8_t>>();
+                            check_bytes_payload_resize(b, bytes.size());
+                            b.value(bytes);
+                        }
+                    },
                     "The byte sequence."
                     "\n\n"
-                    "This property's getter returns a deep copy.")
+                    "This property's getter returns a deep copy. The setter "
+                    "also accepts any bytes-like object, which is copied in "
+                    "place when its length matches the current length. Use "
+                    "memoryview(sample) to access the bytes without copying; "
+                    "the length can't change while the memoryview is open.")
+            .def("__bytes__",
+                 [](dds::core::KeyedBytesTopicType& b) {
+                     auto info = bytes_payload_buffer_info(b);
+                     return py::bytes(
+                             static_cast<const char*>(info.ptr),
+                             static_cast<size_t>(info.size));
+                 },
+                 "Copy the byte sequence into a bytes object.")
+            .def_buffer([](dds::core::KeyedBytesTopicType& b) {
+                return bytes_payload_buffer_info(b);
+            })
             .def("length",
                  &dds::core::KeyedBytesTopicType::length,
                  "Get the number of bytes.")
@@ -69,6 +125,8 @@ void init_class_defs(py::class_<dds::core::KeyedBytesTopicType>& cls)
             .def(py::self == py::self, "Test for equality.")
             .def(py::self != py::self, "Test for inequality.");
 
+    track_bytes_payload_exports(cls);
+
     py::implicitly_convertible<
             std::pair<std::string, std::vector<uint8_t>>,
             dds::core::KeyedBytesTopicType>();
@@ -84,7 +142,8 @@ void process_inits<dds::core::KeyedBytesTopicType>(
         return init_type_class<dds::core::KeyedBytesTopicType>(
                 m,
                 l,
-                "KeyedBytesTopicType");
+                "KeyedBytesTopicType",
+                py::buffer_protocol());
     });
 }
 
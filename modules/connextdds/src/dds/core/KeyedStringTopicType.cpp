@@ -14,6 +14,7 @@
 #include <dds/core/BuiltinTopicTypes.hpp>
 #include "PyInitType.hpp"
 #include "PyInitOpaqueTypeContainers.hpp"
+#include "PyBuiltinTypeBuffer.hpp"
 
 INIT_OPAQUE_TYPE_CONTAINERS(dds::core::KeyedStringTopicType);
 
@@ -27,6 +28,16 @@ void init_class_defs(py::class_<dds::core::KeyedStringTopicType>& cls)
                  py::arg("key"),
                  py::arg("value"),
                  "Initialize sample with provided key and value.")
+            .def(py::init([](const std::string& key, const py::buffer& value) {
+                     dds::core::KeyedStringTopicType sample;
+                     sample.key(dds::core::string(key));
+                     sample.value(byte_buffer_to_string(value));
+                     return sample;
+                 }),
+                 py::arg("key"),
+                 py::arg("value"),
+                 "Initialize sample with provided key and the contents of a "
+                 "bytes-like object as the value.")
             .def(py::init([](const std::pair<std::string, std::string>& p) {
                      return dds::core::KeyedStringTopicType(p.first, p.second);
                  }),
@@ -48,10 +59,18 @@ void init_class_defs(py::class_<dds::core::KeyedStringTopicType>& cls)
                         return s.value().to_std_string();
                     },
                     [](dds::core::KeyedStringTopicType& s,
-                       const std::string& value) {
-                        s.value(dds::core::string(value));
+                       const py::object& value) {
+                        if (py::isinstance<py::buffer>(value)) {
+                            s.value(byte_buffer_to_string(
+                                    py::reinterpret_borrow<py::buffer>(value)));
+                        } else {
+                            s.value(dds::core::string(
+                                    value.cast<std::string>()));
+                        }
                     },
-                    "The sample's value string.")
+                    "The sample's value string."
+                    "\n\n"
+                    "The setter also accepts any bytes-like object.")
             .def("__str__",
                  [](const dds::core::KeyedStringTopicType& s) {
                      return s.key().to_std_string() + " => "
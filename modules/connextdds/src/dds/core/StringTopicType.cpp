@@ -14,6 +14,7 @@
 #include <dds/core/BuiltinTopicTypes.hpp>
 #include "PyInitType.hpp"
 #include "PyInitOpaqueTypeContainers.hpp"
+#include "PyBuiltinTypeBuffer.hpp"
 
 INIT_OPAQUE_TYPE_CONTAINERS(dds::core::StringTopicType);
 
@@ -26,16 +27,35 @@ void init_class_defs(py::class_<dds::core::StringTopicType>& cls)
             .def(py::init<const std::string&>(),
                  py::arg("data"),
                  "Initialize sample with provided string.")
+            .def(py::init([](const py::buffer& data) {
+                     dds::core::StringTopicType sample;
+                     sample.data(byte_buffer_to_string(data));
+                     return sample;
+                 }),
+                 py::arg("data"),
+                 "Initialize sample with the contents of a bytes-like object "
+                 "(bytearray, memoryview...).")
             .def_property(
                     "data",
                     [](const dds::core::StringTopicType& s) {
                         return s.data().to_std_string();
                     },
-                    [](dds::core::StringTopicType& s,
-                       const std::string& value) {
-                        s.data(dds::core::string(value));
+                    [](dds::core::StringTopicType& s, const py::object& value) {
+                        if (py::isinstance<py::buffer>(value)) {
+                            s.data(byte_buffer_to_string(
+                                    py::reinterpret_borrow<py::buffer>(value)));
+                        } else {
+                            s.data(dds::core::string(value.cast<std::string>()));
+                        }
                     },
-                    "The sample's string data.")
+                    "The sample's string data."
+                    "\n\n"
+                    "The setter also accepts any bytes-like object.")
+            .def("__bytes__",
+                 [](const dds::core::StringTopicType& s) {
+                     return py::bytes(s.data().to_std_string());
+                 },
+                 "Copy the string's bytes into a bytes object.")
             .def("__str__",
                  [](const dds::core::StringTopicType& s) {
                      return s.data().to_std_string();
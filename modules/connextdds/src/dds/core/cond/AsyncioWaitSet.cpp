@@ -0,0 +1,375 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#include "PyConnext.hpp"
+#include "PyAsyncioWaitSet.hpp"
+#include <algorithm>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace dds::core::cond;
+
+namespace pyrti {
+
+// Converts a native exception as a regular binding would
+static py::object exception_value(const std::exception_ptr& error)
+{
+    py::cpp_function raise([error]() { std::rethrow_exception(error); });
+    try {
+        raise();
+    } catch (py::error_already_set& e) {
+        e.restore();
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        PyErr_NormalizeException(&type, &value, &traceback);
+        if (traceback != nullptr) {
+            PyException_SetTraceback(value, traceback);
+        }
+        Py_XDECREF(type);
+        Py_XDECREF(traceback);
+        return py::reinterpret_steal<py::object>(value);
+    }
+    return py::none();
+}
+
+
+PyAsyncioWaitSet::PyAsyncioWaitSet()
+        : _armed(false), _stop(false), _has_result(false), _fds { -1, -1 }
+{
+#ifdef _WIN32
+    throw dds::core::UnsupportedError(
+            "AsyncioWaitSet is not supported on this platform");
+#else
+    if (::pipe(this->_fds) != 0) {
+        throw dds::core::Error("Failed to create AsyncioWaitSet pipe");
+    }
+    for (int fd : this->_fds) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+#endif
+    this->_waitset.attach_condition(this->_wakeup);
+}
+
+
+PyAsyncioWaitSet::~PyAsyncioWaitSet()
+{
+    this->close();
+}
+
+
+void PyAsyncioWaitSet::attach_condition(PyICondition& condition)
+{
+    this->_waitset.attach_condition(condition.get_condition());
+    this->_wakeup.trigger_value(true);
+}
+
+
+void PyAsyncioWaitSet::detach_condition(PyICondition& condition)
+{
+    this->_waitset.detach_condition(condition.get_condition());
+    this->_wakeup.trigger_value(true);
+}
+
+
+py::object PyAsyncioWaitSet::wait()
+{
+    if (this->closed()) {
+        throw dds::core::AlreadyClosedError("AsyncioWaitSet already closed");
+    }
+    py::object loop = py::module::import("asyncio").attr("get_running_loop")();
+    if (!this->_loop) {
+        this->start(loop);
+    } else if (!this->_loop.is(loop)) {
+        throw dds::core::PreconditionNotMetError(
+                "AsyncioWaitSet is in use by another event loop");
+    }
+
+    // Drop the futures that were cancelled, e.g. by a wait timeout
+    this->_futures.erase(
+            std::remove_if(
+                    this->_futures.begin(),
+                    this->_futures.end(),
+                    [](py::object& f) {
+                        return f.attr("done")().cast<bool>();
+                    }),
+            this->_futures.end());
+
+    py::object future = loop.attr("create_future")();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        error = this->_error;
+        this->_armed = true;
+    }
+    if (error) {
+        future.attr("set_exception")(exception_value(error));
+        return future;
+    }
+    this->_futures.push_back(future);
+    this->_cv.notify_one();
+    return future;
+}
+
+
+py::object PyAsyncioWaitSet::wait(const dds::core::Duration& timeout)
+{
+    double seconds = timeout.sec() + timeout.nanosec() / 1e9;
+    return py::module::import("asyncio").attr("wait_for")(
+            this->wait(),
+            seconds);
+}
+
+
+void PyAsyncioWaitSet::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        if (this->_stop) return;
+        this->_stop = true;
+    }
+    this->_cv.notify_one();
+    this->_wakeup.trigger_value(true);
+    if (this->_thread.joinable()) {
+        if (PyGILState_Check()) {
+            py::gil_scoped_release release;
+            this->_thread.join();
+        } else {
+            this->_thread.join();
+        }
+    }
+
+    if (Py_IsInitialized()) {
+        py::gil_scoped_acquire acquire;
+        if (this->_loop) {
+            try {
+                this->_loop.attr("remove_reader")(this->_fds[0]);
+            } catch (py::error_already_set&) {
+                // The loop may already be closed
+            }
+            for (auto& future : this->_futures) {
+                if (!future.attr("done")().cast<bool>()) {
+                    future.attr("cancel")();
+                }
+            }
+        }
+        this->_futures.clear();
+        this->_on_readable = py::object();
+        this->_loop = py::object();
+    } else {
+        // Nothing can be released once the interpreter is gone
+        for (auto& future : this->_futures) {
+            future.release();
+        }
+        this->_on_readable.release();
+        this->_loop.release();
+    }
+
+#ifndef _WIN32
+    for (int& fd : this->_fds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+
+bool PyAsyncioWaitSet::closed()
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_stop;
+}
+
+
+void PyAsyncioWaitSet::start(py::object& loop)
+{
+    this->_loop = loop;
+    this->_on_readable = py::cpp_function([this]() { this->on_readable(); });
+    loop.attr("add_reader")(this->_fds[0], this->_on_readable);
+    this->_thread = std::thread(&PyAsyncioWaitSet::run, this);
+}
+
+
+void PyAsyncioWaitSet::run()
+{
+    Condition wakeup(this->_wakeup);
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_cv.wait(lock, [this]() {
+                return this->_stop || (this->_armed && !this->_has_result);
+            });
+            if (this->_stop) return;
+        }
+
+        std::vector<Condition> triggered;
+        try {
+            for (auto& condition : this->_waitset.wait()) {
+                if (condition == wakeup) {
+                    this->_wakeup.trigger_value(false);
+                } else {
+                    triggered.push_back(condition);
+                }
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                this->_error = std::current_exception();
+            }
+            this->notify_loop();
+            return;
+        }
+        if (triggered.empty()) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (this->_stop) return;
+            this->_result = std::move(triggered);
+            this->_has_result = true;
+            this->_armed = false;
+        }
+        this->notify_loop();
+    }
+}
+
+
+void PyAsyncioWaitSet::notify_loop()
+{
+#ifndef _WIN32
+    char signal = 1;
+    // If the pipe is full the loop has already been signalled
+    ssize_t written = ::write(this->_fds[1], &signal, 1);
+    (void) written;
+#endif
+}
+
+
+void PyAsyncioWaitSet::on_readable()
+{
+#ifndef _WIN32
+    char buffer[64];
+    while (::read(this->_fds[0], buffer, sizeof(buffer)) > 0) {
+    }
+#endif
+
+    std::vector<Condition> result;
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        error = this->_error;
+        if (!error && !this->_has_result) return;
+        result.swap(this->_result);
+        this->_has_result = false;
+    }
+
+    std::vector<py::object> futures;
+    futures.swap(this->_futures);
+    if (error) {
+        py::object exception = exception_value(error);
+        for (auto& future : futures) {
+            if (!future.attr("done")().cast<bool>()) {
+                future.attr("set_exception")(exception);
+            }
+        }
+        return;
+    }
+    py::object triggered = py::cast(PyTriggeredConditions(std::move(result)));
+    for (auto& future : futures) {
+        if (!future.attr("done")().cast<bool>()) {
+            future.attr("set_result")(triggered);
+        }
+    }
+}
+
+
+template<>
+void init_class_defs(
+        py::class_<
+            PyAsyncioWaitSet,
+            std::unique_ptr<PyAsyncioWaitSet, no_gil_delete<PyAsyncioWaitSet>>>& cls)
+{
+    cls.def(py::init<>(),
+            "Create an AsyncioWaitSet with no conditions attached.")
+            .def("attach_condition",
+                 &PyAsyncioWaitSet::attach_condition,
+                 py::arg("condition"),
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Attach a condition to this AsyncioWaitSet.")
+            .def("detach_condition",
+                 &PyAsyncioWaitSet::detach_condition,
+                 py::arg("condition"),
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Detach a condition from this AsyncioWaitSet.")
+            .def(
+                    "__iadd__",
+                    [](py::object self, PyICondition& c) {
+                        self.cast<PyAsyncioWaitSet&>().attach_condition(c);
+                        return self;
+                    },
+                    py::is_operator(),
+                    "Attach a condition to this AsyncioWaitSet.")
+            .def(
+                    "__isub__",
+                    [](py::object self, PyICondition& c) {
+                        self.cast<PyAsyncioWaitSet&>().detach_condition(c);
+                        return self;
+                    },
+                    py::is_operator(),
+                    "Detach a condition from this AsyncioWaitSet.")
+            .def("wait",
+                 (py::object(PyAsyncioWaitSet::*)()) & PyAsyncioWaitSet::wait,
+                 py::keep_alive<0, 1>(),
+                 "Wait for attached conditions to trigger. Returns an "
+                 "awaitable resolved with the TriggeredConditions by the "
+                 "running event loop, without using an executor thread.")
+            .def("wait",
+                 (py::object(PyAsyncioWaitSet::*)(const dds::core::Duration&))
+                         & PyAsyncioWaitSet::wait,
+                 py::arg("timeout"),
+                 py::keep_alive<0, 1>(),
+                 "Wait for attached conditions to trigger with a timeout. "
+                 "The awaitable raises asyncio.TimeoutError if no condition "
+                 "triggers in time.")
+            .def("close",
+                 &PyAsyncioWaitSet::close,
+                 "Stop waiting and cancel any pending waits.")
+            .def_property_readonly(
+                    "closed",
+                    &PyAsyncioWaitSet::closed,
+                    "Whether this AsyncioWaitSet has been closed.")
+            .def(
+                    "__enter__",
+                    [](py::object self) { return self; },
+                    "Enter a context for this AsyncioWaitSet, to be closed on "
+                    "context exit.")
+            .def(
+                    "__exit__",
+                    [](PyAsyncioWaitSet& ws,
+                       py::object,
+                       py::object,
+                       py::object) { ws.close(); },
+                    "Exit the context for this AsyncioWaitSet, closing it.");
+}
+
+template<>
+void process_inits<PyAsyncioWaitSet>(py::module& m, ClassInitList& l)
+{
+    l.push_back([m]() mutable {
+        return init_class<
+            PyAsyncioWaitSet,
+            std::unique_ptr<PyAsyncioWaitSet, no_gil_delete<PyAsyncioWaitSet>>>(
+                m,
+                "AsyncioWaitSet");
+    });
+}
+
+}  // namespace pyrti
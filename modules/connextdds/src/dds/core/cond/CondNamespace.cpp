@@ -11,6 +11,7 @@
 
 #include "PyConnext.hpp"
 #include <dds/dds.hpp>
+#include "PyAsyncioWaitSet.hpp"
 
 using namespace dds::core::cond;
 
@@ -20,4 +21,5 @@ void init_namespace_dds_core_cond(py::module& m, pyrti::ClassInitList& l, pyrti:
     pyrti::process_inits<GuardCondition>(m, l);
     pyrti::process_inits<StatusCondition>(m, l);
     pyrti::process_inits<WaitSet>(m, l);
+    pyrti::process_inits<pyrti::PyAsyncioWaitSet>(m, l);
 }
\ No newline at end of file
@@ -20,21 +20,6 @@
 using namespace dds::core::cond;
 
 namespace pyrti {
-class PyTriggeredConditions {
-public:
-    PyTriggeredConditions(const std::vector<Condition>&& v) : _v(v)
-    {
-    }
-
-    std::vector<Condition>& v()
-    {
-        return this->_v;
-    }
-
-private:
-    std::vector<Condition> _v;
-};
-
 class PyTriggeredConditionsIterator {
 public:
     PyTriggeredConditionsIterator(PyTriggeredConditions& tc, bool reversed)
@@ -10,12 +10,15 @@
  */
 
 #include "PyConnext.hpp"
+#include <cstring>
+#include <unordered_map>
 #include "PySeq.hpp"
 #include <pybind11/numpy.h>
 #include <dds/core/xtypes/DynamicData.hpp>
 #include <dds/core/QosProvider.hpp>
 #include "PyInitType.hpp"
 #include "PyDynamicTypeMap.hpp"
+#include "PyDynamicDataPath.hpp"
 #include "PyInitOpaqueTypeContainers.hpp"
 
 using namespace dds::core::xtypes;
@@ -34,6 +37,12 @@ struct DynamicDataNestedIndex {
     std::string string_index;
 
     ~DynamicDataNestedIndex()
+    {
+        return_loans();
+    }
+
+    // Loans must be returned innermost first
+    void return_loans()
     {
         while (!loan_list.empty())
             loan_list.pop_back();
@@ -305,6 +314,19 @@ UnionMember get_union_member(const UnionType& ut, const int32_t discriminator) {
 }
 
 
+static
+const Member& get_struct_member(const StructType& st, const std::string& key) {
+    return st.member(key);
+}
+
+
+static
+const Member& get_struct_member(const StructType& st, const uint32_t index) {
+    // DynamicData member indexes are 1-based, type member indexes are not
+    return st.member(index - 1);
+}
+
+
 template<typename T>
 static
 EnumMember get_enum_member_base(const DynamicData& dd, const T& key, int32_t ordinal) {
@@ -312,7 +334,8 @@ EnumMember get_enum_member_base(const DynamicData& dd, const T& key, int32_t ord
     case TypeKind::STRUCTURE_TYPE: {
         auto& struct_type = static_cast<const StructType&>(dd.type());
         return resolve_enum_member_in_type(
-            static_cast<const EnumType&>(struct_type.member(key).type()),
+            static_cast<const EnumType&>(
+                get_struct_member(struct_type, key).type()),
             ordinal);
     }
     case TypeKind::ARRAY_TYPE:
@@ -753,6 +776,132 @@ static bool set_buffer_collection_member(
 }
 
 
+template<typename T, typename F>
+static size_t get_buffer_values(
+    DynamicData& dd,
+    const char* field_name,
+    const int field_index,
+    const py::buffer_info& info,
+    F func)
+{
+    DDS_DynamicData* native_ptr = &dd.native();
+    if (!validate_buffer_type<T>(info)) {
+        throw py::type_error("Only contiguous buffers are allowed");
+    }
+    T* ptr = static_cast<T*>(info.ptr);
+    DDS_UnsignedLong len = info.shape[0];
+    DDS_ReturnCode_t rc;
+    {
+        // The copy goes straight into the destination buffer, so large
+        // collections do not need to hold the GIL
+        py::gil_scoped_release release;
+        rc = func(native_ptr, ptr, &len, field_name, field_index);
+    }
+    rti::core::check_return_code(rc, "Failed to get buffer collection member");
+    return len;
+}
+
+
+template<typename T, typename F>
+static size_t get_buffer_values(
+    DynamicData& dd,
+    const std::string& key,
+    const py::buffer_info& info,
+    F func)
+{
+    return get_buffer_values<T>(
+        dd,
+        key.c_str(),
+        DDS_DYNAMIC_DATA_MEMBER_ID_UNSPECIFIED,
+        info,
+        func);
+}
+
+
+template<typename T, typename F>
+static size_t get_buffer_values(
+    DynamicData& dd,
+    const int& key,
+    const py::buffer_info& info,
+    F func)
+{
+    return get_buffer_values<T>(
+        dd,
+        nullptr,
+        key,
+        info,
+        func);
+}
+
+
+/*
+    Copies a primitive collection member into a writable buffer. When out is
+    None, a NumPy array of the right size and dtype is allocated and returned;
+    otherwise the number of elements copied into out is returned.
+ */
+template<typename V, typename K, typename F>
+static py::object get_buffer_collection_values(
+        DynamicData& dd,
+        const K& key,
+        py::object& out,
+        F func)
+{
+    auto mi = get_member_info(dd, key);
+    bool allocate = out.is_none();
+    if (allocate) {
+        out = py::array_t<V>(mi.element_count());
+    } else if (!py::isinstance<py::buffer>(out)) {
+        throw py::type_error("Output object must support the buffer protocol");
+    }
+    auto info = py::cast<py::buffer>(out).request(true);
+    if (info.ndim == 1 && info.shape[0] < static_cast<ssize_t>(mi.element_count())) {
+        throw py::value_error(
+                "Output buffer is too small: "
+                + std::to_string(mi.element_count()) + " elements required");
+    }
+    auto len = get_buffer_values<V>(dd, key, info, func);
+    if (allocate) return out;
+    return py::int_(len);
+}
+
+
+template<typename T>
+static py::object get_buffer_collection_member(
+        DynamicData& dd,
+        TypeKind::inner_enum kind,
+        const T& key,
+        py::object& out)
+{
+    kind = resolve_member_type_kind(dd, kind, key);
+    switch (kind) {
+    case TypeKind::UINT_8_TYPE:
+        return get_buffer_collection_values<uint8_t>(dd, key, out, DDS_DynamicData_get_octet_array);
+    case TypeKind::INT_16_TYPE:
+        return get_buffer_collection_values<int16_t>(dd, key, out, DDS_DynamicData_get_short_array);
+    case TypeKind::UINT_16_TYPE:
+        return get_buffer_collection_values<uint16_t>(dd, key, out, DDS_DynamicData_get_ushort_array);
+    case TypeKind::INT_32_TYPE:
+        return get_buffer_collection_values<int32_t>(dd, key, out, DDS_DynamicData_get_long_array);
+    case TypeKind::UINT_32_TYPE:
+        return get_buffer_collection_values<uint32_t>(dd, key, out, DDS_DynamicData_get_ulong_array);
+    case TypeKind::INT_64_TYPE:
+        return get_buffer_collection_values<rti::core::int64>(dd, key, out, DDS_DynamicData_get_longlong_array);
+    case TypeKind::UINT_64_TYPE:
+        return get_buffer_collection_values<rti::core::uint64>(dd, key, out, DDS_DynamicData_get_ulonglong_array);
+    case TypeKind::FLOAT_32_TYPE:
+        return get_buffer_collection_values<float>(dd, key, out, DDS_DynamicData_get_float_array);
+    case TypeKind::FLOAT_64_TYPE:
+        return get_buffer_collection_values<double>(dd, key, out, DDS_DynamicData_get_double_array);
+    case TypeKind::CHAR_8_TYPE:
+        return get_buffer_collection_values<char>(dd, key, out, DDS_DynamicData_get_char_array);
+    default:
+        throw py::type_error(
+                "Buffer access is only supported for collections of numeric "
+                "primitives.");
+    }
+}
+
+
 template<typename T>
 static void set_collection_member(
         DynamicData& dd,
@@ -895,6 +1044,208 @@ static void set_collection_member(
 }
 
 
+/*
+    How to convert values of one DynamicType to and from Python objects,
+    built once per type: member ids, resolved kinds, interned keys and the
+    plans of nested types, so that conversion doesn't look up member info or
+    copy nested members. Plans are only built and used with the GIL held.
+ */
+struct DynamicDataDictPlan {
+    struct Member {
+        py::object key;
+        std::string name;
+        // 1-based DynamicData member index (structs only; union members
+        // are accessed by name)
+        uint32_t id;
+        bool optional;
+        std::shared_ptr<DynamicDataDictPlan> plan;
+    };
+
+    TypeKind::inner_enum kind;
+    std::vector<Member> members;
+    std::shared_ptr<DynamicDataDictPlan> element;
+    // Dict keys are usually the interned member names, so they are first
+    // looked up by identity and only then by value
+    std::unordered_map<PyObject*, size_t> key_index;
+    std::unordered_map<std::string, size_t> name_index;
+
+    // Returns nullptr if the key isn't the name of a member
+    const Member* find_member(py::handle key, std::string& name) const
+    {
+        auto it = this->key_index.find(key.ptr());
+        if (it != this->key_index.end()) {
+            return &this->members[it->second];
+        }
+        name = py::cast<std::string>(key);
+        auto name_it = this->name_index.find(name);
+        if (name_it == this->name_index.end()) {
+            return nullptr;
+        }
+        return &this->members[name_it->second];
+    }
+};
+
+
+static py::object intern_key(const std::string& name)
+{
+    return py::reinterpret_steal<py::object>(
+            PyUnicode_InternFromString(name.c_str()));
+}
+
+
+static std::shared_ptr<DynamicDataDictPlan> build_dict_plan(
+        const DynamicType& type)
+{
+    auto& resolved = rti::core::xtypes::resolve_alias(type);
+    auto plan = std::make_shared<DynamicDataDictPlan>();
+    plan->kind = resolved.kind().underlying();
+    switch (plan->kind) {
+    case TypeKind::STRUCTURE_TYPE: {
+        auto& struct_type = static_cast<const StructType&>(resolved);
+        for (uint32_t i = 0; i < struct_type.member_count(); ++i) {
+            auto& member = struct_type.member(i);
+            plan->members.push_back(DynamicDataDictPlan::Member {
+                    intern_key(member.name()),
+                    member.name(),
+                    i + 1,
+                    member.is_optional(),
+                    build_dict_plan(member.type()) });
+        }
+        break;
+    }
+    case TypeKind::UNION_TYPE: {
+        auto& union_type = static_cast<const UnionType&>(resolved);
+        for (uint32_t i = 0; i < union_type.member_count(); ++i) {
+            auto member = union_type.member(i);
+            plan->members.push_back(DynamicDataDictPlan::Member {
+                    intern_key(member.name()),
+                    member.name(),
+                    0,
+                    false,
+                    build_dict_plan(member.type()) });
+        }
+        break;
+    }
+    case TypeKind::ARRAY_TYPE:
+    case TypeKind::SEQUENCE_TYPE:
+        plan->element = build_dict_plan(
+                static_cast<const CollectionType&>(resolved).content_type());
+        break;
+    default:
+        break;
+    }
+    for (size_t i = 0; i < plan->members.size(); ++i) {
+        plan->key_index[plan->members[i].key.ptr()] = i;
+        plan->name_index[plan->members[i].name] = i;
+    }
+    return plan;
+}
+
+
+/*
+    Plans are cached by type name. A plan is reused only if the type
+    compares equal to the copy of the type it was built for; callers that
+    convert many samples keep the plan instead of looking it up each time.
+
+    Types owned by a Python object are also cached by address, so that
+    converting samples of the same type skips the deep comparison. The
+    entry references the owner, so the address can't be reused by another
+    type while it's cached.
+ */
+struct DynamicDataDictPlanEntry {
+    DynamicType type;
+    std::shared_ptr<DynamicDataDictPlan> plan;
+};
+
+
+struct DynamicDataDictPlanAddressEntry {
+    py::object owner;
+    std::shared_ptr<DynamicDataDictPlan> plan;
+};
+
+
+// The Python object that owns the type at this address, if any
+static py::object dynamic_type_owner(const DynamicType& type)
+{
+    auto& instances = py::detail::get_internals().registered_instances;
+    auto range = instances.equal_range(&type);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->owned) {
+            return py::reinterpret_borrow<py::object>(
+                    reinterpret_cast<PyObject*>(it->second));
+        }
+    }
+    return py::object();
+}
+
+
+// Struct and union types can only change in place by adding members
+static bool dict_plan_is_current(
+        const DynamicType& type,
+        const DynamicDataDictPlan& plan)
+{
+    auto& resolved = rti::core::xtypes::resolve_alias(type);
+    switch (plan.kind) {
+    case TypeKind::STRUCTURE_TYPE:
+        return static_cast<const StructType&>(resolved).member_count()
+                == plan.members.size();
+    case TypeKind::UNION_TYPE:
+        return static_cast<const UnionType&>(resolved).member_count()
+                == plan.members.size();
+    default:
+        return true;
+    }
+}
+
+
+static std::shared_ptr<DynamicDataDictPlan> get_dict_plan(
+        const DynamicType& type)
+{
+    static const size_t MAX_ADDRESS_ENTRIES = 64;
+
+    // Never destroyed: entries hold Python objects that can't be released
+    // after the interpreter is finalized
+    static auto cache =
+            new std::unordered_map<std::string, DynamicDataDictPlanEntry>();
+    static auto address_cache = new std::
+            unordered_map<const DynamicType*, DynamicDataDictPlanAddressEntry>();
+
+    auto address_it = address_cache->find(&type);
+    if (address_it != address_cache->end()) {
+        if (dict_plan_is_current(type, *address_it->second.plan)) {
+            return address_it->second.plan;
+        }
+        address_cache->erase(address_it);
+    }
+
+    std::shared_ptr<DynamicDataDictPlan> plan;
+    auto it = cache->find(type.name());
+    if (it != cache->end()) {
+        if (it->second.type == type) {
+            plan = it->second.plan;
+        } else {
+            cache->erase(it);
+        }
+    }
+    if (!plan) {
+        plan = build_dict_plan(type);
+        cache->emplace(type.name(), DynamicDataDictPlanEntry { type, plan });
+    }
+
+    auto owner = dynamic_type_owner(type);
+    if (owner) {
+        // Bounded so that the references don't keep every type alive
+        if (address_cache->size() >= MAX_ADDRESS_ENTRIES) {
+            address_cache->clear();
+        }
+        address_cache->emplace(
+                &type,
+                DynamicDataDictPlanAddressEntry { owner, plan });
+    }
+    return plan;
+}
+
+
 // Forward declare function to allow use in set_member
 void update_dynamicdata_object(DynamicData& dd, py::dict& dict);
 
@@ -1061,14 +1412,102 @@ static bool test_index(
 }
 
 
-void update_dynamicdata_object(DynamicData& dd, py::dict& dict)
+template<typename T>
+static void set_member_from_plan(
+        DynamicData& dd,
+        const T& key,
+        const DynamicDataDictPlan& plan,
+        py::object& value);
+
+
+static void update_dynamicdata_object(
+        DynamicData& dd,
+        const DynamicDataDictPlan& plan,
+        py::dict& dict)
 {
+    bool is_union = plan.kind == TypeKind::UNION_TYPE;
+    std::string name;
     for (auto kv : dict) {
-        std::string key = py::cast<std::string>(kv.first);
-        auto mi = get_member_info(dd, key);
-        auto obj = py::cast<py::object>(kv.second);
-        set_member(dd, mi.member_kind().underlying(), key, obj);
+        auto member = plan.find_member(kv.first, name);
+        auto obj = py::reinterpret_borrow<py::object>(kv.second);
+        if (member == nullptr) {
+            // Not a direct member, e.g. a nested name such as "a.b"
+            auto mi = get_member_info(dd, name);
+            set_member(dd, mi.member_kind().underlying(), name, obj);
+        } else if (is_union) {
+            set_member_from_plan(dd, member->name, *member->plan, obj);
+        } else {
+            set_member_from_plan(dd, member->id, *member->plan, obj);
+        }
+    }
+}
+
+
+template<typename T>
+static void set_member_from_plan(
+        DynamicData& dd,
+        const T& key,
+        const DynamicDataDictPlan& plan,
+        py::object& value)
+{
+    switch (plan.kind) {
+    case TypeKind::STRUCTURE_TYPE:
+    case TypeKind::UNION_TYPE:
+        if (py::isinstance<py::dict>(value)) {
+            // Populate the member in place; like assigning a new sample,
+            // members missing from the dict are reset
+            auto loan = dd.loan_value(key);
+            loan.get().clear_all_members();
+            auto nested = py::reinterpret_borrow<py::dict>(value);
+            update_dynamicdata_object(loan.get(), plan, nested);
+            return;
+        }
+        break;
+    case TypeKind::ARRAY_TYPE:
+    case TypeKind::SEQUENCE_TYPE:
+        if (!value.is_none() && !py::isinstance<DynamicData>(value)) {
+            set_collection_member(dd, plan.element->kind, key, value);
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    set_member(dd, plan.kind, key, value);
+}
+
+
+static void check_dict_plan_kind(const DynamicDataDictPlan& plan)
+{
+    if (plan.kind != TypeKind::STRUCTURE_TYPE
+        && plan.kind != TypeKind::UNION_TYPE) {
+        throw py::type_error("Only structures and unions can be populated "
+                             "from a dict");
+    }
+}
+
+
+void update_dynamicdata_object(DynamicData& dd, py::dict& dict)
+{
+    auto plan = get_dict_plan(dd.type());
+    check_dict_plan_kind(*plan);
+    update_dynamicdata_object(dd, *plan, dict);
+}
+
+
+// Populates a scratch sample of a writer with the plan cached by the
+// writer, so that writing a dict doesn't look up the plan of its type
+static void update_writer_sample(
+        PyDataWriter<DynamicData>& dw,
+        DynamicData& sample,
+        py::dict& dict)
+{
+    auto& plan = dw.cache().dict_plan();
+    if (!plan) {
+        plan = get_dict_plan(sample.type());
     }
+    check_dict_plan_kind(*plan);
+    update_dynamicdata_object(sample, *plan, dict);
 }
 
 
@@ -1135,189 +1574,1254 @@ static void set_values(DynamicData& dd, const T& key, py::object& values)
 }
 
 
-class PyDynamicDataFieldsIterator {
-public:
-    PyDynamicDataFieldsIterator(DynamicData& dd, bool reversed) : _dd(dd)
-    {
-        if (reversed) {
-            this->_index = dd.member_count();
-            this->_end = 0;
-            this->_step = -1;
-        } else {
-            this->_index = 1;
-            this->_end = dd.member_count() + 1;
-            this->_step = 1;
-        }
+template<typename T>
+static py::object get_values_buffer(
+        DynamicData& dd,
+        const T& key,
+        py::object& out)
+{
+    auto mi = get_member_info(dd, key);
+    auto kind = resolve_member_type_kind(
+            dd,
+            mi.member_kind().underlying(),
+            key);
+    if (kind != TypeKind::ARRAY_TYPE && kind != TypeKind::SEQUENCE_TYPE) {
+        throw py::type_error(
+                "Cannot get collection from non-collection member.");
+    }
+    return get_buffer_collection_member(
+            dd,
+            mi.element_kind().underlying(),
+            key,
+            out);
+}
+
+
+static py::object get_path_value(
+        DynamicData& dd,
+        const PyDynamicDataPath& path,
+        bool dict_access)
+{
+    DynamicDataNestedIndex id;
+    DynamicData& parent = path.resolve_parent(dd, id.loan_list);
+    auto& step = path.last();
+    if (step.by_name) {
+        return get_member(parent, step.kind, step.name, dict_access);
     }
+    return get_member(parent, step.kind, step.index, dict_access);
+}
 
-    std::string next()
-    {
-        if (this->_index == this->_end)
-            throw py::stop_iteration();
-        auto mi = get_member_info(this->_dd, (uint32_t)this->_index);
-        auto retval = mi.member_name();
-        this->_index += this->_step;
-        return retval;
+
+static py::object get_path_values(
+        DynamicData& dd,
+        const PyDynamicDataPath& path)
+{
+    auto& step = path.last();
+    if (step.kind != TypeKind::ARRAY_TYPE
+        && step.kind != TypeKind::SEQUENCE_TYPE) {
+        throw py::type_error(
+                "Cannot get collection from non-collection member.");
     }
+    DynamicDataNestedIndex id;
+    DynamicData& parent = path.resolve_parent(dd, id.loan_list);
+    if (step.by_name) {
+        return get_collection_member(parent, step.element_kind, step.name);
+    }
+    return get_collection_member(parent, step.element_kind, step.index);
+}
 
-private:
-    DynamicData& _dd;
-    int32_t _index;
-    int32_t _step;
-    int32_t _end;
-};
+
+static void set_path_value(
+        DynamicData& dd,
+        const PyDynamicDataPath& path,
+        py::object& value)
+{
+    DynamicDataNestedIndex id;
+    DynamicData& parent = path.resolve_parent(dd, id.loan_list);
+    auto& step = path.last();
+    if (step.by_name) {
+        set_member(parent, step.kind, step.name, value);
+    } else {
+        set_member(parent, step.kind, step.index, value);
+    }
+}
+
+
+static void set_path_values(
+        DynamicData& dd,
+        const PyDynamicDataPath& path,
+        py::object& values)
+{
+    auto& step = path.last();
+    if (step.kind != TypeKind::ARRAY_TYPE
+        && step.kind != TypeKind::SEQUENCE_TYPE) {
+        throw py::type_error(
+                "Cannot set multiple values to non-collection member.");
+    }
+    DynamicDataNestedIndex id;
+    DynamicData& parent = path.resolve_parent(dd, id.loan_list);
+    if (step.by_name) {
+        set_collection_member(parent, step.element_kind, step.name, values);
+    } else {
+        set_collection_member(parent, step.element_kind, step.index, values);
+    }
+}
+
+
+static py::object get_path_values_buffer(
+        DynamicData& dd,
+        const PyDynamicDataPath& path,
+        py::object& out)
+{
+    auto& step = path.last();
+    if (step.kind != TypeKind::ARRAY_TYPE
+        && step.kind != TypeKind::SEQUENCE_TYPE) {
+        throw py::type_error(
+                "Cannot get collection from non-collection member.");
+    }
+    DynamicDataNestedIndex id;
+    DynamicData& parent = path.resolve_parent(dd, id.loan_list);
+    if (step.by_name) {
+        return get_buffer_collection_member(
+                parent,
+                step.element_kind,
+                step.name,
+                out);
+    }
+    return get_buffer_collection_member(
+            parent,
+            step.element_kind,
+            step.index,
+            out);
+}
+
+
+class PyDynamicDataFieldsIterator {
+public:
+    PyDynamicDataFieldsIterator(DynamicData& dd, bool reversed) : _dd(dd)
+    {
+        if (reversed) {
+            this->_index = dd.member_count();
+            this->_end = 0;
+            this->_step = -1;
+        } else {
+            this->_index = 1;
+            this->_end = dd.member_count() + 1;
+            this->_step = 1;
+        }
+    }
+
+    std::string next()
+    {
+        if (this->_index == this->_end)
+            throw py::stop_iteration();
+        auto mi = get_member_info(this->_dd, (uint32_t)this->_index);
+        auto retval = mi.member_name();
+        this->_index += this->_step;
+        return retval;
+    }
+
+private:
+    DynamicData& _dd;
+    int32_t _index;
+    int32_t _step;
+    int32_t _end;
+};
+
+
+class PyDynamicDataFieldsView {
+public:
+    PyDynamicDataFieldsView(DynamicData& dd) : _dd(dd)
+    {
+    }
+
+    bool contains(const std::string& field_name)
+    {
+        return _dd.member_exists_in_type(field_name);
+    }
+
+    PyDynamicDataFieldsIterator iter()
+    {
+        return PyDynamicDataFieldsIterator(this->_dd, false);
+    }
+
+    PyDynamicDataFieldsIterator reversed()
+    {
+        return PyDynamicDataFieldsIterator(this->_dd, true);
+    }
+
+    size_t len()
+    {
+        return this->_dd.member_count();
+    }
+
+private:
+    DynamicData& _dd;
+};
+
+
+class PyDynamicDataIndexIterator {
+public:
+    PyDynamicDataIndexIterator(DynamicData& dd, bool reversed) : _dd(dd)
+    {
+        if (reversed) {
+            this->_index = dd.member_count();
+            this->_end = 0;
+            this->_step = -1;
+        } else {
+            this->_index = 1;
+            this->_end = dd.member_count() + 1;
+            this->_step = 1;
+        }
+        this->_elem_kind = static_cast<const CollectionType&>(dd.type())
+                                   .content_type()
+                                   .kind()
+                                   .underlying();
+    }
+
+    py::object next()
+    {
+        if (this->_index == this->_end)
+            throw py::stop_iteration();
+        auto retval = get_member(this->_dd, this->_elem_kind, this->_index);
+        this->_index += this->_step;
+        return retval;
+    }
+
+private:
+    DynamicData& _dd;
+    TypeKind::inner_enum _elem_kind;
+    int32_t _index;
+    int32_t _step;
+    int32_t _end;
+};
+
+
+class PyDynamicDataItemsIterator {
+public:
+    PyDynamicDataItemsIterator(DynamicData& dd, bool reversed) : _dd(dd)
+    {
+        if (reversed) {
+            this->_index = dd.member_count();
+            this->_end = 0;
+            this->_step = -1;
+        } else {
+            this->_index = 1;
+            this->_end = dd.member_count() + 1;
+            this->_step = 1;
+        }
+    }
+
+    std::pair<std::string, py::object> next()
+    {
+        auto retval = std::pair<std::string, py::object>();
+
+        if (this->_index == this->_end)
+            throw py::stop_iteration();
+
+        auto mi = get_member_info(this->_dd, (uint32_t)this->_index);
+
+        retval.first = mi.member_name();
+        if (this->_dd.member_exists(this->_index)) {
+           retval.second = get_member(
+                            this->_dd,
+                            mi.member_kind().underlying(),
+                            mi.member_name());
+        }
+        else {
+            retval.second = py::none();
+        }
+        this->_index += this->_step;
+        return retval;
+    }
+
+private:
+    DynamicData& _dd;
+    int32_t _index;
+    int32_t _step;
+    int32_t _end;
+};
+
+
+class PyDynamicDataItemsView {
+public:
+    PyDynamicDataItemsView(DynamicData& dd) : _dd(dd)
+    {
+    }
+
+    bool contains(const std::pair<std::string, py::object>& item)
+    {
+        return _dd.member_exists_in_type(item.first)
+                && test_index(
+                        this->_dd,
+                        get_member_info(this->_dd, item.first)
+                                .member_kind()
+                                .underlying(),
+                        this->_dd.member_index(item.first),
+                        item.second);
+    }
+
+    PyDynamicDataItemsIterator iter()
+    {
+        return PyDynamicDataItemsIterator(this->_dd, false);
+    }
+
+    PyDynamicDataItemsIterator reversed()
+    {
+        return PyDynamicDataItemsIterator(this->_dd, true);
+    }
+
+    size_t len()
+    {
+        return this->_dd.member_count();
+    }
+
+private:
+    DynamicData& _dd;
+};
+
+
+/*
+    A primitive field of a DynamicData type mapped to a one-dimensional
+    buffer with one element per sample, used to move data between
+    samples and NumPy arrays without a Python call per field.
+ */
+struct DynamicDataColumn {
+    PyDynamicDataPath path;
+    TypeKind::inner_enum kind;
+    char* data;
+    size_t itemsize;
+    ssize_t stride;
+};
+
+
+template<typename T>
+struct GetDynamicDataColumnValue {
+    static void apply(
+            DynamicData& parent,
+            const PyDynamicDataPath::Step& step,
+            char* element)
+    {
+        T value = step.by_name ? parent.value<T>(step.name)
+                               : parent.value<T>(step.index);
+        std::memcpy(element, &value, sizeof(T));
+    }
+};
+
+
+template<typename T>
+struct SetDynamicDataColumnValue {
+    static void apply(
+            DynamicData& parent,
+            const PyDynamicDataPath::Step& step,
+            char* element)
+    {
+        T value;
+        std::memcpy(&value, element, sizeof(T));
+        if (step.by_name) {
+            parent.value<T>(step.name, value);
+        } else {
+            parent.value<T>(step.index, value);
+        }
+    }
+};
+
+
+template<template<typename> class Op>
+static void apply_dynamic_data_column(
+        DynamicData& dd,
+        const DynamicDataColumn& column,
+        size_t i)
+{
+    DynamicDataNestedIndex id;
+    DynamicData& parent = column.path.resolve_parent(dd, id.loan_list);
+    auto& step = column.path.last();
+    char* element = column.data + static_cast<ssize_t>(i) * column.stride;
+    switch (column.kind) {
+    case TypeKind::BOOLEAN_TYPE:
+        Op<bool>::apply(parent, step, element);
+        break;
+    case TypeKind::UINT_8_TYPE:
+        Op<uint8_t>::apply(parent, step, element);
+        break;
+    case TypeKind::INT_16_TYPE:
+        Op<int16_t>::apply(parent, step, element);
+        break;
+    case TypeKind::UINT_16_TYPE:
+        Op<uint16_t>::apply(parent, step, element);
+        break;
+    case TypeKind::INT_32_TYPE:
+    case TypeKind::ENUMERATION_TYPE:
+        Op<int32_t>::apply(parent, step, element);
+        break;
+    case TypeKind::UINT_32_TYPE:
+        Op<uint32_t>::apply(parent, step, element);
+        break;
+    case TypeKind::INT_64_TYPE:
+        Op<rti::core::int64>::apply(parent, step, element);
+        break;
+    case TypeKind::UINT_64_TYPE:
+        Op<rti::core::uint64>::apply(parent, step, element);
+        break;
+    case TypeKind::FLOAT_32_TYPE:
+        Op<float>::apply(parent, step, element);
+        break;
+    case TypeKind::FLOAT_64_TYPE:
+        Op<double>::apply(parent, step, element);
+        break;
+    case TypeKind::CHAR_8_TYPE:
+        Op<char>::apply(parent, step, element);
+        break;
+    default:
+        break;
+    }
+}
+
+
+static py::dtype dynamic_data_column_dtype(TypeKind::inner_enum kind)
+{
+    switch (kind) {
+    case TypeKind::BOOLEAN_TYPE:
+        return py::dtype::of<bool>();
+    case TypeKind::UINT_8_TYPE:
+        return py::dtype::of<uint8_t>();
+    case TypeKind::INT_16_TYPE:
+        return py::dtype::of<int16_t>();
+    case TypeKind::UINT_16_TYPE:
+        return py::dtype::of<uint16_t>();
+    case TypeKind::INT_32_TYPE:
+    case TypeKind::ENUMERATION_TYPE:
+        return py::dtype::of<int32_t>();
+    case TypeKind::UINT_32_TYPE:
+        return py::dtype::of<uint32_t>();
+    case TypeKind::INT_64_TYPE:
+        return py::dtype::of<rti::core::int64>();
+    case TypeKind::UINT_64_TYPE:
+        return py::dtype::of<rti::core::uint64>();
+    case TypeKind::FLOAT_32_TYPE:
+        return py::dtype::of<float>();
+    case TypeKind::FLOAT_64_TYPE:
+        return py::dtype::of<double>();
+    case TypeKind::CHAR_8_TYPE:
+        return py::dtype::of<char>();
+    default:
+        throw py::type_error(
+                "Only numeric, boolean, char and enum fields can be "
+                "mapped to columns.");
+    }
+}
+
+
+static rti::core::int64 time_to_nanosecs(const dds::core::Time& t)
+{
+    return static_cast<rti::core::int64>(t.sec()) * 1000000000LL
+            + t.nanosec();
+}
+
+
+static dds::core::Time time_from_nanosecs(rti::core::int64 nanosecs)
+{
+    return dds::core::Time(
+            static_cast<int32_t>(nanosecs / 1000000000LL),
+            static_cast<uint32_t>(nanosecs % 1000000000LL));
+}
+
+
+static py::object dynamic_data_to_dict(
+        DynamicData& dd,
+        const DynamicDataDictPlan& plan);
+
+
+template<typename V, typename K>
+static py::list collection_to_list(DynamicData& parent, const K& key)
+{
+    std::vector<V> values = parent.get_values<V>(key);
+    py::list retval(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        retval[i] = py::cast(values[i]);
+    }
+    return retval;
+}
+
+
+template<typename K>
+static py::object plan_member_value(
+        DynamicData& parent,
+        const K& key,
+        const DynamicDataDictPlan& plan)
+{
+    switch (plan.kind) {
+    case TypeKind::BOOLEAN_TYPE:
+        return py::bool_(parent.value<bool>(key));
+    case TypeKind::UINT_8_TYPE:
+        return py::int_(parent.value<uint8_t>(key));
+    case TypeKind::INT_16_TYPE:
+        return py::int_(parent.value<int16_t>(key));
+    case TypeKind::UINT_16_TYPE:
+        return py::int_(parent.value<uint16_t>(key));
+    case TypeKind::INT_32_TYPE:
+    case TypeKind::ENUMERATION_TYPE:
+        return py::int_(parent.value<int32_t>(key));
+    case TypeKind::UINT_32_TYPE:
+        return py::int_(parent.value<uint32_t>(key));
+    case TypeKind::INT_64_TYPE:
+        return py::int_(parent.value<rti::core::int64>(key));
+    case TypeKind::UINT_64_TYPE:
+        return py::int_(parent.value<rti::core::uint64>(key));
+    case TypeKind::FLOAT_32_TYPE:
+        return py::float_(parent.value<float>(key));
+    case TypeKind::FLOAT_64_TYPE:
+        return py::float_(parent.value<double>(key));
+    case TypeKind::FLOAT_128_TYPE:
+        return py::cast(parent.value<rti::core::LongDouble>(key));
+    case TypeKind::CHAR_8_TYPE:
+        return py::cast(parent.value<char>(key));
+#if rti_connext_version_gte(6, 0, 0, 0)
+    case TypeKind::CHAR_16_TYPE:
+        return py::cast(static_cast<wchar_t>(parent.value<DDS_Wchar>(key)));
+#endif
+    case TypeKind::STRING_TYPE:
+        return py::str(parent.value<std::string>(key));
+    case TypeKind::WSTRING_TYPE: {
+        std::wstring s;
+        for (auto c : parent.get_values<DDS_Wchar>(key)) {
+            s.push_back(static_cast<wchar_t>(c));
+        }
+        return py::cast(s);
+    }
+    case TypeKind::ARRAY_TYPE:
+    case TypeKind::SEQUENCE_TYPE:
+        // Bulk copy collections of primitives
+        switch (plan.element->kind) {
+        case TypeKind::BOOLEAN_TYPE: {
+            py::list retval;
+            for (auto value : parent.get_values<uint8_t>(key)) {
+                retval.append(py::bool_(value != 0));
+            }
+            return retval;
+        }
+        case TypeKind::UINT_8_TYPE:
+            return collection_to_list<uint8_t>(parent, key);
+        case TypeKind::INT_16_TYPE:
+            return collection_to_list<int16_t>(parent, key);
+        case TypeKind::UINT_16_TYPE:
+            return collection_to_list<uint16_t>(parent, key);
+        case TypeKind::INT_32_TYPE:
+        case TypeKind::ENUMERATION_TYPE:
+            return collection_to_list<int32_t>(parent, key);
+        case TypeKind::UINT_32_TYPE:
+            return collection_to_list<uint32_t>(parent, key);
+        case TypeKind::INT_64_TYPE:
+            return collection_to_list<rti::core::int64>(parent, key);
+        case TypeKind::UINT_64_TYPE:
+            return collection_to_list<rti::core::uint64>(parent, key);
+        case TypeKind::FLOAT_32_TYPE:
+            return collection_to_list<float>(parent, key);
+        case TypeKind::FLOAT_64_TYPE:
+            return collection_to_list<double>(parent, key);
+        case TypeKind::CHAR_8_TYPE:
+            return collection_to_list<char>(parent, key);
+        default: {
+            auto loan = parent.loan_value(key);
+            auto& collection = loan.get();
+            uint32_t count = collection.member_count();
+            py::list retval(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                retval[i] = plan_member_value(collection, i + 1, *plan.element);
+            }
+            return retval;
+        }
+        }
+    case TypeKind::STRUCTURE_TYPE:
+    case TypeKind::UNION_TYPE: {
+        auto loan = parent.loan_value(key);
+        return dynamic_data_to_dict(loan.get(), plan);
+    }
+    default:
+        return py::cast(parent.value<DynamicData>(key));
+    }
+}
+
+
+static py::object dynamic_data_to_dict(
+        DynamicData& dd,
+        const DynamicDataDictPlan& plan)
+{
+    py::dict retval;
+    if (plan.kind == TypeKind::UNION_TYPE) {
+        // Only the selected member, if any
+        auto& union_type = static_cast<const UnionType&>(
+                rti::core::xtypes::resolve_alias(dd.type()));
+        auto index = union_type.find_member_by_label(dd.discriminator_value());
+        if (index != UnionType::INVALID_INDEX) {
+            auto& member = plan.members[index];
+            retval[member.key] =
+                    plan_member_value(dd, member.name, *member.plan);
+        }
+        return retval;
+    }
+
+    for (auto& member : plan.members) {
+        if (member.optional && !dd.member_exists(member.id)) {
+            retval[member.key] = py::none();
+        } else {
+            retval[member.key] =
+                    plan_member_value(dd, member.id, *member.plan);
+        }
+    }
+    return retval;
+}
+
+
+static py::object dynamic_data_to_dict(DynamicData& dd)
+{
+    auto plan = get_dict_plan(dd.type());
+    if (plan->kind != TypeKind::STRUCTURE_TYPE
+        && plan->kind != TypeKind::UNION_TYPE) {
+        throw py::type_error("Only structures and unions can be converted "
+                             "to a dict");
+    }
+    return dynamic_data_to_dict(dd, *plan);
+}
+
+
+static py::list loaned_samples_to_dicts(
+        dds::sub::LoanedSamples<DynamicData>& samples)
+{
+    size_t count = samples.length();
+    py::list retval(count);
+    std::shared_ptr<DynamicDataDictPlan> plan;
+    const void* plan_type = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        auto sample = samples[i];
+        if (!sample.info().valid()) {
+            retval[i] = py::none();
+            continue;
+        }
+        auto& dd = const_cast<DynamicData&>(sample.data());
+        if (plan_type != &dd.type().native()) {
+            plan = get_dict_plan(dd.type());
+            plan_type = &dd.type().native();
+        }
+        retval[i] = dynamic_data_to_dict(dd, *plan);
+    }
+    return retval;
+}
+
+
+/*
+    Read-only view of (a member of) a DynamicData sample in a LoanedSamples,
+    used instead of copying the sample or its nested members. A view keeps
+    the LoanedSamples object alive but not the loan: once the loan is
+    returned, using the view raises AlreadyClosedError.
+
+    Views of nested members hold the path to the member rather than a loan
+    of it, since a DynamicData can only have one member loaned at a time.
+    The paths compiled for string keys are cached by their full path and
+    shared with the nested views and the other views of the same samples.
+ */
+class PyDynamicDataView {
+public:
+    typedef std::unordered_map<std::string, std::shared_ptr<PyDynamicDataPath>>
+            PathCache;
+
+    static const size_t MAX_CACHED_PATHS = 256;
+
+    PyDynamicDataView(
+            py::object owner,
+            const dds::sub::LoanedSamples<DynamicData>& samples,
+            size_t index,
+            std::shared_ptr<PyDynamicDataPath> path = nullptr,
+            std::shared_ptr<PathCache> paths = nullptr)
+            : _owner(owner),
+              _samples(&samples),
+              _index(index),
+              _path(path),
+              _paths(paths ? paths : std::make_shared<PathCache>())
+    {
+    }
+
+    bool valid() const
+    {
+        return this->_index < this->_samples->length();
+    }
+
+    // Loans the members on the path to the viewed member
+    DynamicData& resolve(
+            std::list<rti::core::xtypes::LoanedDynamicData>& loans) const
+    {
+        DynamicData& root = this->root();
+        if (!this->_path) return root;
+        DynamicData& parent = this->_path->resolve_parent(root, loans);
+        auto& step = this->_path->last();
+        if (step.by_name) {
+            loans.push_back(parent.loan_value(step.name));
+        } else {
+            loans.push_back(parent.loan_value(step.index));
+        }
+        return loans.back().get();
+    }
+
+    py::object get(const std::string& key) const
+    {
+        std::string path = key;
+        if (this->_path && !key.empty()) {
+            path = this->_path->path() + (key[0] == '[' ? "" : ".") + key;
+        }
+        auto compiled = this->compile(path);
+        return this->get(*compiled, compiled);
+    }
+
+    // The path is relative to this view, like a string key
+    py::object get(const PyDynamicDataPath& path) const
+    {
+        if (this->_path) {
+            return this->get(path.path());
+        }
+        return this->get(path, nullptr);
+    }
+
+    py::object get(size_t index) const
+    {
+        DynamicDataNestedIndex loans;
+        DynamicData& dd = this->resolve(loans.loan_list);
+        if (index >= dd.member_count()) {
+            throw py::index_error("Invalid index for this view.");
+        }
+        auto& type = rti::core::xtypes::resolve_alias(dd.type());
+        switch (type.kind().underlying()) {
+        case TypeKind::STRUCTURE_TYPE: {
+            auto& struct_type = static_cast<const StructType&>(type);
+            std::string name = struct_type.member(index).name();
+            loans.return_loans();
+            return this->get(name);
+        }
+        case TypeKind::ARRAY_TYPE:
+        case TypeKind::SEQUENCE_TYPE:
+            loans.return_loans();
+            return this->get("[" + std::to_string(index) + "]");
+        default:
+            throw py::type_error(
+                    "Index access is only supported for structures, arrays "
+                    "and sequences.");
+        }
+    }
+
+    size_t size() const
+    {
+        DynamicDataNestedIndex loans;
+        return this->resolve(loans.loan_list).member_count();
+    }
+
+    std::string path() const
+    {
+        return this->_path ? this->_path->path() : std::string();
+    }
+
+private:
+    std::shared_ptr<PyDynamicDataPath> compile(const std::string& path) const
+    {
+        auto it = this->_paths->find(path);
+        if (it != this->_paths->end()) {
+            return it->second;
+        }
+        auto compiled = std::make_shared<PyDynamicDataPath>(
+                PyDynamicDataPath::compile(this->root().type(), path));
+        // Element paths of long sequences are not worth keeping forever
+        if (this->_paths->size() >= MAX_CACHED_PATHS) {
+            this->_paths->clear();
+        }
+        this->_paths->emplace(path, compiled);
+        return compiled;
+    }
+
+    // path is relative to the sample; shared, if not null, is a copy of it
+    py::object get(
+            const PyDynamicDataPath& path,
+            std::shared_ptr<PyDynamicDataPath> shared) const
+    {
+        auto& step = path.last();
+        bool nested = step.kind == TypeKind::STRUCTURE_TYPE
+                || step.kind == TypeKind::UNION_TYPE;
+        if (step.kind == TypeKind::ARRAY_TYPE
+            || step.kind == TypeKind::SEQUENCE_TYPE) {
+            nested = !(step.element_kind & TypeKind::PRIMITIVE_TYPE)
+                    && step.element_kind != TypeKind::ENUMERATION_TYPE
+                    && step.element_kind != TypeKind::STRING_TYPE
+                    && step.element_kind != TypeKind::WSTRING_TYPE;
+        }
+        if (nested) {
+            this->root();
+            return py::cast(PyDynamicDataView(
+                    this->_owner,
+                    *this->_samples,
+                    this->_index,
+                    shared ? shared
+                           : std::make_shared<PyDynamicDataPath>(path),
+                    this->_paths));
+        }
+        return get_path_value(this->root(), path, !step.name.empty());
+    }
+
+    DynamicData& root() const
+    {
+        if (!this->valid()) {
+            throw dds::core::AlreadyClosedError(
+                    "The loan of the sample this view refers to has been "
+                    "returned");
+        }
+        auto sample = (*this->_samples)[this->_index];
+        return const_cast<DynamicData&>(sample.data());
+    }
+
+    py::object _owner;
+    const dds::sub::LoanedSamples<DynamicData>* _samples;
+    size_t _index;
+    std::shared_ptr<PyDynamicDataPath> _path;
+    // Only accessed with the GIL held
+    std::shared_ptr<PathCache> _paths;
+};
+
+
+static py::object loaned_samples_view(
+        py::object self,
+        size_t index,
+        std::shared_ptr<PyDynamicDataView::PathCache> paths = nullptr)
+{
+    auto& samples = py::cast<dds::sub::LoanedSamples<DynamicData>&>(self);
+    if (index >= samples.length()) {
+        throw py::index_error();
+    }
+    if (!samples[index].info().valid()) {
+        return py::none();
+    }
+    return py::cast(PyDynamicDataView(self, samples, index, nullptr, paths));
+}
+
+
+static py::list loaned_samples_views(py::object self)
+{
+    auto& samples = py::cast<dds::sub::LoanedSamples<DynamicData>&>(self);
+    py::list retval;
+    // The samples of a reader share their type and can share their paths
+    auto paths = std::make_shared<PyDynamicDataView::PathCache>();
+    for (size_t i = 0; i < samples.length(); ++i) {
+        retval.append(py::make_tuple(
+                loaned_samples_view(self, i, paths),
+                samples[i].info()));
+    }
+    return retval;
+}
+
+
+static DDS_UnsignedLong cdr_serialized_size(const DynamicData& sample)
+{
+    DDS_UnsignedLong length = 0;
+    auto rc = DDS_DynamicData_to_cdr_buffer(
+            const_cast<DDS_DynamicData*>(&sample.native()),
+            NULL,
+            &length);
+    rti::core::check_return_code(rc, "Failed to calculate CDR buffer size");
+    return length;
+}
 
 
-class PyDynamicDataFieldsView {
-public:
-    PyDynamicDataFieldsView(DynamicData& dd) : _dd(dd)
-    {
-    }
+static void cdr_serialize(
+        const DynamicData& sample,
+        char* buffer,
+        DDS_UnsignedLong length)
+{
+    auto rc = DDS_DynamicData_to_cdr_buffer(
+            const_cast<DDS_DynamicData*>(&sample.native()),
+            buffer,
+            &length);
+    rti::core::check_return_code(rc, "Failed to serialize sample to CDR");
+}
 
-    bool contains(const std::string& field_name)
-    {
-        return _dd.member_exists_in_type(field_name);
+
+// Requests a contiguous byte view of any buffer-protocol object
+static py::buffer_info request_cdr_buffer(py::buffer& buffer, bool writable)
+{
+    auto info = buffer.request(writable);
+    if (info.ndim > 1 || (info.ndim == 1 && info.strides[0] != info.itemsize)) {
+        throw py::value_error("CDR buffer must be contiguous");
     }
+    return info;
+}
 
-    PyDynamicDataFieldsIterator iter()
+
+static py::bytes dynamic_data_to_cdr_bytes(const DynamicData& sample)
+{
+    DDS_UnsignedLong length;
     {
-        return PyDynamicDataFieldsIterator(this->_dd, false);
+        py::gil_scoped_release release;
+        length = cdr_serialized_size(sample);
     }
-
-    PyDynamicDataFieldsIterator reversed()
+    // Serialize straight into the new bytes object before it is shared
+    py::bytes retval(nullptr, length);
+    char* buffer = PyBytes_AS_STRING(retval.ptr());
     {
-        return PyDynamicDataFieldsIterator(this->_dd, true);
+        py::gil_scoped_release release;
+        cdr_serialize(sample, buffer, length);
     }
+    return retval;
+}
 
-    size_t len()
-    {
-        return this->_dd.member_count();
+
+static size_t dynamic_data_to_cdr_into(
+        const DynamicData& sample,
+        py::buffer& buffer,
+        size_t offset)
+{
+    auto info = request_cdr_buffer(buffer, true);
+    size_t capacity = static_cast<size_t>(info.size * info.itemsize);
+    py::gil_scoped_release release;
+    DDS_UnsignedLong length = cdr_serialized_size(sample);
+    if (offset > capacity || capacity - offset < length) {
+        throw py::value_error(
+                "buffer too small: " + std::to_string(length)
+                + " bytes needed");
     }
+    cdr_serialize(sample, static_cast<char*>(info.ptr) + offset, length);
+    return length;
+}
 
-private:
-    DynamicData& _dd;
-};
 
+static DynamicData& dynamic_data_from_cdr_buffer(
+        DynamicData& sample,
+        py::buffer& buffer)
+{
+    auto info = request_cdr_buffer(buffer, false);
+    py::gil_scoped_release release;
+    auto rc = DDS_DynamicData_from_cdr_buffer(
+            &sample.native(),
+            static_cast<const char*>(info.ptr),
+            static_cast<DDS_UnsignedLong>(info.size * info.itemsize));
+    rti::core::check_return_code(rc, "Failed to deserialize CDR buffer");
+    return sample;
+}
 
-class PyDynamicDataIndexIterator {
-public:
-    PyDynamicDataIndexIterator(DynamicData& dd, bool reversed) : _dd(dd)
+
+/*
+    Serializes every sample into a single buffer of records, each a 4-byte
+    little-endian length followed by that many bytes of CDR. Samples without
+    valid data are written as empty records so that record i always
+    corresponds to sample i.
+ */
+static py::bytes loaned_samples_to_cdr_bytes(
+        dds::sub::LoanedSamples<DynamicData>& samples)
+{
+    size_t count = samples.length();
+    std::vector<DDS_UnsignedLong> lengths(count, 0);
+    size_t total = 0;
     {
-        if (reversed) {
-            this->_index = dd.member_count();
-            this->_end = 0;
-            this->_step = -1;
-        } else {
-            this->_index = 1;
-            this->_end = dd.member_count() + 1;
-            this->_step = 1;
+        py::gil_scoped_release release;
+        for (size_t i = 0; i < count; ++i) {
+            auto sample = samples[i];
+            if (sample.info().valid()) {
+                lengths[i] = cdr_serialized_size(sample.data());
+            }
+            total += 4 + lengths[i];
         }
-        this->_elem_kind = static_cast<const CollectionType&>(dd.type())
-                                   .content_type()
-                                   .kind()
-                                   .underlying();
     }
 
-    py::object next()
+    py::bytes retval(nullptr, total);
+    char* buffer = PyBytes_AS_STRING(retval.ptr());
     {
-        if (this->_index == this->_end)
-            throw py::stop_iteration();
-        auto retval = get_member(this->_dd, this->_elem_kind, this->_index);
-        this->_index += this->_step;
-        return retval;
+        py::gil_scoped_release release;
+        for (size_t i = 0; i < count; ++i) {
+            DDS_UnsignedLong length = lengths[i];
+            for (int byte = 0; byte < 4; ++byte) {
+                *buffer++ = static_cast<char>((length >> (8 * byte)) & 0xff);
+            }
+            if (length > 0) {
+                cdr_serialize(samples[i].data(), buffer, length);
+                buffer += length;
+            }
+        }
     }
+    return retval;
+}
 
-private:
-    DynamicData& _dd;
-    TypeKind::inner_enum _elem_kind;
-    int32_t _index;
-    int32_t _step;
-    int32_t _end;
-};
 
+static py::dict loaned_samples_to_columns(
+        dds::sub::LoanedSamples<DynamicData>& samples,
+        py::iterable& fields,
+        const std::vector<std::string>& info_fields)
+{
+    py::dict retval;
+    size_t count = samples.length();
+    std::vector<DynamicDataColumn> columns;
+
+    for (auto handle : fields) {
+        bool compiled = py::isinstance<PyDynamicDataPath>(handle);
+        if (!compiled && count == 0) {
+            // Nothing to resolve a path string against; the column is
+            // empty regardless of its type
+            retval[handle] = py::array_t<double>(0);
+            continue;
+        }
+        auto path = compiled ? py::cast<PyDynamicDataPath>(handle)
+                             : PyDynamicDataPath::compile(
+                                     samples[0].data().type(),
+                                     py::cast<std::string>(handle));
+        auto kind = path.last().kind;
+        py::array array(dynamic_data_column_dtype(kind), count);
+        columns.push_back(DynamicDataColumn {
+                path,
+                kind,
+                static_cast<char*>(array.mutable_data()),
+                static_cast<size_t>(array.itemsize()),
+                array.itemsize() });
+        retval[py::str(path.path())] = array;
+    }
 
-class PyDynamicDataItemsIterator {
-public:
-    PyDynamicDataItemsIterator(DynamicData& dd, bool reversed) : _dd(dd)
-    {
-        if (reversed) {
-            this->_index = dd.member_count();
-            this->_end = 0;
-            this->_step = -1;
+    bool* valid = nullptr;
+    rti::core::int64* source_timestamp = nullptr;
+    rti::core::int64* reception_timestamp = nullptr;
+    uint8_t* instance_handle = nullptr;
+    for (auto& info_field : info_fields) {
+        if (info_field == "valid") {
+            py::array_t<bool> array(count);
+            valid = array.mutable_data();
+            retval["valid"] = array;
+        } else if (info_field == "source_timestamp") {
+            py::array_t<rti::core::int64> array(count);
+            source_timestamp = array.mutable_data();
+            retval["source_timestamp"] = array;
+        } else if (info_field == "reception_timestamp") {
+            py::array_t<rti::core::int64> array(count);
+            reception_timestamp = array.mutable_data();
+            retval["reception_timestamp"] = array;
+        } else if (info_field == "instance_handle") {
+            py::array array(py::dtype::from_args(py::str("V16")), count);
+            instance_handle = static_cast<uint8_t*>(array.mutable_data());
+            retval["instance_handle"] = array;
         } else {
-            this->_index = 1;
-            this->_end = dd.member_count() + 1;
-            this->_step = 1;
+            throw dds::core::InvalidArgumentError(
+                    "unsupported SampleInfo column: " + info_field);
         }
     }
 
-    std::pair<std::string, py::object> next()
     {
-        auto retval = std::pair<std::string, py::object>();
-
-        if (this->_index == this->_end)
-            throw py::stop_iteration();
-
-        auto mi = get_member_info(this->_dd, (uint32_t)this->_index);
-
-        retval.first = mi.member_name();
-        if (this->_dd.member_exists(this->_index)) {
-           retval.second = get_member(
-                            this->_dd,
-                            mi.member_kind().underlying(),
-                            mi.member_name());
-        }
-        else {
-            retval.second = py::none();
+        py::gil_scoped_release release;
+        for (size_t i = 0; i < count; ++i) {
+            auto sample = samples[i];
+            auto& info = sample.info();
+            if (valid) valid[i] = info.valid();
+            if (source_timestamp) {
+                source_timestamp[i] = time_to_nanosecs(info.source_timestamp());
+            }
+            if (reception_timestamp) {
+                reception_timestamp[i] =
+                        time_to_nanosecs(info->reception_timestamp());
+            }
+            if (instance_handle) {
+                std::memcpy(
+                        instance_handle + i * 16,
+                        info.instance_handle().delegate().native().keyHash.value,
+                        16);
+            }
+            if (info.valid()) {
+                auto& dd = const_cast<DynamicData&>(sample.data());
+                for (auto& column : columns) {
+                    apply_dynamic_data_column<GetDynamicDataColumnValue>(
+                            dd,
+                            column,
+                            i);
+                }
+            } else {
+                for (auto& column : columns) {
+                    std::memset(
+                            column.data + i * column.itemsize,
+                            0,
+                            column.itemsize);
+                }
+            }
         }
-        this->_index += this->_step;
-        return retval;
     }
 
-private:
-    DynamicData& _dd;
-    int32_t _index;
-    int32_t _step;
-    int32_t _end;
-};
+    return retval;
+}
 
+// The buffers of a dict mapping field paths to 1D buffers, plus an optional
+// column of int64 source timestamps in nanoseconds
+struct DynamicDataColumnBuffers {
+    std::vector<py::buffer_info> buffers;
+    std::vector<DynamicDataColumn> columns;
+    const char* timestamp_data = nullptr;
+    ssize_t timestamp_stride = 0;
+    ssize_t count = -1;
 
-class PyDynamicDataItemsView {
-public:
-    PyDynamicDataItemsView(DynamicData& dd) : _dd(dd)
+    void fill(DynamicData& sample, ssize_t row)
     {
+        for (auto& column : this->columns) {
+            apply_dynamic_data_column<SetDynamicDataColumnValue>(
+                    sample,
+                    column,
+                    row);
+        }
     }
 
-    bool contains(const std::pair<std::string, py::object>& item)
+    dds::core::optional<dds::core::Time> timestamp(ssize_t row) const
     {
-        return _dd.member_exists_in_type(item.first)
-                && test_index(
-                        this->_dd,
-                        get_member_info(this->_dd, item.first)
-                                .member_kind()
-                                .underlying(),
-                        this->_dd.member_index(item.first),
-                        item.second);
+        if (this->timestamp_data == nullptr) {
+            return dds::core::optional<dds::core::Time>();
+        }
+        rti::core::int64 nanosecs;
+        std::memcpy(
+                &nanosecs,
+                this->timestamp_data + row * this->timestamp_stride,
+                sizeof(nanosecs));
+        return time_from_nanosecs(nanosecs);
     }
+};
 
-    PyDynamicDataItemsIterator iter()
-    {
-        return PyDynamicDataItemsIterator(this->_dd, false);
+static void request_dynamic_data_columns(
+        const DynamicType& dt,
+        py::dict& data,
+        py::object& timestamps,
+        DynamicDataColumnBuffers& result)
+{
+    auto request_column = [&result](py::handle obj, const py::dtype& dtype)
+            -> py::buffer_info {
+        auto info = py::cast<py::buffer>(obj).request();
+        if (info.ndim != 1) {
+            throw py::type_error("Only 1D buffers are allowed");
+        }
+        if (!py::dtype(info).equal(dtype)) {
+            throw py::type_error(
+                    "Format mismatch (Python: " + info.format + ")");
+        }
+        if (result.count >= 0 && info.shape[0] != result.count) {
+            throw py::value_error("All columns must have the same length");
+        }
+        result.count = info.shape[0];
+        return info;
+    };
+
+    for (auto kv : data) {
+        auto path = py::isinstance<PyDynamicDataPath>(kv.first)
+                ? py::cast<PyDynamicDataPath>(kv.first)
+                : PyDynamicDataPath::compile(
+                        dt,
+                        py::cast<std::string>(kv.first));
+        auto kind = path.last().kind;
+        auto dtype = dynamic_data_column_dtype(kind);
+        result.buffers.push_back(request_column(kv.second, dtype));
+        auto& info = result.buffers.back();
+        result.columns.push_back(DynamicDataColumn {
+                path,
+                kind,
+                static_cast<char*>(info.ptr),
+                static_cast<size_t>(info.itemsize),
+                info.strides[0] });
     }
 
-    PyDynamicDataItemsIterator reversed()
-    {
-        return PyDynamicDataItemsIterator(this->_dd, true);
+    if (!timestamps.is_none()) {
+        result.buffers.push_back(request_column(
+                timestamps,
+                py::dtype::of<rti::core::int64>()));
+        auto& info = result.buffers.back();
+        result.timestamp_data = static_cast<const char*>(info.ptr);
+        result.timestamp_stride = info.strides[0];
     }
+}
 
-    size_t len()
-    {
-        return this->_dd.member_count();
+// Fills one sample per row of the columns and passes it to op with the
+// row's timestamp, without the GIL
+template<typename Op>
+static void for_each_dynamic_data_row(
+        PyDataWriter<DynamicData>& dw,
+        py::dict& data,
+        py::object& timestamps,
+        Op op)
+{
+    auto& dt = dw.cache().type(dw);
+    DynamicDataColumnBuffers columns;
+    request_dynamic_data_columns(dt, data, timestamps, columns);
+    if (columns.count <= 0) return;
+
+    py::gil_scoped_release release;
+    DynamicData sample(dt);
+    for (ssize_t i = 0; i < columns.count; ++i) {
+        columns.fill(sample, i);
+        op(sample, columns.timestamp(i));
     }
+}
 
-private:
-    DynamicData& _dd;
-};
+static void write_dynamic_data_columns(
+        PyDataWriter<DynamicData>& dw,
+        py::dict& data,
+        py::object& timestamps)
+{
+    for_each_dynamic_data_row(
+            dw,
+            data,
+            timestamps,
+            [&dw](const DynamicData& sample,
+                  const dds::core::optional<dds::core::Time>& timestamp) {
+                if (has_value(timestamp)) {
+                    dw.write(sample, get_value(timestamp));
+                } else {
+                    dw.write(sample);
+                }
+            });
+}
+
+// Key columns version of the vectorized instance operations
+static std::vector<dds::core::InstanceHandle> dynamic_data_column_instances(
+        PyDataWriter<DynamicData>& dw,
+        py::dict& data,
+        py::object& timestamps,
+        bool register_keys)
+{
+    std::vector<dds::core::InstanceHandle> handles;
+    for_each_dynamic_data_row(
+            dw,
+            data,
+            timestamps,
+            [&dw, &handles, register_keys](
+                    const DynamicData& sample,
+                    const dds::core::optional<dds::core::Time>& timestamp) {
+                if (!register_keys) {
+                    handles.push_back(dw.lookup_instance(sample));
+                } else if (has_value(timestamp)) {
+                    handles.push_back(dw.register_instance(
+                            sample,
+                            get_value(timestamp)));
+                } else {
+                    handles.push_back(dw.register_instance(sample));
+                }
+            });
+    return handles;
+}
+
+static void dispose_dynamic_data_column_instances(
+        PyDataWriter<DynamicData>& dw,
+        py::dict& data,
+        py::object& timestamps,
+        bool dispose)
+{
+    for_each_dynamic_data_row(
+            dw,
+            data,
+            timestamps,
+            [&dw, dispose](
+                    const DynamicData& sample,
+                    const dds::core::optional<dds::core::Time>& timestamp) {
+                auto handle = dw.lookup_instance(sample);
+                if (dispose && has_value(timestamp)) {
+                    dw.dispose_instance(handle, get_value(timestamp));
+                } else if (dispose) {
+                    dw.dispose_instance(handle);
+                } else if (has_value(timestamp)) {
+                    dw.unregister_instance(handle, get_value(timestamp));
+                } else {
+                    dw.unregister_instance(handle);
+                }
+            });
+}
 
 
 template<>
@@ -1334,6 +2838,9 @@ void init_dds_typed_topic_template(
                         const dds::core::xtypes::DynamicType& type) {
                 PyTopic<dds::core::xtypes::DynamicData> t(dp, name, type);
                 PyDynamicTypeMap::add(t.type_name(), type);
+                t.type_handle().set(
+                        std::make_shared<const dds::core::xtypes::DynamicType>(
+                                type));
                 return t;
             }),
             py::arg("participant"),
@@ -1352,6 +2859,9 @@ void init_dds_typed_topic_template(
                      PyTopic<dds::core::xtypes::DynamicData>
                              t(dp, name, type, qos, listener, mask);
                      PyDynamicTypeMap::add(t.type_name(), type);
+                     t.type_handle().set(std::make_shared<
+                                         const dds::core::xtypes::DynamicType>(
+                             type));
                      return t;
                  }),
                  py::arg("participant"),
@@ -1400,13 +2910,14 @@ void init_dds_typed_datawriter_template(
                "write",
                [](PyDataWriter<dds::core::xtypes::DynamicData>& dw,
                   py::dict& dict) {
-                   auto dt = PyDynamicTypeMap::get(dw->type_name());
-                   dds::core::xtypes::DynamicData sample(dt);
-                   update_dynamicdata_object(sample, dict);
+                   auto& cache = dw.cache();
+                   auto sample = cache.acquire_sample(dw);
+                   update_writer_sample(dw, *sample, dict);
                    {
                        py::gil_scoped_release release;
-                       dw.write(sample);
+                       dw.write(*sample);
                    }
+                   cache.release_sample(std::move(sample));
                },
                py::arg("sample_data"),
                "Create a DynamicData object and write it with the given "
@@ -1416,16 +2927,17 @@ void init_dds_typed_datawriter_template(
                     [](PyDataWriter<dds::core::xtypes::DynamicData>& dw,
                        py::dict& dict) {
                         return PyAsyncioExecutor::run<void>(
+                                dw.publisher().participant(),
                                 std::function<void()>([&dw, &dict]() {
                                     py::gil_scoped_acquire acquire;
-                                    auto dt = PyDynamicTypeMap::get(
-                                            dw->type_name());
-                                    dds::core::xtypes::DynamicData sample(dt);
-                                    update_dynamicdata_object(sample, dict);
+                                    auto& cache = dw.cache();
+                                    auto sample = cache.acquire_sample(dw);
+                                    update_writer_sample(dw, *sample, dict);
                                     {
                                         py::gil_scoped_release release;
-                                        dw.write(sample);
+                                        dw.write(*sample);
                                     }
+                                    cache.release_sample(std::move(sample));
                                 }));
                     },
                     py::arg("sample_data"),
@@ -1434,11 +2946,83 @@ void init_dds_typed_datawriter_template(
                     "Create a DynamicData object and write it with the given "
                     "dictionary containing field names as keys. This method is "
                     "awaitable and is only for use with asyncio.")
+            .def(
+                    "write_columns",
+                    &write_dynamic_data_columns,
+                    py::arg("columns"),
+                    py::arg("timestamps") = py::none(),
+                    "Write one sample per row of the given columns, a dict "
+                    "mapping field paths (str or DynamicDataPath) to 1D "
+                    "buffers such as NumPy arrays of the field type. The "
+                    "optional timestamps buffer holds one int64 source "
+                    "timestamp in nanoseconds per row. Fields not in the "
+                    "columns keep their default values.")
+            .def(
+                    "register_instances",
+                    [](PyDataWriter<DynamicData>& dw,
+                       py::dict& columns,
+                       py::object& timestamps) {
+                        return dynamic_data_column_instances(
+                                dw,
+                                columns,
+                                timestamps,
+                                true);
+                    },
+                    py::arg("columns"),
+                    py::arg("timestamps") = py::none(),
+                    "Register one instance per row of the given key "
+                    "columns, a dict mapping key field paths to 1D buffers "
+                    "as in write_columns, and return their handles. The "
+                    "optional timestamps buffer holds one int64 source "
+                    "timestamp in nanoseconds per row.")
+            .def(
+                    "lookup_instances",
+                    [](PyDataWriter<DynamicData>& dw, py::dict& columns) {
+                        py::object timestamps = py::none();
+                        return dynamic_data_column_instances(
+                                dw,
+                                columns,
+                                timestamps,
+                                false);
+                    },
+                    py::arg("columns"),
+                    "Retrieve the instance handle of each row of the given "
+                    "key columns. Unknown instances get a nil handle.")
+            .def(
+                    "dispose_instances",
+                    [](PyDataWriter<DynamicData>& dw,
+                       py::dict& columns,
+                       py::object& timestamps) {
+                        dispose_dynamic_data_column_instances(
+                                dw,
+                                columns,
+                                timestamps,
+                                true);
+                    },
+                    py::arg("columns"),
+                    py::arg("timestamps") = py::none(),
+                    "Dispose the instance of each row of the given key "
+                    "columns.")
+            .def(
+                    "unregister_instances",
+                    [](PyDataWriter<DynamicData>& dw,
+                       py::dict& columns,
+                       py::object& timestamps) {
+                        dispose_dynamic_data_column_instances(
+                                dw,
+                                columns,
+                                timestamps,
+                                false);
+                    },
+                    py::arg("columns"),
+                    py::arg("timestamps") = py::none(),
+                    "Unregister the instance of each row of the given key "
+                    "columns.")
             .def(
                     "create_data",
                     [](PyDataWriter<dds::core::xtypes::DynamicData>& dw) {
                         return dds::core::xtypes::DynamicData(
-                                PyDynamicTypeMap::get(dw->type_name()));
+                                dw.cache().type(dw));
                     },
                     py::call_guard<py::gil_scoped_release>(),
                     "Create data of the writer's associated type and "
@@ -1448,7 +3032,7 @@ void init_dds_typed_datawriter_template(
                     [](PyDataWriter<dds::core::xtypes::DynamicData>& dw,
                        const dds::core::InstanceHandle& handle) {
                         dds::core::xtypes::DynamicData d(
-                                PyDynamicTypeMap::get(dw->type_name()));
+                                dw.cache().type(dw));
                         dw.key_value(d, handle);
                         return d;
                     },
@@ -1461,7 +3045,7 @@ void init_dds_typed_datawriter_template(
                     [](PyDataWriter<dds::core::xtypes::DynamicData>& dw,
                        const dds::core::InstanceHandle& handle) {
                         dds::core::xtypes::DynamicData d(
-                                PyDynamicTypeMap::get(dw->type_name()));
+                                dw.cache().type(dw));
                         dds::topic::TopicInstance<
                                 dds::core::xtypes::DynamicData>
                                 ti(handle, d);
@@ -1486,9 +3070,7 @@ void init_dds_typed_datareader_template(
                "key_value",
                [](PyDataReader<dds::core::xtypes::DynamicData>& dr,
                   const dds::core::InstanceHandle& handle) {
-                   dds::core::xtypes::DynamicType dt(
-                           PyDynamicTypeMap::get(dr->type_name()));
-                   dds::core::xtypes::DynamicData dd(dt);
+                   dds::core::xtypes::DynamicData dd(dr.dynamic_type());
                    dr.key_value(dd, handle);
                    return dd;
                },
@@ -1500,9 +3082,7 @@ void init_dds_typed_datareader_template(
                     "topic_instance_key_value",
                     [](PyDataReader<dds::core::xtypes::DynamicData>& dr,
                        const dds::core::InstanceHandle& handle) {
-                        dds::core::xtypes::DynamicType dt(
-                                PyDynamicTypeMap::get(dr->type_name()));
-                        dds::core::xtypes::DynamicData dd(dt);
+                        dds::core::xtypes::DynamicData dd(dr.dynamic_type());
                         dds::topic::TopicInstance<
                                 dds::core::xtypes::DynamicData>
                                 ti(handle, dd);
@@ -1520,7 +3100,7 @@ void init_dds_typed_datareader_template(
                                 dds::core::xtypes::DynamicData>>
                                 retval;
                         dds::core::xtypes::DynamicData data(
-                                PyDynamicTypeMap::get(dr->type_name()));
+                                dr.dynamic_type());
                         dds::sub::SampleInfo info;
                         if (dr->read(data, info)) {
                             retval = dds::sub::Sample<
@@ -1538,7 +3118,7 @@ void init_dds_typed_datareader_template(
                                 dds::core::xtypes::DynamicData>>
                                 retval;
                         dds::core::xtypes::DynamicData data(
-                                PyDynamicTypeMap::get(dr->type_name()));
+                                dr.dynamic_type());
                         dds::sub::SampleInfo info;
                         if (dr->take(data, info)) {
                             retval = dds::sub::Sample<
@@ -1558,6 +3138,58 @@ void init_dds_typed_topic_instance_template(
     init_dds_typed_topic_instance_base_template(cls);
 }
 
+template<>
+void init_loaned_samples(
+        py::class_<
+            dds::sub::LoanedSamples<DynamicData>,
+            std::unique_ptr<dds::sub::LoanedSamples<DynamicData>, no_gil_delete<dds::sub::LoanedSamples<DynamicData>>>>& cls)
+{
+    init_loaned_samples_defs(cls);
+
+    cls.def(
+            "to_columns",
+            &loaned_samples_to_columns,
+            py::arg("fields"),
+            py::arg_v(
+                    "info_fields",
+                    std::vector<std::string> {
+                            "valid",
+                            "source_timestamp",
+                            "instance_handle" },
+                    "['valid', 'source_timestamp', 'instance_handle']"),
+            "Extract primitive fields of all samples into a dict of NumPy "
+            "arrays, one per field path (str or DynamicDataPath) plus the "
+            "requested SampleInfo columns: valid, source_timestamp, "
+            "reception_timestamp (nanoseconds) and instance_handle "
+            "(16-byte key hash). Fields of invalid samples are zero.")
+            .def(
+                    "view",
+                    &loaned_samples_view,
+                    py::arg("index"),
+                    "Get a read-only DynamicData.View of the data of a "
+                    "sample, or None if the sample has no valid data. The "
+                    "view doesn't copy the sample and can only be used until "
+                    "the loan is returned.")
+            .def(
+                    "views",
+                    &loaned_samples_views,
+                    "Get a list of (DynamicData.View, SampleInfo) tuples for "
+                    "all samples, with None as the view of samples without "
+                    "valid data.")
+            .def(
+                    "to_dicts",
+                    &loaned_samples_to_dicts,
+                    "Convert every sample to a dict (see DynamicData.to_dict). "
+                    "Samples without valid data are returned as None.")
+            .def(
+                    "to_cdr_bytes",
+                    &loaned_samples_to_cdr_bytes,
+                    "Serialize all samples to CDR in a single bytes object "
+                    "of length-prefixed records (4-byte little-endian "
+                    "length followed by the CDR data). Samples without "
+                    "valid data are written as empty records.");
+}
+
 template<>
 void init_dds_typed_sample_template(
         py::class_<dds::sub::Sample<DynamicData>>& cls)
@@ -1728,6 +3360,7 @@ void init_class_defs(py::class_<DynamicData>& dd_class)
             dd_class,
             "IndexIterator");
     py::class_<PyDynamicDataItemsView> items_view(dd_class, "ItemsView");
+    py::class_<PyDynamicDataView> view(dd_class, "View");
     py::class_<PyDynamicDataItemsIterator> items_iterator(
             dd_class,
             "ItemsIterator");
@@ -2238,6 +3871,14 @@ void init_class_defs(py::class_<DynamicData>& dd_class)
                         return output;
                     },
                     "Serializes a DynamicData sample to CDR format")
+            .def(
+                    "from_cdr_buffer",
+                    &dynamic_data_from_cdr_buffer,
+                    py::arg("buffer"),
+                    "Populates a DynamicData sample by deserializing a CDR "
+                    "buffer from any object supporting the buffer protocol "
+                    "(e.g. bytes, bytearray or memoryview) without copying "
+                    "it.")
             .def(
                     "from_cdr_buffer",
                     [](dds::core::xtypes::DynamicData& sample,
@@ -2249,6 +3890,27 @@ void init_class_defs(py::class_<DynamicData>& dd_class)
                     py::arg("buffer"),
                     "Populates a DynamicData sample by deserializing a CDR "
                     "buffer.")
+            .def(
+                    "to_dict",
+                    (py::object(*)(DynamicData&)) &dynamic_data_to_dict,
+                    "Convert a structure or union sample to a dict, "
+                    "recursively. Nested structures and unions become dicts, "
+                    "arrays and sequences become lists, enumerations their "
+                    "ordinal and unset optional members None. Only the "
+                    "selected member of a union is included.")
+            .def(
+                    "to_cdr_bytes",
+                    &dynamic_data_to_cdr_bytes,
+                    "Serializes a DynamicData sample to CDR format into a "
+                    "bytes object.")
+            .def(
+                    "to_cdr_into",
+                    &dynamic_data_to_cdr_into,
+                    py::arg("buffer"),
+                    py::arg("offset") = 0,
+                    "Serializes a DynamicData sample to CDR format into a "
+                    "writable buffer (e.g. bytearray or memoryview) at the "
+                    "given offset. Returns the number of bytes written.")
             .def("fields",
                  [](DynamicData& dd) {
                      if (dd.type_kind().underlying()
@@ -2337,6 +3999,92 @@ void init_class_defs(py::class_<DynamicData>& dd_class)
                  [](DynamicData& dd, py::dict& dict) {
                      update_dynamicdata_object(dd, dict);
                  })
+            .def(
+                "set_value",
+                [](DynamicData& dd,
+                   const PyDynamicDataPath& path,
+                   py::object& value) {
+                    set_path_value(dd, path, value);
+                },
+                py::arg("field_path"),
+                py::arg("value"),
+                "Automatically resolve type and set value for a compiled "
+                "field path.")
+            .def(
+                "set_values",
+                [](DynamicData& dd,
+                   const PyDynamicDataPath& path,
+                   py::object& values) {
+                    set_path_values(dd, path, values);
+                },
+                py::arg("field_path"),
+                py::arg("values"),
+                "Automatically resolve type and set collection for a compiled "
+                "field path.")
+            .def(
+                "__setitem__",
+                [](DynamicData& dd,
+                   const PyDynamicDataPath& path,
+                   py::object& value) {
+                    set_path_value(dd, path, value);
+                })
+            .def(
+                "get_value",
+                [](DynamicData& dd, const PyDynamicDataPath& path) {
+                    return get_path_value(dd, path, false);
+                },
+                py::arg("field_path"),
+                "Automatically resolve type and return value for a compiled "
+                "field path.")
+            .def(
+                "get_values",
+                [](DynamicData& dd, const PyDynamicDataPath& path) {
+                    return get_path_values(dd, path);
+                },
+                py::arg("field_path"),
+                "Automatically resolve type and return collection for a "
+                "compiled field path.")
+            .def(
+                "get_values_array",
+                [](DynamicData& dd, const PyDynamicDataPath& path) {
+                    py::object out = py::none();
+                    return get_path_values_buffer(dd, path, out);
+                },
+                py::arg("field_path"),
+                "Return a primitive collection for a compiled field path as "
+                "a NumPy array, copied once from the sample.")
+            .def(
+                "get_values_into",
+                [](DynamicData& dd,
+                   const PyDynamicDataPath& path,
+                   py::buffer& out) {
+                    py::object obj = out;
+                    return get_path_values_buffer(dd, path, obj);
+                },
+                py::arg("field_path"),
+                py::arg("out"),
+                "Copy a primitive collection for a compiled field path into "
+                "a writable buffer and return the number of elements copied.")
+            .def(
+                "__getitem__",
+                [](DynamicData& dd, const PyDynamicDataPath& path) {
+                    // collection members are converted like named fields,
+                    // matching __getitem__ with a string path
+                    bool dict_access = !path.last().name.empty();
+                    return get_path_value(dd, path, dict_access);
+                })
+            .def(
+                "member_exists",
+                [](DynamicData& dd, const PyDynamicDataPath& path) {
+                    DynamicDataNestedIndex id;
+                    DynamicData& parent = path.resolve_parent(dd, id.loan_list);
+                    auto& step = path.last();
+                    if (step.by_name) return parent.member_exists(step.name);
+                    else return parent.member_exists(step.index);
+                },
+                py::arg("field_path"),
+                "Determine if an optional member is set for a compiled field "
+                "path.")
             .def(
                 "set_value",
                 [](DynamicData& dd, std::string& key, py::object& value) {
@@ -2390,6 +4138,33 @@ void init_class_defs(py::class_<DynamicData>& dd_class)
             py::arg("field_path"),
             "Automatically resolve type and return collection for a field."
         )
+        .def(
+            "get_values_array",
+            [](DynamicData& dd, std::string& key) {
+                DynamicDataNestedIndex id;
+                DynamicData& parent = resolve_nested_member(dd, key, id);
+                py::object out = py::none();
+                if (id.index_type == DynamicDataNestedIndex::INT) return get_values_buffer(parent, id.int_index, out);
+                else return get_values_buffer(parent, id.string_index, out);
+            },
+            py::arg("field_path"),
+            "Return a primitive collection field as a NumPy array, copied "
+            "once from the sample."
+        )
+        .def(
+            "get_values_into",
+            [](DynamicData& dd, std::string& key, py::buffer& out) {
+                DynamicDataNestedIndex id;
+                DynamicData& parent = resolve_nested_member(dd, key, id);
+                py::object obj = out;
+                if (id.index_type == DynamicDataNestedIndex::INT) return get_values_buffer(parent, id.int_index, obj);
+                else return get_values_buffer(parent, id.string_index, obj);
+            },
+            py::arg("field_path"),
+            py::arg("out"),
+            "Copy a primitive collection field into a writable buffer and "
+            "return the number of elements copied."
+        )
         .def(
             "member_exists",
             [](DynamicData& dd, std::string& key) {
@@ -2759,6 +4534,67 @@ void init_class_defs(py::class_<DynamicData>& dd_class)
                     py::arg("buffer"),
                     "Deserialize a sample from a CDR buffer.");
 
+    view.def("__getitem__",
+             (py::object(PyDynamicDataView::*)(const std::string&) const)
+                     & PyDynamicDataView::get,
+             py::arg("key"),
+             "Get a member by field path. Structures, unions and "
+             "collections of them are returned as views.")
+            .def("__getitem__",
+                 (py::object(PyDynamicDataView::*)(const PyDynamicDataPath&)
+                          const)
+                         & PyDynamicDataView::get,
+                 py::arg("path"),
+                 "Get a member by compiled field path, relative to this "
+                 "view like a string key.")
+            .def("__getitem__",
+                 (py::object(PyDynamicDataView::*)(size_t) const)
+                         & PyDynamicDataView::get,
+                 py::arg("index"),
+                 "Get a structure member or a collection element by index.")
+            .def("__len__",
+                 &PyDynamicDataView::size,
+                 "The number of members or elements.")
+            .def_property_readonly(
+                    "valid",
+                    &PyDynamicDataView::valid,
+                    "Whether the loan this view refers to is still held.")
+            .def_property_readonly(
+                    "path",
+                    &PyDynamicDataView::path,
+                    "The field path of the viewed member within the sample "
+                    "(empty for the whole sample).")
+            .def_property_readonly(
+                    "type",
+                    [](const PyDynamicDataView& v) -> py::object {
+                        DynamicDataNestedIndex loans;
+                        DynamicType type = v.resolve(loans.loan_list).type();
+                        return py_cast_type(type);
+                    },
+                    "The type of the viewed data.")
+            .def(
+                    "to_dict",
+                    [](const PyDynamicDataView& v) -> py::object {
+                        DynamicDataNestedIndex loans;
+                        return dynamic_data_to_dict(v.resolve(loans.loan_list));
+                    },
+                    "Convert the viewed structure or union to a dict.")
+            .def(
+                    "copy",
+                    [](const PyDynamicDataView& v) -> DynamicData {
+                        DynamicDataNestedIndex loans;
+                        return DynamicData(v.resolve(loans.loan_list));
+                    },
+                    "Copy the viewed data into a DynamicData object that "
+                    "remains valid after the loan is returned.")
+            .def(
+                    "__str__",
+                    [](const PyDynamicDataView& v) -> std::string {
+                        DynamicDataNestedIndex loans;
+                        return rti::core::xtypes::to_string(
+                                v.resolve(loans.loan_list));
+                    });
+
     fields_view.def(py::init<DynamicData&>())
             .def("__iter__",
                  &PyDynamicDataFieldsView::iter,
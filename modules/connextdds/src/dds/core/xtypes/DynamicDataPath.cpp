@@ -0,0 +1,228 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#include "PyConnext.hpp"
+#include <sstream>
+#include <dds/core/xtypes/AliasType.hpp>
+#include <dds/core/xtypes/CollectionTypes.hpp>
+#include <dds/core/xtypes/StructType.hpp>
+#include <dds/core/xtypes/UnionType.hpp>
+#include "PyDynamicDataPath.hpp"
+
+using namespace dds::core::xtypes;
+
+namespace pyrti {
+
+static std::vector<int> parse_subscript(
+        const std::string& path,
+        size_t& pos)
+{
+    std::vector<int> indices;
+    size_t close = path.find(']', pos);
+    if (close == std::string::npos) {
+        throw dds::core::InvalidArgumentError(
+                "index parse error: missing ']' in " + path);
+    }
+    std::stringstream ss(path.substr(pos + 1, close - pos - 1));
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        try {
+            size_t parsed = 0;
+            int index = std::stoi(token, &parsed);
+            if (token.find_first_not_of(" \t", parsed) != std::string::npos
+                || index < 0) {
+                throw std::invalid_argument(token);
+            }
+            indices.push_back(index);
+        } catch (std::logic_error&) {
+            throw dds::core::InvalidArgumentError(
+                    "index parse error: invalid index in " + path);
+        }
+    }
+    if (indices.empty()) {
+        throw dds::core::InvalidArgumentError(
+                "index parse error: empty subscript in " + path);
+    }
+    pos = close + 1;
+    return indices;
+}
+
+
+static uint32_t calculate_element_index(
+        const DynamicType& type,
+        const std::vector<int>& index)
+{
+    if (type.kind().underlying() == TypeKind::SEQUENCE_TYPE) {
+        if (index.size() != 1) {
+            throw dds::core::InvalidArgumentError(
+                    "index error: incorrect dimensions in subscript");
+        }
+        return index[0] + 1;
+    }
+
+    auto& array_type = static_cast<const ArrayType&>(type);
+    if (array_type.dimension_count() != index.size()) {
+        throw dds::core::InvalidArgumentError(
+                "index error: incorrect dimensions in subscript");
+    }
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < index.size(); ++i) {
+        if (static_cast<uint32_t>(index[i]) >= array_type.dimension(i)) {
+            throw py::index_error("Invalid index for dimension.");
+        }
+        offset = offset * array_type.dimension(i) + index[i];
+    }
+    return offset + 1;
+}
+
+
+static void set_step_kind(
+        PyDynamicDataPath::Step& step,
+        const DynamicType& member_type)
+{
+    step.kind = member_type.kind().underlying();
+    step.element_kind = TypeKind::NO_TYPE;
+    if (step.kind == TypeKind::ARRAY_TYPE
+        || step.kind == TypeKind::SEQUENCE_TYPE) {
+        auto& collection_type = static_cast<const CollectionType&>(member_type);
+        step.element_kind =
+                rti::core::xtypes::resolve_alias(collection_type.content_type())
+                        .kind()
+                        .underlying();
+    }
+}
+
+
+PyDynamicDataPath PyDynamicDataPath::compile(
+        const DynamicType& type,
+        const std::string& path)
+{
+    PyDynamicDataPath retval(type, path);
+    const DynamicType* current = &rti::core::xtypes::resolve_alias(type);
+    std::stringstream ss(path);
+    std::string token;
+
+    while (std::getline(ss, token, '.')) {
+        size_t pos = token.find('[');
+        std::string name = token.substr(0, pos);
+        if (name.empty()) {
+            throw dds::core::InvalidArgumentError(
+                    "field path parse error: empty member name in " + path);
+        }
+
+        Step step;
+        step.name = name;
+        switch (current->kind().underlying()) {
+        case TypeKind::STRUCTURE_TYPE: {
+            auto& struct_type = static_cast<const StructType&>(*current);
+            auto index = struct_type.find_member_by_name(name);
+            if (index == StructType::INVALID_INDEX) {
+                throw dds::core::InvalidArgumentError(
+                        "member name " + name + " does not exist in type");
+            }
+            step.index = index + 1;
+            step.by_name = false;
+            current = &struct_type.member(index).type();
+            break;
+        }
+        case TypeKind::UNION_TYPE: {
+            auto& union_type = static_cast<const UnionType&>(*current);
+            auto index = union_type.find_member_by_name(name);
+            if (index == UnionType::INVALID_INDEX) {
+                throw dds::core::InvalidArgumentError(
+                        "member name " + name + " does not exist in type");
+            }
+            step.index = 0;
+            step.by_name = true;
+            current = &union_type.member(index).type();
+            break;
+        }
+        default:
+            throw dds::core::InvalidArgumentError(
+                    "field path error: " + name
+                    + " is not a member of an aggregation type");
+        }
+        current = &rti::core::xtypes::resolve_alias(*current);
+        set_step_kind(step, *current);
+        retval._steps.push_back(step);
+
+        while (pos != std::string::npos && pos < token.size()) {
+            if (token[pos] != '[') {
+                throw dds::core::InvalidArgumentError(
+                        "index parse error: '[' expected in " + path);
+            }
+            auto kind = current->kind().underlying();
+            if (kind != TypeKind::ARRAY_TYPE
+                && kind != TypeKind::SEQUENCE_TYPE) {
+                throw dds::core::InvalidArgumentError(
+                        "type does not support subscript");
+            }
+            auto indices = parse_subscript(token, pos);
+
+            Step element;
+            element.index = calculate_element_index(*current, indices);
+            element.by_name = false;
+            current = &rti::core::xtypes::resolve_alias(
+                    static_cast<const CollectionType&>(*current)
+                            .content_type());
+            set_step_kind(element, *current);
+            retval._steps.push_back(element);
+        }
+    }
+
+    if (retval._steps.empty()) {
+        throw dds::core::InvalidArgumentError("field path is empty");
+    }
+
+    return retval;
+}
+
+
+template<>
+void init_class_defs(py::class_<PyDynamicDataPath>& cls)
+{
+    cls.def(py::init(&PyDynamicDataPath::compile),
+            py::arg("type"),
+            py::arg("path"),
+            "Compile a field path for the given type. The resulting object "
+            "can be used in place of the path string to access fields of "
+            "DynamicData samples of that type.")
+            .def_property_readonly(
+                    "path",
+                    &PyDynamicDataPath::path,
+                    "The field path this object was compiled from.")
+            .def_property_readonly(
+                    "type",
+                    [](const PyDynamicDataPath& p) {
+                        auto dt = p.type();
+                        return py_cast_type(dt);
+                    },
+                    "The type this field path was compiled against.")
+            .def(
+                    "__str__",
+                    &PyDynamicDataPath::path,
+                    "The field path this object was compiled from.")
+            .def(
+                    "__repr__",
+                    [](const PyDynamicDataPath& p) {
+                        return "DynamicDataPath('" + p.path() + "')";
+                    });
+}
+
+template<>
+void process_inits<PyDynamicDataPath>(py::module& m, ClassInitList& l)
+{
+    l.push_back([m]() mutable {
+        return init_class<PyDynamicDataPath>(m, "DynamicDataPath");
+    });
+}
+
+}  // namespace pyrti
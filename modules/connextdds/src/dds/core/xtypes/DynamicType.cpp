@@ -15,6 +15,7 @@
 #include <dds/core/xtypes/CollectionTypes.hpp>
 #include <dds/core/xtypes/EnumType.hpp>
 #include <dds/core/xtypes/StructType.hpp>
+#include "PyDynamicDataPath.hpp"
 
 using namespace dds::core::xtypes;
 
@@ -116,6 +117,16 @@ void init_class_defs(py::class_<DynamicType>& cls)
                         return dds::core::xtypes::is_aggregation_type(dt);
                     },
                     "Determines if this DynamicType is an aggregation type.")
+            .def(
+                    "compile_path",
+                    [](const DynamicType& dt, const std::string& path) {
+                        return PyDynamicDataPath::compile(dt, path);
+                    },
+                    py::arg("path"),
+                    "Resolve a field path (e.g. \"a.b[3].c\") against this "
+                    "type once and return a DynamicDataPath that can be "
+                    "used to access that field in DynamicData samples of "
+                    "this type without parsing the path again.")
             .def("print_idl",
                  &rti::core::xtypes::print_idl,
                  py::arg("index") = 0,
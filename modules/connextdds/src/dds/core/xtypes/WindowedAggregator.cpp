@@ -0,0 +1,665 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#include "PyConnext.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "PyWindowedAggregator.hpp"
+
+using namespace dds::core::xtypes;
+
+namespace pyrti {
+
+static int64_t to_nanosecs(const dds::core::Duration& d)
+{
+    return static_cast<int64_t>(d.sec()) * 1000000000 + d.nanosec();
+}
+
+
+static int64_t to_nanosecs(const dds::core::Time& t)
+{
+    return static_cast<int64_t>(t.sec()) * 1000000000 + t.nanosec();
+}
+
+
+static dds::core::Time to_time(int64_t ns)
+{
+    return dds::core::Time(
+            static_cast<int32_t>(ns / 1000000000),
+            static_cast<uint32_t>(ns % 1000000000));
+}
+
+
+static bool is_numeric_kind(TypeKind::inner_enum kind)
+{
+    switch (kind) {
+    case TypeKind::BOOLEAN_TYPE:
+    case TypeKind::UINT_8_TYPE:
+    case TypeKind::INT_16_TYPE:
+    case TypeKind::UINT_16_TYPE:
+    case TypeKind::INT_32_TYPE:
+    case TypeKind::ENUMERATION_TYPE:
+    case TypeKind::UINT_32_TYPE:
+    case TypeKind::INT_64_TYPE:
+    case TypeKind::UINT_64_TYPE:
+    case TypeKind::FLOAT_32_TYPE:
+    case TypeKind::FLOAT_64_TYPE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+template<typename T>
+static double member_value(
+        DynamicData& parent,
+        const PyDynamicDataPath::Step& step)
+{
+    return static_cast<double>(
+            step.by_name ? parent.value<T>(step.name)
+                         : parent.value<T>(step.index));
+}
+
+
+static double numeric_value(DynamicData& dd, const PyDynamicDataPath& path)
+{
+    std::list<rti::core::xtypes::LoanedDynamicData> loans;
+    // Loans must be returned innermost first
+    struct ReturnLoans {
+        std::list<rti::core::xtypes::LoanedDynamicData>& loans;
+        ~ReturnLoans()
+        {
+            while (!loans.empty()) loans.pop_back();
+        }
+    } return_loans { loans };
+
+    DynamicData& parent = path.resolve_parent(dd, loans);
+    auto& step = path.last();
+    switch (step.kind) {
+    case TypeKind::BOOLEAN_TYPE:
+        return member_value<bool>(parent, step);
+    case TypeKind::UINT_8_TYPE:
+        return member_value<uint8_t>(parent, step);
+    case TypeKind::INT_16_TYPE:
+        return member_value<int16_t>(parent, step);
+    case TypeKind::UINT_16_TYPE:
+        return member_value<uint16_t>(parent, step);
+    case TypeKind::INT_32_TYPE:
+    case TypeKind::ENUMERATION_TYPE:
+        return member_value<int32_t>(parent, step);
+    case TypeKind::UINT_32_TYPE:
+        return member_value<uint32_t>(parent, step);
+    case TypeKind::INT_64_TYPE:
+        return member_value<rti::core::int64>(parent, step);
+    case TypeKind::UINT_64_TYPE:
+        return member_value<rti::core::uint64>(parent, step);
+    case TypeKind::FLOAT_32_TYPE:
+        return member_value<float>(parent, step);
+    default:
+        return member_value<double>(parent, step);
+    }
+}
+
+
+static void parse_aggregate(PyWindowedAggregator::Spec& spec)
+{
+    typedef PyWindowedAggregator::Function Function;
+    auto& name = spec.aggregate;
+    spec.percentile = 0;
+    if (name == "count") {
+        spec.function = Function::COUNT;
+    } else if (name == "sum") {
+        spec.function = Function::SUM;
+    } else if (name == "mean") {
+        spec.function = Function::MEAN;
+    } else if (name == "min") {
+        spec.function = Function::MIN;
+    } else if (name == "max") {
+        spec.function = Function::MAX;
+    } else if (name == "stddev") {
+        spec.function = Function::STDDEV;
+    } else if (name.size() > 1 && name[0] == 'p') {
+        // Percentiles such as p50, p99 or p99.9
+        size_t parsed = 0;
+        try {
+            spec.percentile = std::stod(name.substr(1), &parsed);
+        } catch (std::logic_error&) {
+            parsed = 0;
+        }
+        if (parsed != name.size() - 1 || !(spec.percentile >= 0)
+            || spec.percentile > 100) {
+            throw dds::core::InvalidArgumentError(
+                    "invalid percentile aggregate: " + name);
+        }
+        spec.function = Function::PERCENTILE;
+    } else {
+        throw dds::core::InvalidArgumentError("unknown aggregate: " + name);
+    }
+}
+
+
+static double percentile(std::vector<double>& values, double p)
+{
+    // Linear interpolation between the closest ranks
+    std::sort(values.begin(), values.end());
+    double rank = p / 100 * (values.size() - 1);
+    size_t lower = static_cast<size_t>(rank);
+    if (lower + 1 >= values.size()) {
+        return values.back();
+    }
+    double fraction = rank - lower;
+    return values[lower] + fraction * (values[lower + 1] - values[lower]);
+}
+
+
+static double aggregate(
+        const PyWindowedAggregator::Spec& spec,
+        std::deque<std::pair<int64_t, double>>::const_iterator begin,
+        std::deque<std::pair<int64_t, double>>::const_iterator end)
+{
+    typedef PyWindowedAggregator::Function Function;
+    double count = static_cast<double>(end - begin);
+    switch (spec.function) {
+    case Function::COUNT:
+        return count;
+    case Function::SUM:
+    case Function::MEAN: {
+        double sum = 0;
+        for (auto it = begin; it != end; ++it) {
+            sum += it->second;
+        }
+        return spec.function == Function::SUM ? sum : sum / count;
+    }
+    case Function::MIN:
+    case Function::MAX: {
+        double value = begin->second;
+        for (auto it = begin; it != end; ++it) {
+            value = spec.function == Function::MIN
+                    ? (std::min)(value, it->second)
+                    : (std::max)(value, it->second);
+        }
+        return value;
+    }
+    case Function::STDDEV: {
+        // Population standard deviation, two passes for accuracy
+        double sum = 0;
+        for (auto it = begin; it != end; ++it) {
+            sum += it->second;
+        }
+        double mean = sum / count;
+        double squares = 0;
+        for (auto it = begin; it != end; ++it) {
+            squares += (it->second - mean) * (it->second - mean);
+        }
+        return std::sqrt(squares / count);
+    }
+    default: {
+        std::vector<double> values;
+        values.reserve(end - begin);
+        for (auto it = begin; it != end; ++it) {
+            values.push_back(it->second);
+        }
+        return percentile(values, spec.percentile);
+    }
+    }
+}
+
+
+PyWindowedAggregator::PyWindowedAggregator(
+        const PyDataReader<DynamicData>& reader,
+        const std::vector<std::tuple<
+                py::object,
+                std::string,
+                dds::core::Duration>>& specs,
+        bool take,
+        const dds::core::optional<dds::core::Duration>& period,
+        py::object callback)
+        : _reader(reader),
+          _period(period),
+          _condition(dds::sub::cond::ReadCondition(
+                  reader,
+                  take ? dds::sub::status::DataState::any()
+                       : dds::sub::status::DataState(
+                               dds::sub::status::SampleState::not_read(),
+                               dds::sub::status::ViewState::any(),
+                               dds::sub::status::InstanceState::any()))),
+          _take(take),
+          _watermark((std::numeric_limits<int64_t>::min)()),
+          _sample_count(0),
+          _stop(std::make_shared<std::atomic<bool>>(false))
+{
+    if (specs.empty()) {
+        throw dds::core::InvalidArgumentError("no aggregates specified");
+    }
+    if (period.has_value() && period.value() <= dds::core::Duration::zero()) {
+        throw dds::core::InvalidArgumentError("period must be positive");
+    }
+    if (!callback.is_none() && !period.has_value()) {
+        throw dds::core::InvalidArgumentError("callback requires a period");
+    }
+
+    auto& type = reader.dynamic_type();
+    for (auto& s : specs) {
+        auto& path_obj = std::get<0>(s);
+        auto path = py::isinstance<PyDynamicDataPath>(path_obj)
+                ? py::cast<PyDynamicDataPath>(path_obj)
+                : PyDynamicDataPath::compile(
+                        type,
+                        py::cast<std::string>(path_obj));
+        if (!is_numeric_kind(path.last().kind)) {
+            throw py::type_error(
+                    "Only numeric, boolean and enum fields can be "
+                    "aggregated: " + path.path());
+        }
+        auto& window = std::get<2>(s);
+        if (window <= dds::core::Duration::zero()) {
+            throw dds::core::InvalidArgumentError(
+                    "window must be positive");
+        }
+
+        // Specs on the same path share the series of values
+        size_t series = 0;
+        while (series < this->_paths.size()
+               && this->_paths[series].path() != path.path()) {
+            ++series;
+        }
+        if (series == this->_paths.size()) {
+            this->_paths.push_back(path);
+            this->_horizons.push_back(0);
+        }
+        this->_horizons[series] =
+                (std::max)(this->_horizons[series], to_nanosecs(window));
+
+        Spec spec { path,
+                    std::get<1>(s),
+                    Function::COUNT,
+                    0,
+                    window,
+                    series };
+        parse_aggregate(spec);
+        this->_specs.push_back(spec);
+    }
+    this->_callback = callback;
+
+    this->_waitset.attach_condition(this->_condition);
+    this->_waitset.attach_condition(this->_wakeup);
+    this->_thread = std::thread(&PyWindowedAggregator::run, this);
+}
+
+
+PyWindowedAggregator::~PyWindowedAggregator()
+{
+    this->close();
+}
+
+
+std::vector<PyWindowedAggregator::Result> PyWindowedAggregator::results()
+{
+    std::vector<Result> retval;
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    auto it = this->_instances.begin();
+    while (it != this->_instances.end()) {
+        auto& instance = it->second;
+        this->evict(instance);
+        bool empty = true;
+        for (auto& series : instance.series) {
+            empty = empty && series.empty();
+        }
+        if (empty) {
+            it = this->_instances.erase(it);
+            continue;
+        }
+
+        for (auto& spec : this->_specs) {
+            auto& series = instance.series[spec.series];
+            int64_t start = this->_watermark - to_nanosecs(spec.window);
+            auto begin = std::lower_bound(
+                    series.cbegin(),
+                    series.cend(),
+                    std::make_pair(start, -std::numeric_limits<double>::infinity()));
+            if (begin == series.cend()) continue;
+            retval.push_back(Result { it->first,
+                                      spec.path.path(),
+                                      spec.aggregate,
+                                      spec.window,
+                                      aggregate(spec, begin, series.cend()),
+                                      static_cast<uint64_t>(
+                                              series.cend() - begin),
+                                      to_time(this->_watermark) });
+        }
+        ++it;
+    }
+    return retval;
+}
+
+
+uint64_t PyWindowedAggregator::sample_count()
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_sample_count;
+}
+
+
+void PyWindowedAggregator::close()
+{
+    if (this->_stop->exchange(true)) return;
+    this->_wakeup.trigger_value(true);
+    if (this->_thread.joinable()) {
+        if (this->_thread.get_id() == std::this_thread::get_id()) {
+            // Closed, and possibly destroyed, from the callback; the thread
+            // exits when the callback returns without using this object
+            this->_thread.detach();
+        } else if (PyGILState_Check()) {
+            py::gil_scoped_release release;
+            this->_thread.join();
+        } else {
+            this->_thread.join();
+        }
+    }
+    this->_waitset.detach_condition(this->_condition);
+}
+
+
+bool PyWindowedAggregator::closed()
+{
+    return this->_stop->load();
+}
+
+
+void PyWindowedAggregator::release_callback()
+{
+    this->_callback = py::object();
+}
+
+
+void PyWindowedAggregator::run()
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::duration period(0);
+    if (this->_period.has_value()) {
+        period = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::nanoseconds(to_nanosecs(this->_period.value())));
+    }
+    auto next = Clock::now() + period;
+    // The callback may close and destroy this aggregator
+    auto stop = this->_stop;
+    try {
+        while (true) {
+            if (period.count() > 0) {
+                auto now = Clock::now();
+                if (now >= next) {
+                    this->publish();
+                    if (stop->load()) return;
+                    next += period;
+                    // Don't try to catch up after a slow callback
+                    if (next < now) next = now + period;
+                    continue;
+                }
+                auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  next - now)
+                                  .count();
+                try {
+                    this->_waitset.wait(dds::core::Duration(
+                            static_cast<int32_t>(ns / 1000000000),
+                            static_cast<uint32_t>(ns % 1000000000)));
+                } catch (const dds::core::TimeoutError&) {
+                    // Time to publish
+                }
+            } else {
+                this->_waitset.wait();
+            }
+            if (this->closed()) return;
+            while (this->drain() > 0) {
+            }
+        }
+    } catch (const std::exception&) {
+        // The reader was closed
+    }
+}
+
+
+size_t PyWindowedAggregator::drain()
+{
+    auto selector = this->_reader.select()
+                            .condition(this->_condition)
+                            .max_samples(MAX_BATCH);
+    auto loaned = this->_take ? selector.take() : selector.read();
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    for (auto& sample : loaned) {
+        this->add(const_cast<DynamicData&>(sample.data()), sample.info());
+    }
+    return loaned.length();
+}
+
+
+void PyWindowedAggregator::add(
+        DynamicData& data,
+        const dds::sub::SampleInfo& info)
+{
+    auto handle = info.instance_handle();
+    if (!info.valid()) {
+        if (info.state().instance_state()
+            != dds::sub::status::InstanceState::alive()) {
+            this->_instances.erase(handle);
+        }
+        return;
+    }
+
+    ++this->_sample_count;
+    int64_t timestamp = to_nanosecs(info.source_timestamp());
+    this->_watermark = (std::max)(this->_watermark, timestamp);
+    auto& instance = this->_instances[handle];
+    instance.series.resize(this->_paths.size());
+    for (size_t i = 0; i < this->_paths.size(); ++i) {
+        if (timestamp < this->_watermark - this->_horizons[i]) {
+            // Too late for any window
+            continue;
+        }
+        double value;
+        try {
+            value = numeric_value(data, this->_paths[i]);
+        } catch (const std::exception&) {
+            // Union member not selected or index out of bounds
+            continue;
+        }
+        auto& series = instance.series[i];
+        auto entry = std::make_pair(timestamp, value);
+        if (series.empty() || series.back().first <= timestamp) {
+            series.push_back(entry);
+        } else {
+            // Keep the series sorted by source timestamp
+            series.insert(
+                    std::upper_bound(
+                            series.begin(),
+                            series.end(),
+                            entry,
+                            [](const std::pair<int64_t, double>& a,
+                               const std::pair<int64_t, double>& b) {
+                                return a.first < b.first;
+                            }),
+                    entry);
+        }
+    }
+    this->evict(instance);
+}
+
+
+void PyWindowedAggregator::evict(Instance& instance)
+{
+    for (size_t i = 0; i < instance.series.size(); ++i) {
+        auto& series = instance.series[i];
+        int64_t start = this->_watermark - this->_horizons[i];
+        while (!series.empty() && series.front().first < start) {
+            series.pop_front();
+        }
+    }
+}
+
+
+void PyWindowedAggregator::publish()
+{
+    auto results = this->results();
+    if (!Py_IsInitialized()) return;
+
+    py::gil_scoped_acquire acquire;
+    // Keeps the callback alive if it releases this aggregator
+    py::object callback = this->_callback;
+    if (!callback) return;
+    try {
+        callback(py::cast(std::move(results)));
+    } catch (py::error_already_set& e) {
+        e.restore();
+        PyErr_WriteUnraisable(callback.ptr());
+    } catch (std::exception& e) {
+        PyErr_SetString(PyExc_RuntimeError, e.what());
+        PyErr_WriteUnraisable(callback.ptr());
+    }
+}
+
+
+template<>
+void init_class_defs(
+        py::class_<
+                PyWindowedAggregator,
+                std::unique_ptr<
+                        PyWindowedAggregator,
+                        no_gil_delete<PyWindowedAggregator>>>& cls)
+{
+    py::class_<PyWindowedAggregator::Result>(cls, "Result")
+            .def_readonly(
+                    "instance_handle",
+                    &PyWindowedAggregator::Result::instance_handle,
+                    "The instance the aggregate was computed for.")
+            .def_readonly(
+                    "path",
+                    &PyWindowedAggregator::Result::path,
+                    "The field path of the aggregated values.")
+            .def_readonly(
+                    "aggregate",
+                    &PyWindowedAggregator::Result::aggregate,
+                    "The name of the aggregate.")
+            .def_readonly(
+                    "window",
+                    &PyWindowedAggregator::Result::window,
+                    "The length of the window.")
+            .def_readonly(
+                    "value",
+                    &PyWindowedAggregator::Result::value,
+                    "The value of the aggregate.")
+            .def_readonly(
+                    "count",
+                    &PyWindowedAggregator::Result::count,
+                    "The number of samples in the window.")
+            .def_readonly(
+                    "window_end",
+                    &PyWindowedAggregator::Result::window_end,
+                    "The source timestamp the window ends at.")
+            .def("__repr__", [](const PyWindowedAggregator::Result& r) {
+                return "WindowedAggregator.Result(" + r.path + ", "
+                        + r.aggregate + ", " + std::to_string(r.value) + ")";
+            });
+
+    cls.def(py::init([](const PyDataReader<DynamicData>& reader,
+                        const std::vector<std::tuple<
+                                py::object,
+                                std::string,
+                                dds::core::Duration>>& specs,
+                        bool take,
+                        const dds::core::optional<dds::core::Duration>& period,
+                        py::object callback) {
+                return new PyWindowedAggregator(
+                        reader,
+                        specs,
+                        take,
+                        period,
+                        callback);
+            }),
+            py::arg("reader"),
+            py::arg("specs"),
+            py::arg("take") = true,
+            py::arg("period") = py::none(),
+            py::arg("callback") = py::none(),
+            py::keep_alive<1, 2>(),
+            "Aggregate numeric fields of the samples received by a "
+            "DynamicData reader over sliding windows of source time, per "
+            "instance. Each spec is a (field path, aggregate, window) tuple "
+            "where the aggregate is count, sum, mean, min, max, stddev or a "
+            "percentile such as p50 or p99.9. When a period is given, the "
+            "callback receives the list of results once per period from a "
+            "native thread.")
+            .def("results",
+                 &PyWindowedAggregator::results,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Compute the aggregates of the current windows. Instances "
+                 "without samples in a window have no result for it.")
+            .def_property_readonly(
+                    "specs",
+                    [](const PyWindowedAggregator& a) {
+                        py::list specs;
+                        for (auto& spec : a.specs()) {
+                            specs.append(py::make_tuple(
+                                    spec.path.path(),
+                                    spec.aggregate,
+                                    spec.window));
+                        }
+                        return specs;
+                    },
+                    "The (field path, aggregate, window) specs.")
+            .def_property_readonly(
+                    "period",
+                    &PyWindowedAggregator::period,
+                    "The period of the callback, if any.")
+            .def_property_readonly(
+                    "sample_count",
+                    &PyWindowedAggregator::sample_count,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "The number of valid samples aggregated.")
+            .def("close",
+                 &PyWindowedAggregator::close,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Stop aggregating and calling the callback.")
+            .def_property_readonly(
+                    "closed",
+                    &PyWindowedAggregator::closed,
+                    py::call_guard<py::gil_scoped_release>(),
+                    "Whether this aggregator has been closed.")
+            .def(
+                    "__enter__",
+                    [](py::object self) { return self; },
+                    "Enter a context for this aggregator, to be closed on "
+                    "context exit.")
+            .def(
+                    "__exit__",
+                    [](PyWindowedAggregator& a,
+                       py::object,
+                       py::object,
+                       py::object) { a.close(); },
+                    "Exit the context for this aggregator, closing it.");
+}
+
+
+template<>
+void process_inits<PyWindowedAggregator>(py::module& m, ClassInitList& l)
+{
+    l.push_back([m]() mutable {
+        return init_class<
+                PyWindowedAggregator,
+                std::unique_ptr<
+                        PyWindowedAggregator,
+                        no_gil_delete<PyWindowedAggregator>>>(
+                m,
+                "WindowedAggregator");
+    });
+}
+
+}  // namespace pyrti
@@ -11,6 +11,8 @@
 
 #include "PyConnext.hpp"
 #include <dds/dds.hpp>
+#include "PyDynamicDataPath.hpp"
+#include "PyWindowedAggregator.hpp"
 
 using namespace dds::core::xtypes;
 
@@ -20,6 +22,7 @@ void init_namespace_dds_core_xtypes(py::module& m, pyrti::ClassInitList& l, pyrt
     pyrti::process_inits<ArrayType>(m, l);
     pyrti::process_inits<CollectionType>(m, l);
     pyrti::process_inits<DynamicData>(m, l);
+    pyrti::process_inits<pyrti::PyDynamicDataPath>(m, l);
     pyrti::process_inits<DynamicType>(m, l);
     pyrti::process_inits<EnumMember>(m, l);
     pyrti::process_inits<EnumType>(m, l);
@@ -33,4 +36,5 @@ void init_namespace_dds_core_xtypes(py::module& m, pyrti::ClassInitList& l, pyrt
     pyrti::process_inits<UnionMember>(m, l);
     pyrti::process_inits<UnionType>(m, l);
     pyrti::process_inits<WStringType>(m, l);
+    pyrti::process_inits<pyrti::PyWindowedAggregator>(m, l);
 }
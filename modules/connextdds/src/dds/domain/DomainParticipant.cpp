@@ -16,6 +16,7 @@
 #include "PyAnyDataReader.hpp"
 #include "PyDataReader.hpp"
 #include "PyDomainParticipantListener.hpp"
+#include "PyAsyncioExecutor.hpp"
 #include <rti/rti.hpp>
 
 using namespace dds::domain;
@@ -76,6 +77,7 @@ void PyDomainParticipant::py_destroy_managed_resources()
                     py::cast(listener_ptr).dec_ref();
                 }
             }
+            PyAsyncioExecutor::participant_pool(*this, nullptr);
         }
     }
     {
@@ -96,6 +98,7 @@ void PyDomainParticipant::py_close()
             py::cast(listener_ptr).dec_ref();
         }
     }
+    PyAsyncioExecutor::participant_pool(*this, nullptr);
     this->close();
 }
 
@@ -570,6 +573,18 @@ void init_class_defs(
                         return dp->participant_protocol_status();
                     },
                     "Get the protocol status for this participant")
+            .def_property(
+                    "executor_pool",
+                    [](PyDomainParticipant& dp) {
+                        return PyAsyncioExecutor::participant_pool(dp);
+                    },
+                    [](PyDomainParticipant& dp,
+                       std::shared_ptr<PyExecutorPool> pool) {
+                        PyAsyncioExecutor::participant_pool(dp, pool);
+                    },
+                    "The ExecutorPool used by the *_async methods of this "
+                    "participant's DataReaders and DataWriters, or None to "
+                    "use ExecutorPool.default.")
             .def_property_static(
                     "participant_factory_qos",
                     [](py::object&) {
@@ -19,7 +19,10 @@ namespace pyrti {
 template<>
 void init_class_defs(py::class_<SampleInfo>& cls)
 {
-    cls.def_property_readonly(
+    cls.def(py::init<>(),
+            "Create an empty SampleInfo, to be filled by "
+            "DataReader.take_next_into() and similar methods.")
+            .def_property_readonly(
                "source_timestamp",
                &SampleInfo::source_timestamp,
                "The DataWriter's write timestamp.")
@@ -10,11 +10,336 @@
  */
 
 #include "PyAsyncioExecutor.hpp"
+#include <algorithm>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
 
 namespace pyrti {
 
+std::mutex PyExecutorPool::_pools_lock;
+std::vector<PyExecutorPool*> PyExecutorPool::_pools;
+
+PyExecutorPool::PyExecutorPool(
+        size_t thread_count,
+        const std::string& name_prefix,
+        const std::vector<int32_t>& cpu_list)
+        : _thread_count(
+                thread_count > 0 ? thread_count
+                                 : PyExecutorPool::default_thread_count()),
+          _name_prefix(name_prefix),
+          _cpu_list(cpu_list),
+          _state(std::make_shared<State>())
+{
+    for (auto cpu : cpu_list) {
+        if (cpu < 0) {
+            throw dds::core::InvalidArgumentError("invalid CPU index");
+        }
+    }
+    this->_state->closed = false;
+    this->_state->metrics = Metrics();
+    {
+        std::lock_guard<std::mutex> guard(PyExecutorPool::_pools_lock);
+        PyExecutorPool::_pools.push_back(this);
+    }
+    for (size_t i = 0; i < this->_thread_count; ++i) {
+        this->_threads.emplace_back(
+                &PyExecutorPool::worker,
+                this->_state,
+                this->_name_prefix + std::to_string(i),
+                this->_cpu_list);
+    }
+}
+
+
+PyExecutorPool::~PyExecutorPool()
+{
+    this->close();
+    std::lock_guard<std::mutex> guard(PyExecutorPool::_pools_lock);
+    auto& pools = PyExecutorPool::_pools;
+    pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+}
+
+
+void PyExecutorPool::submit(
+        std::function<void()> task,
+        std::function<void()> cancel)
+{
+    auto& state = *this->_state;
+    {
+        std::lock_guard<std::mutex> guard(state.mutex);
+        if (state.closed) {
+            throw dds::core::AlreadyClosedError("executor pool is closed");
+        }
+        state.queue.push_back(
+                Task { std::move(task), std::move(cancel), Clock::now() });
+        ++state.metrics.submitted;
+        state.metrics.queue_depth = state.queue.size();
+        state.metrics.max_queue_depth = (std::max)(
+                state.metrics.max_queue_depth,
+                state.metrics.queue_depth);
+    }
+    state.cv.notify_one();
+}
+
+
+void PyExecutorPool::close()
+{
+    auto& state = *this->_state;
+    std::deque<Task> discarded;
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> guard(state.mutex);
+        if (state.closed) {
+            return;
+        }
+        state.closed = true;
+        discarded.swap(state.queue);
+        threads.swap(this->_threads);
+        state.metrics.queue_depth = 0;
+    }
+    state.cv.notify_all();
+
+    // Running tasks need the GIL to complete their futures
+    std::unique_ptr<py::gil_scoped_release> release;
+    if (PyGILState_Check()) {
+        release.reset(new py::gil_scoped_release());
+    }
+    for (auto& thread : threads) {
+        if (thread.get_id() == std::this_thread::get_id()) {
+            // Closed by one of its own tasks; the thread only uses the
+            // shared state and exits once the task returns
+            thread.detach();
+        } else {
+            thread.join();
+        }
+    }
+    // The tasks acquire the GIL to cancel their futures and release their
+    // Python objects
+    for (auto& task : discarded) {
+        if (task.cancel) {
+            task.cancel();
+        }
+    }
+    discarded.clear();
+}
+
+
+bool PyExecutorPool::closed() const
+{
+    std::lock_guard<std::mutex> guard(this->_state->mutex);
+    return this->_state->closed;
+}
+
+
+PyExecutorPool::Metrics PyExecutorPool::metrics() const
+{
+    std::lock_guard<std::mutex> guard(this->_state->mutex);
+    return this->_state->metrics;
+}
+
+
+void PyExecutorPool::reset_metrics()
+{
+    auto& state = *this->_state;
+    std::lock_guard<std::mutex> guard(state.mutex);
+    auto queue_depth = state.metrics.queue_depth;
+    state.metrics = Metrics();
+    state.metrics.queue_depth = queue_depth;
+    state.metrics.max_queue_depth = queue_depth;
+}
+
+
+size_t PyExecutorPool::default_thread_count()
+{
+    // Same sizing as the asyncio default executor
+    size_t cpus = std::thread::hardware_concurrency();
+    return (std::min)(static_cast<size_t>(32), (cpus > 0 ? cpus : 1) + 4);
+}
+
+
+void PyExecutorPool::close_all()
+{
+    std::vector<PyExecutorPool*> pools;
+    {
+        std::lock_guard<std::mutex> guard(PyExecutorPool::_pools_lock);
+        pools = PyExecutorPool::_pools;
+    }
+    for (auto pool : pools) {
+        pool->close();
+    }
+}
+
+
+void PyExecutorPool::worker(
+        std::shared_ptr<State> state,
+        std::string name,
+        std::vector<int32_t> cpu_list)
+{
+    PyExecutorPool::configure_current_thread(name, cpu_list);
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> guard(state->mutex);
+            state->cv.wait(guard, [&state]() {
+                return state->closed || !state->queue.empty();
+            });
+            if (state->closed) {
+                return;
+            }
+            task = std::move(state->queue.front());
+            state->queue.pop_front();
+            state->metrics.queue_depth = state->queue.size();
+        }
+        auto start = Clock::now();
+        task.func();
+        task.func = nullptr;
+        task.cancel = nullptr;
+        auto end = Clock::now();
+
+        auto queue_latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                start - task.submitted);
+        auto run_time =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        std::lock_guard<std::mutex> guard(state->mutex);
+        auto& metrics = state->metrics;
+        ++metrics.completed;
+        metrics.total_queue_latency += queue_latency;
+        metrics.max_queue_latency =
+                (std::max)(metrics.max_queue_latency, queue_latency);
+        metrics.total_run_time += run_time;
+        metrics.max_run_time = (std::max)(metrics.max_run_time, run_time);
+    }
+}
+
+
+void PyExecutorPool::configure_current_thread(
+        const std::string& name,
+        const std::vector<int32_t>& cpu_list)
+{
+#if defined(_WIN32)
+    if (!cpu_list.empty()) {
+        DWORD_PTR mask = 0;
+        for (auto cpu : cpu_list) {
+            if (cpu < static_cast<int32_t>(sizeof(DWORD_PTR) * 8)) {
+                mask |= static_cast<DWORD_PTR>(1) << cpu;
+            }
+        }
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
+#elif defined(__APPLE__)
+    // Thread affinity is not available on macOS
+    pthread_setname_np(name.substr(0, 63).c_str());
+#else
+    // Linux limits names to 15 characters
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    if (!cpu_list.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto cpu : cpu_list) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+}
+
+
+PyAsyncioCall::PyAsyncioCall(
+        py::object loop,
+        py::object future,
+        py::object call)
+        : _loop(std::move(loop)),
+          _future(std::move(future)),
+          _call(std::move(call))
+{
+}
+
+
+PyAsyncioCall::~PyAsyncioCall()
+{
+    if (this->_loop || this->_future || this->_call) {
+        py::gil_scoped_acquire acquire;
+        this->_loop = py::object();
+        this->_future = py::object();
+        this->_call = py::object();
+    }
+}
+
+
+static void complete_future(py::object future, py::object result, py::object error)
+{
+    // The awaiting task may have been cancelled in the meantime
+    if (future.attr("done")().cast<bool>()) {
+        return;
+    }
+    if (!error.is_none()) {
+        future.attr("set_exception")(error);
+    } else {
+        future.attr("set_result")(result);
+    }
+}
+
+
+void PyAsyncioCall::run()
+{
+    py::gil_scoped_acquire acquire;
+    py::object result = py::none();
+    py::object error = py::none();
+    try {
+        result = this->_call();
+    } catch (py::error_already_set& e) {
+        e.restore();
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        PyErr_NormalizeException(&type, &value, &traceback);
+        if (traceback != nullptr) {
+            PyException_SetTraceback(value, traceback);
+        }
+        error = py::reinterpret_steal<py::object>(value);
+        Py_XDECREF(type);
+        Py_XDECREF(traceback);
+    }
+    try {
+        this->_loop.attr("call_soon_threadsafe")(
+                py::cpp_function(&complete_future),
+                this->_future,
+                result,
+                error);
+    } catch (py::error_already_set&) {
+        // The event loop was closed before the call completed
+    }
+    this->_loop = py::object();
+    this->_future = py::object();
+    this->_call = py::object();
+}
+
+
+void PyAsyncioCall::cancel()
+{
+    if (!Py_IsInitialized()) {
+        return;
+    }
+    py::gil_scoped_acquire acquire;
+    try {
+        // The awaiting coroutine gets a CancelledError
+        this->_loop.attr("call_soon_threadsafe")(this->_future.attr("cancel"));
+    } catch (py::error_already_set&) {
+        // The event loop is already closed
+    }
+    this->_loop = py::object();
+    this->_future = py::object();
+    this->_call = py::object();
+}
+
+
 std::unique_ptr<PyAsyncioExecutor> PyAsyncioExecutor::instance(nullptr);
 std::recursive_mutex PyAsyncioExecutor::lock;
+std::atomic<size_t> PyAsyncioExecutor::participant_pool_count(0);
 
 PyAsyncioExecutor::PyAsyncioExecutor()
 {
@@ -31,6 +356,8 @@ PyAsyncioExecutor& PyAsyncioExecutor::get_instance()
         PyAsyncioExecutor::instance->asyncio = asyncio_module;
         PyAsyncioExecutor::instance->get_running_loop = get_running_loop_func;
         atexit.attr("register")(py::cpp_function([]() {
+            PyExecutorPool::close_all();
+            PyAsyncioExecutor::participant_pool_count = 0;
             auto ptr = PyAsyncioExecutor::instance.release();
             delete ptr;
         }));
@@ -38,4 +365,68 @@ PyAsyncioExecutor& PyAsyncioExecutor::get_instance()
     return *PyAsyncioExecutor::instance;
 }
 
-}  // namespace pyrti
\ No newline at end of file
+
+std::shared_ptr<PyExecutorPool> PyAsyncioExecutor::default_pool()
+{
+    std::lock_guard<std::recursive_mutex> lock(PyAsyncioExecutor::lock);
+    auto& instance = PyAsyncioExecutor::get_instance();
+    if (!instance._default_pool) {
+        instance._default_pool = std::make_shared<PyExecutorPool>(
+                PyExecutorPool::default_thread_count(),
+                "rtiasync",
+                std::vector<int32_t>());
+    }
+    return instance._default_pool;
+}
+
+
+void PyAsyncioExecutor::default_pool(std::shared_ptr<PyExecutorPool> pool)
+{
+    std::shared_ptr<PyExecutorPool> previous;
+    {
+        std::lock_guard<std::recursive_mutex> lock(PyAsyncioExecutor::lock);
+        auto& instance = PyAsyncioExecutor::get_instance();
+        previous.swap(instance._default_pool);
+        instance._default_pool = pool;
+    }
+}
+
+
+std::shared_ptr<PyExecutorPool> PyAsyncioExecutor::participant_pool(
+        const dds::domain::DomainParticipant& participant)
+{
+    if (PyAsyncioExecutor::participant_pool_count.load() == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::recursive_mutex> lock(PyAsyncioExecutor::lock);
+    auto& pools = PyAsyncioExecutor::get_instance()._participant_pools;
+    auto it = pools.find(participant.delegate().get());
+    return it != pools.end() ? it->second : nullptr;
+}
+
+
+void PyAsyncioExecutor::participant_pool(
+        const dds::domain::DomainParticipant& participant,
+        std::shared_ptr<PyExecutorPool> pool)
+{
+    if (!pool && PyAsyncioExecutor::participant_pool_count.load() == 0) {
+        return;
+    }
+    std::shared_ptr<PyExecutorPool> previous;
+    {
+        std::lock_guard<std::recursive_mutex> lock(PyAsyncioExecutor::lock);
+        auto& pools = PyAsyncioExecutor::get_instance()._participant_pools;
+        const void* key = participant.delegate().get();
+        auto it = pools.find(key);
+        if (it != pools.end()) {
+            previous.swap(it->second);
+            pools.erase(it);
+        }
+        if (pool) {
+            pools[key] = pool;
+        }
+        PyAsyncioExecutor::participant_pool_count = pools.size();
+    }
+}
+
+}  // namespace pyrti
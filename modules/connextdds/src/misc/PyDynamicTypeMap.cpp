@@ -13,7 +13,9 @@
 
 namespace pyrti {
 
-std::unordered_map<std::string, dds::core::xtypes::DynamicType>
-        PyDynamicTypeMap::type_map;
+std::shared_ptr<const PyDynamicTypeMap::TypeMap> PyDynamicTypeMap::type_map =
+        std::make_shared<const PyDynamicTypeMap::TypeMap>();
+
+std::mutex PyDynamicTypeMap::write_mutex;
 
 }
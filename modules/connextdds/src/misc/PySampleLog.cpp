@@ -0,0 +1,480 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#include "PySampleLog.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pyrti {
+
+static const char LOG_MAGIC[8] = { 'R', 'T', 'I', 'P', 'Y', 'L', 'O', 'G' };
+static const char INDEX_MAGIC[8] = { 'R', 'T', 'I', 'P', 'Y', 'I', 'D', 'X' };
+static const uint32_t LOG_VERSION = 1;
+
+struct PySampleLogIndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t record_count;
+};
+
+
+static size_t align8(size_t size)
+{
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+
+static std::string index_path(const std::string& path)
+{
+    return path + ".idx";
+}
+
+
+static dds::core::Error log_error(
+        const std::string& message,
+        const std::string& path)
+{
+    return dds::core::Error(
+            message + " " + path + ": " + std::strerror(errno));
+}
+
+
+PySampleLogWriter::PySampleLogWriter(
+        const std::string& path,
+        const std::string& type_name,
+        const std::vector<std::string>& streams,
+        size_t initial_size)
+        : _path(path), _fd(-1), _map(nullptr), _capacity(0), _end(0)
+{
+#ifdef _WIN32
+    throw dds::core::UnsupportedError(
+            "Sample logs are not supported on this platform");
+#else
+    size_t metadata = type_name.size() + 1;
+    for (auto& stream : streams) {
+        metadata += stream.size() + 1;
+    }
+    size_t data_offset = align8(sizeof(PySampleLogHeader) + metadata);
+
+    // An index left by a previous log at the same path no longer applies
+    ::unlink(index_path(path).c_str());
+    this->_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (this->_fd < 0) {
+        throw log_error("Failed to create sample log", path);
+    }
+    try {
+        this->reserve((std::max)(initial_size, data_offset));
+    } catch (...) {
+        ::close(this->_fd);
+        this->_fd = -1;
+        throw;
+    }
+
+    auto header = this->header();
+    std::memset(header, 0, sizeof(PySampleLogHeader));
+    std::memcpy(header->magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+    header->version = LOG_VERSION;
+    header->stream_count = static_cast<uint32_t>(streams.size());
+    header->data_offset = data_offset;
+    char* names = this->_map + sizeof(PySampleLogHeader);
+    std::memcpy(names, type_name.c_str(), type_name.size() + 1);
+    names += type_name.size() + 1;
+    for (auto& stream : streams) {
+        std::memcpy(names, stream.c_str(), stream.size() + 1);
+        names += stream.size() + 1;
+    }
+    header->end = data_offset;
+    header->record_count = 0;
+    this->_end = data_offset;
+#endif
+}
+
+
+PySampleLogWriter::~PySampleLogWriter()
+{
+    try {
+        this->close();
+    } catch (const std::exception&) {
+        // The index can be rebuilt from the log
+    }
+}
+
+
+void PySampleLogWriter::reserve(size_t size)
+{
+#ifndef _WIN32
+    if (size <= this->_capacity) return;
+    size_t capacity = (std::max)(this->_capacity, static_cast<size_t>(4096));
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    if (this->_map != nullptr) {
+        ::munmap(this->_map, this->_capacity);
+        this->_map = nullptr;
+    }
+    if (::ftruncate(this->_fd, static_cast<off_t>(capacity)) != 0) {
+        throw log_error("Failed to extend sample log", this->_path);
+    }
+    void* map = ::mmap(
+            nullptr,
+            capacity,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED,
+            this->_fd,
+            0);
+    if (map == MAP_FAILED) {
+        throw log_error("Failed to map sample log", this->_path);
+    }
+    this->_map = static_cast<char*>(map);
+    this->_capacity = capacity;
+#endif
+}
+
+
+void PySampleLogWriter::append(PySampleLogRecord& record, const char* data)
+{
+    if (this->_map == nullptr) {
+        throw dds::core::AlreadyClosedError("sample log is closed");
+    }
+    uint64_t offset = this->header()->end;
+    record.size = static_cast<uint32_t>(
+            align8(sizeof(PySampleLogRecord) + record.data_length));
+    this->reserve(offset + record.size);
+
+    char* destination = this->_map + offset;
+    std::memcpy(destination, &record, sizeof(PySampleLogRecord));
+    if (record.data_length > 0) {
+        std::memcpy(
+                destination + sizeof(PySampleLogRecord),
+                data,
+                record.data_length);
+    }
+    size_t padding = record.size - sizeof(PySampleLogRecord)
+            - record.data_length;
+    std::memset(
+            destination + sizeof(PySampleLogRecord) + record.data_length,
+            0,
+            padding);
+
+    // Publish the record only once it's complete
+    std::atomic_thread_fence(std::memory_order_release);
+    this->header()->end = offset + record.size;
+    this->header()->record_count++;
+    this->_end = offset + record.size;
+
+    this->_time_index.push_back(TimeEntry { record.source_timestamp, offset });
+    InstanceEntry entry;
+    std::memcpy(entry.key_hash, record.key_hash, sizeof(entry.key_hash));
+    entry.timestamp = record.source_timestamp;
+    entry.offset = offset;
+    this->_instance_index.push_back(entry);
+}
+
+
+void PySampleLogWriter::sync()
+{
+#ifndef _WIN32
+    if (this->_map == nullptr) return;
+    if (::msync(this->_map, this->_end, MS_SYNC) != 0) {
+        throw log_error("Failed to flush sample log", this->_path);
+    }
+#endif
+}
+
+
+void PySampleLogWriter::close()
+{
+#ifndef _WIN32
+    if (this->_map == nullptr) return;
+    uint64_t end = this->_end;
+    ::munmap(this->_map, this->_capacity);
+    this->_map = nullptr;
+    this->_capacity = 0;
+    int result = ::ftruncate(this->_fd, static_cast<off_t>(end));
+    ::close(this->_fd);
+    this->_fd = -1;
+    if (result != 0) {
+        throw log_error("Failed to truncate sample log", this->_path);
+    }
+    this->write_index();
+#endif
+}
+
+
+uint64_t PySampleLogWriter::record_count() const
+{
+    return this->_time_index.size();
+}
+
+
+uint64_t PySampleLogWriter::size() const
+{
+    return this->_end;
+}
+
+
+static bool operator<(
+        const PySampleLogWriter::TimeEntry& a,
+        const PySampleLogWriter::TimeEntry& b)
+{
+    return a.timestamp != b.timestamp ? a.timestamp < b.timestamp
+                                      : a.offset < b.offset;
+}
+
+
+static bool operator<(
+        const PySampleLogWriter::InstanceEntry& a,
+        const PySampleLogWriter::InstanceEntry& b)
+{
+    int key = std::memcmp(a.key_hash, b.key_hash, sizeof(a.key_hash));
+    if (key != 0) return key < 0;
+    return a.timestamp != b.timestamp ? a.timestamp < b.timestamp
+                                      : a.offset < b.offset;
+}
+
+
+void PySampleLogWriter::write_index()
+{
+    std::sort(this->_time_index.begin(), this->_time_index.end());
+    std::sort(this->_instance_index.begin(), this->_instance_index.end());
+
+    PySampleLogIndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = LOG_VERSION;
+    header.record_count = this->_time_index.size();
+
+    std::ofstream out(index_path(this->_path), std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(
+            reinterpret_cast<const char*>(this->_time_index.data()),
+            this->_time_index.size() * sizeof(TimeEntry));
+    out.write(
+            reinterpret_cast<const char*>(this->_instance_index.data()),
+            this->_instance_index.size() * sizeof(InstanceEntry));
+    if (!out) {
+        throw log_error("Failed to write sample log index", this->_path);
+    }
+}
+
+
+PySampleLogReader::PySampleLogReader(const std::string& path)
+        : _map(nullptr), _size(0)
+{
+#ifdef _WIN32
+    throw dds::core::UnsupportedError(
+            "Sample logs are not supported on this platform");
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw log_error("Failed to open sample log", path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw log_error("Failed to open sample log", path);
+    }
+    this->_size = static_cast<size_t>(st.st_size);
+    if (this->_size < sizeof(PySampleLogHeader)) {
+        ::close(fd);
+        throw dds::core::InvalidArgumentError("not a sample log: " + path);
+    }
+    void* map = ::mmap(nullptr, this->_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw log_error("Failed to map sample log", path);
+    }
+    this->_map = static_cast<const char*>(map);
+
+    PySampleLogHeader header;
+    std::memcpy(&header, this->_map, sizeof(header));
+    if (std::memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0
+        || header.version != LOG_VERSION || header.data_offset > this->_size
+        || header.data_offset < sizeof(PySampleLogHeader)) {
+        ::munmap(const_cast<char*>(this->_map), this->_size);
+        throw dds::core::InvalidArgumentError("not a sample log: " + path);
+    }
+
+    const char* names = this->_map + sizeof(PySampleLogHeader);
+    const char* names_end = this->_map + header.data_offset;
+    std::vector<std::string> strings;
+    while (names < names_end && *names != '\0'
+           && strings.size() <= header.stream_count) {
+        strings.push_back(std::string(names));
+        names += strings.back().size() + 1;
+    }
+    if (strings.size() != header.stream_count + 1) {
+        ::munmap(const_cast<char*>(this->_map), this->_size);
+        throw dds::core::InvalidArgumentError("corrupt sample log: " + path);
+    }
+    this->_type_name = strings[0];
+    this->_streams.assign(strings.begin() + 1, strings.end());
+
+    uint64_t end = (std::min)(header.end, static_cast<uint64_t>(this->_size));
+    if (!this->read_index(
+                path,
+                header.record_count,
+                header.data_offset,
+                end)) {
+        this->build_index(header.data_offset, end);
+    }
+#endif
+}
+
+
+PySampleLogReader::~PySampleLogReader()
+{
+#ifndef _WIN32
+    if (this->_map != nullptr) {
+        ::munmap(const_cast<char*>(this->_map), this->_size);
+    }
+#endif
+}
+
+
+bool PySampleLogReader::read_index(
+        const std::string& path,
+        uint64_t record_count,
+        uint64_t data_offset,
+        uint64_t end)
+{
+    if (end < data_offset
+        || record_count > (end - data_offset) / sizeof(PySampleLogRecord)) {
+        return false;
+    }
+    std::ifstream in(index_path(path), std::ios::binary);
+    if (!in) return false;
+    PySampleLogIndexHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0
+        || header.version != LOG_VERSION
+        || header.record_count != record_count) {
+        return false;
+    }
+    this->_time_index.resize(record_count);
+    this->_instance_index.resize(record_count);
+    in.read(reinterpret_cast<char*>(this->_time_index.data()),
+            record_count * sizeof(TimeEntry));
+    in.read(reinterpret_cast<char*>(this->_instance_index.data()),
+            record_count * sizeof(InstanceEntry));
+    // The index is a separate file, so it may not belong to this log
+    bool valid = static_cast<bool>(in)
+            && std::is_sorted(
+                    this->_time_index.begin(),
+                    this->_time_index.end())
+            && std::is_sorted(
+                    this->_instance_index.begin(),
+                    this->_instance_index.end());
+    for (size_t i = 0; valid && i < record_count; ++i) {
+        auto& time_entry = this->_time_index[i];
+        auto& instance_entry = this->_instance_index[i];
+        valid = this->valid_record(time_entry.offset, data_offset, end)
+                && this->record(time_entry.offset).source_timestamp
+                        == time_entry.timestamp
+                && this->valid_record(instance_entry.offset, data_offset, end)
+                && this->record(instance_entry.offset).source_timestamp
+                        == instance_entry.timestamp;
+    }
+    if (!valid) {
+        this->_time_index.clear();
+        this->_instance_index.clear();
+        return false;
+    }
+    return true;
+}
+
+
+void PySampleLogReader::build_index(uint64_t data_offset, uint64_t end)
+{
+    uint64_t offset = data_offset;
+    // Stop at a record that wasn't completely written
+    while (this->valid_record(offset, data_offset, end)) {
+        auto& record = this->record(offset);
+        this->_time_index.push_back(
+                TimeEntry { record.source_timestamp, offset });
+        InstanceEntry entry;
+        std::memcpy(entry.key_hash, record.key_hash, sizeof(entry.key_hash));
+        entry.timestamp = record.source_timestamp;
+        entry.offset = offset;
+        this->_instance_index.push_back(entry);
+        offset += record.size;
+    }
+    std::sort(this->_time_index.begin(), this->_time_index.end());
+    std::sort(this->_instance_index.begin(), this->_instance_index.end());
+}
+
+
+bool PySampleLogReader::valid_record(
+        uint64_t offset,
+        uint64_t data_offset,
+        uint64_t end) const
+{
+    if (offset < data_offset || offset > end || offset % 8 != 0
+        || end - offset < sizeof(PySampleLogRecord)) {
+        return false;
+    }
+    auto& record = this->record(offset);
+    return record.size >= sizeof(PySampleLogRecord) && record.size % 8 == 0
+            && record.size <= end - offset
+            && record.data_length <= record.size - sizeof(PySampleLogRecord);
+}
+
+
+std::vector<uint64_t> PySampleLogReader::by_time(
+        int64_t start,
+        int64_t end) const
+{
+    std::vector<uint64_t> offsets;
+    auto it = std::lower_bound(
+            this->_time_index.begin(),
+            this->_time_index.end(),
+            TimeEntry { start, 0 });
+    for (; it != this->_time_index.end() && it->timestamp < end; ++it) {
+        offsets.push_back(it->offset);
+    }
+    return offsets;
+}
+
+
+std::vector<uint64_t> PySampleLogReader::by_instance(
+        const uint8_t* key_hash,
+        int64_t start,
+        int64_t end) const
+{
+    std::vector<uint64_t> offsets;
+    InstanceEntry first;
+    std::memcpy(first.key_hash, key_hash, sizeof(first.key_hash));
+    first.timestamp = start;
+    first.offset = 0;
+    auto it = std::lower_bound(
+            this->_instance_index.begin(),
+            this->_instance_index.end(),
+            first);
+    for (; it != this->_instance_index.end()
+         && std::memcmp(it->key_hash, key_hash, sizeof(it->key_hash)) == 0
+         && it->timestamp < end;
+         ++it) {
+        offsets.push_back(it->offset);
+    }
+    return offsets;
+}
+
+}  // namespace pyrti
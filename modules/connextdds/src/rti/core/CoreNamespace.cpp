@@ -11,6 +11,7 @@
 
 #include "PyConnext.hpp"
 #include "PyNamespaces.hpp"
+#include "PyAsyncioExecutor.hpp"
 #include <rti/rti.hpp>
 
 using namespace rti::core;
@@ -23,6 +24,7 @@ void init_namespace_rti_core(py::module& m, pyrti::ClassInitList& l, pyrti::DefI
     pyrti::process_inits<ContentFilterProperty>(m, l);
     pyrti::process_inits<Cookie>(m, l);
     pyrti::process_inits<EndpointGroup>(m, l);
+    pyrti::process_inits<pyrti::PyExecutorPool>(m, l);
     pyrti::process_inits<Guid>(m, l);
     pyrti::process_inits<Locator>(m, l);
     pyrti::process_inits<LocatorFilterElement>(m, l);
@@ -0,0 +1,169 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#include "PyConnext.hpp"
+#include "PyAsyncioExecutor.hpp"
+
+namespace pyrti {
+
+static dds::core::Duration to_duration(std::chrono::nanoseconds ns)
+{
+    auto count = ns.count();
+    return dds::core::Duration(
+            static_cast<int32_t>(count / 1000000000),
+            static_cast<uint32_t>(count % 1000000000));
+}
+
+
+static dds::core::Duration mean_duration(
+        std::chrono::nanoseconds total,
+        uint64_t count)
+{
+    if (count == 0) {
+        return dds::core::Duration::zero();
+    }
+    return to_duration(std::chrono::nanoseconds(
+            total.count() / static_cast<int64_t>(count)));
+}
+
+
+template<>
+void init_class_defs(
+        py::class_<PyExecutorPool, std::shared_ptr<PyExecutorPool>>& cls)
+{
+    py::class_<PyExecutorPool::Metrics>(cls, "Metrics")
+            .def_readonly(
+                    "queue_depth",
+                    &PyExecutorPool::Metrics::queue_depth,
+                    "Number of tasks waiting for a thread.")
+            .def_readonly(
+                    "max_queue_depth",
+                    &PyExecutorPool::Metrics::max_queue_depth,
+                    "Highest number of tasks that waited for a thread at the "
+                    "same time.")
+            .def_readonly(
+                    "submitted",
+                    &PyExecutorPool::Metrics::submitted,
+                    "Number of tasks submitted.")
+            .def_readonly(
+                    "completed",
+                    &PyExecutorPool::Metrics::completed,
+                    "Number of tasks completed.")
+            .def_property_readonly(
+                    "total_queue_latency",
+                    [](const PyExecutorPool::Metrics& m) {
+                        return to_duration(m.total_queue_latency);
+                    },
+                    "Total time completed tasks waited for a thread.")
+            .def_property_readonly(
+                    "max_queue_latency",
+                    [](const PyExecutorPool::Metrics& m) {
+                        return to_duration(m.max_queue_latency);
+                    },
+                    "Longest time a task waited for a thread.")
+            .def_property_readonly(
+                    "mean_queue_latency",
+                    [](const PyExecutorPool::Metrics& m) {
+                        return mean_duration(
+                                m.total_queue_latency,
+                                m.completed);
+                    },
+                    "Average time a task waited for a thread.")
+            .def_property_readonly(
+                    "total_run_time",
+                    [](const PyExecutorPool::Metrics& m) {
+                        return to_duration(m.total_run_time);
+                    },
+                    "Total time spent running completed tasks.")
+            .def_property_readonly(
+                    "max_run_time",
+                    [](const PyExecutorPool::Metrics& m) {
+                        return to_duration(m.max_run_time);
+                    },
+                    "Longest time spent running a task.")
+            .def_property_readonly(
+                    "mean_run_time",
+                    [](const PyExecutorPool::Metrics& m) {
+                        return mean_duration(m.total_run_time, m.completed);
+                    },
+                    "Average time spent running a task.");
+
+    cls.def(py::init([](size_t thread_count,
+                        const std::string& name_prefix,
+                        const std::vector<int32_t>& cpu_list) {
+                return std::make_shared<PyExecutorPool>(
+                        thread_count,
+                        name_prefix,
+                        cpu_list);
+            }),
+            py::arg("thread_count") = 0,
+            py::arg("name_prefix") = "rtiasync",
+            py::arg_v("cpu_list", std::vector<int32_t>(), "[]"),
+            "Create a pool of threads to run the blocking part of the "
+            "*_async methods. A thread_count of 0 selects the same size as "
+            "the asyncio default executor. The threads are named "
+            "name_prefix followed by their index and, when cpu_list is not "
+            "empty, restricted to those CPUs where the platform allows it.")
+            .def_property_readonly(
+                    "thread_count",
+                    &PyExecutorPool::thread_count,
+                    "The number of threads in the pool.")
+            .def_property_readonly(
+                    "name_prefix",
+                    &PyExecutorPool::name_prefix,
+                    "The prefix of the thread names.")
+            .def_property_readonly(
+                    "cpu_list",
+                    &PyExecutorPool::cpu_list,
+                    "The CPUs the threads are restricted to.")
+            .def_property_readonly(
+                    "metrics",
+                    &PyExecutorPool::metrics,
+                    "A snapshot of the queue depth and task latency "
+                    "metrics.")
+            .def("reset_metrics",
+                 &PyExecutorPool::reset_metrics,
+                 "Reset the counters and latency metrics.")
+            .def("close",
+                 &PyExecutorPool::close,
+                 py::call_guard<py::gil_scoped_release>(),
+                 "Stop the threads after the running tasks complete. The "
+                 "futures of the queued tasks are cancelled.")
+            .def_property_readonly(
+                    "closed",
+                    &PyExecutorPool::closed,
+                    "Whether this pool has been closed.")
+            .def_property_static(
+                    "default",
+                    [](py::object&) {
+                        return PyAsyncioExecutor::default_pool();
+                    },
+                    [](py::object&, std::shared_ptr<PyExecutorPool> pool) {
+                        PyAsyncioExecutor::default_pool(pool);
+                    },
+                    "The pool used by the *_async methods of entities whose "
+                    "participant has no pool of its own. It is created on "
+                    "first use; set to None to go back to a new default "
+                    "pool.");
+}
+
+
+template<>
+void process_inits<PyExecutorPool>(py::module& m, ClassInitList& l)
+{
+    l.push_back([m]() mutable {
+        return init_class<PyExecutorPool, std::shared_ptr<PyExecutorPool>>(
+                m,
+                "ExecutorPool");
+    });
+}
+
+}  // namespace pyrti
@@ -0,0 +1,922 @@
+/*
+ * (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ *
+ * RTI grants Licensee a license to use, modify, compile, and create derivative
+ * works of the Software solely for use with RTI products.  The Software is
+ * provided "as is", with no warranty of any type, including any warranty for
+ * fitness for any purpose. RTI is under no obligation to maintain or support
+ * the Software.  RTI shall not be liable for any incidental or consequential
+ * damages arising out of the use or inability to use the software.
+ */
+
+#include "PyConnext.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <list>
+#include <sstream>
+#include <unordered_set>
+#include <dds/topic/Filter.hpp>
+#include "PyDynamicDataPath.hpp"
+#include "PyPredicateFilter.hpp"
+
+using namespace dds::core::xtypes;
+
+namespace pyrti {
+
+namespace {
+
+// A parsed expression: an atom, a quoted string or a list
+struct SExpr {
+    enum Kind { ATOM, STRING, LIST };
+
+    Kind kind;
+    std::string text;
+    std::vector<SExpr> items;
+};
+
+
+class ExpressionParser {
+public:
+    ExpressionParser(
+            const std::string& text,
+            const std::vector<std::string>& parameters)
+            : _text(text), _parameters(parameters), _pos(0)
+    {
+    }
+
+    SExpr parse_all()
+    {
+        auto retval = this->parse();
+        this->skip_spaces();
+        if (this->_pos != this->_text.size()) {
+            this->fail("unexpected text after the expression");
+        }
+        return retval;
+    }
+
+private:
+    void skip_spaces()
+    {
+        while (this->_pos < this->_text.size()
+               && std::isspace(
+                       static_cast<unsigned char>(this->_text[this->_pos]))) {
+            ++this->_pos;
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& message)
+    {
+        throw dds::core::InvalidArgumentError(
+                "invalid predicate expression (" + message + " at offset "
+                + std::to_string(this->_pos) + "): " + this->_text);
+    }
+
+    SExpr parse()
+    {
+        this->skip_spaces();
+        if (this->_pos >= this->_text.size()) {
+            this->fail("unexpected end");
+        }
+
+        char c = this->_text[this->_pos];
+        if (c == '(') {
+            ++this->_pos;
+            SExpr list { SExpr::LIST, "", {} };
+            while (true) {
+                this->skip_spaces();
+                if (this->_pos >= this->_text.size()) {
+                    this->fail("missing )");
+                }
+                if (this->_text[this->_pos] == ')') {
+                    ++this->_pos;
+                    return list;
+                }
+                list.items.push_back(this->parse());
+            }
+        }
+        if (c == ')') {
+            this->fail("unexpected )");
+        }
+        if (c == '"' || c == '\'') {
+            ++this->_pos;
+            SExpr str { SExpr::STRING, "", {} };
+            while (true) {
+                if (this->_pos >= this->_text.size()) {
+                    this->fail("unterminated string");
+                }
+                char next = this->_text[this->_pos++];
+                if (next == c) return str;
+                if (next == '\\' && this->_pos < this->_text.size()) {
+                    next = this->_text[this->_pos++];
+                }
+                str.text.push_back(next);
+            }
+        }
+
+        size_t start = this->_pos;
+        while (this->_pos < this->_text.size()) {
+            char next = this->_text[this->_pos];
+            if (std::isspace(static_cast<unsigned char>(next)) || next == '('
+                || next == ')' || next == '"' || next == '\'') {
+                break;
+            }
+            ++this->_pos;
+        }
+        SExpr atom { SExpr::ATOM,
+                     this->_text.substr(start, this->_pos - start),
+                     {} };
+        if (atom.text.size() > 1 && atom.text[0] == '%') {
+            return this->parameter(atom.text);
+        }
+        return atom;
+    }
+
+    SExpr parameter(const std::string& atom)
+    {
+        char* end = nullptr;
+        unsigned long index = std::strtoul(atom.c_str() + 1, &end, 10);
+        if (*end != '\0') {
+            this->fail("invalid parameter " + atom);
+        }
+        if (index >= this->_parameters.size()) {
+            this->fail("missing parameter " + atom);
+        }
+        // A parameter holds a literal or a list of literals, but not
+        // other parameters
+        ExpressionParser parser(this->_parameters[index], {});
+        return parser.parse_all();
+    }
+
+    const std::string& _text;
+    std::vector<std::string> _parameters;
+    size_t _pos;
+};
+
+
+// Integers that don't fit in an int64 are UNSIGNED, and compare greater
+// than every INTEGER
+struct Value {
+    enum Kind { INTEGER, UNSIGNED, REAL, STRING };
+
+    Kind kind;
+    int64_t integer;
+    uint64_t unsigned_integer;
+    double real;
+    std::string string;
+
+    static Value from_unsigned(uint64_t value)
+    {
+        Value retval { INTEGER, 0, 0, 0, std::string() };
+        if (value > static_cast<uint64_t>(
+                    (std::numeric_limits<int64_t>::max)())) {
+            retval.kind = UNSIGNED;
+            retval.unsigned_integer = value;
+        } else {
+            retval.integer = static_cast<int64_t>(value);
+        }
+        return retval;
+    }
+
+    bool is_integer() const
+    {
+        return this->kind == INTEGER || this->kind == UNSIGNED;
+    }
+
+    // The two's complement bits of an integer
+    uint64_t bits() const
+    {
+        return this->kind == UNSIGNED ? this->unsigned_integer
+                                      : static_cast<uint64_t>(this->integer);
+    }
+
+    double as_real() const
+    {
+        switch (this->kind) {
+        case INTEGER:
+            return static_cast<double>(this->integer);
+        case UNSIGNED:
+            return static_cast<double>(this->unsigned_integer);
+        default:
+            return this->real;
+        }
+    }
+};
+
+
+enum class FieldClass { INTEGER, REAL, STRING };
+
+
+FieldClass field_class(const PyDynamicDataPath& path)
+{
+    switch (path.last().kind) {
+    case TypeKind::BOOLEAN_TYPE:
+    case TypeKind::UINT_8_TYPE:
+    case TypeKind::INT_16_TYPE:
+    case TypeKind::UINT_16_TYPE:
+    case TypeKind::INT_32_TYPE:
+    case TypeKind::ENUMERATION_TYPE:
+    case TypeKind::UINT_32_TYPE:
+    case TypeKind::INT_64_TYPE:
+    case TypeKind::UINT_64_TYPE:
+        return FieldClass::INTEGER;
+    case TypeKind::FLOAT_32_TYPE:
+    case TypeKind::FLOAT_64_TYPE:
+        return FieldClass::REAL;
+    case TypeKind::STRING_TYPE:
+        return FieldClass::STRING;
+    default:
+        throw dds::core::InvalidArgumentError(
+                "predicate field must be a primitive, an enum or a string: "
+                + path.path());
+    }
+}
+
+
+template<typename T>
+T member_value(const DynamicData& parent, const PyDynamicDataPath::Step& step)
+{
+    return step.by_name ? parent.value<T>(step.name)
+                        : parent.value<T>(step.index);
+}
+
+
+Value read_field(const DynamicData& sample, const PyDynamicDataPath& path)
+{
+    std::list<rti::core::xtypes::LoanedDynamicData> loans;
+    // Loans must be returned innermost first
+    struct ReturnLoans {
+        std::list<rti::core::xtypes::LoanedDynamicData>& loans;
+        ~ReturnLoans()
+        {
+            while (!loans.empty()) loans.pop_back();
+        }
+    } return_loans { loans };
+
+    const DynamicData& parent = path.steps().size() == 1
+            ? sample
+            : path.resolve_parent(const_cast<DynamicData&>(sample), loans);
+    auto& step = path.last();
+    Value value { Value::INTEGER, 0, 0, 0, std::string() };
+    switch (step.kind) {
+    case TypeKind::BOOLEAN_TYPE:
+        value.integer = member_value<bool>(parent, step) ? 1 : 0;
+        break;
+    case TypeKind::UINT_8_TYPE:
+        value.integer = member_value<uint8_t>(parent, step);
+        break;
+    case TypeKind::INT_16_TYPE:
+        value.integer = member_value<int16_t>(parent, step);
+        break;
+    case TypeKind::UINT_16_TYPE:
+        value.integer = member_value<uint16_t>(parent, step);
+        break;
+    case TypeKind::INT_32_TYPE:
+    case TypeKind::ENUMERATION_TYPE:
+        value.integer = member_value<int32_t>(parent, step);
+        break;
+    case TypeKind::UINT_32_TYPE:
+        value.integer = member_value<uint32_t>(parent, step);
+        break;
+    case TypeKind::INT_64_TYPE:
+        value.integer = member_value<rti::core::int64>(parent, step);
+        break;
+    case TypeKind::UINT_64_TYPE:
+        value = Value::from_unsigned(
+                member_value<rti::core::uint64>(parent, step));
+        break;
+    case TypeKind::FLOAT_32_TYPE:
+        value.kind = Value::REAL;
+        value.real = member_value<float>(parent, step);
+        break;
+    case TypeKind::FLOAT_64_TYPE:
+        value.kind = Value::REAL;
+        value.real = member_value<double>(parent, step);
+        break;
+    default:
+        value.kind = Value::STRING;
+        value.string = member_value<std::string>(parent, step);
+        break;
+    }
+    return value;
+}
+
+
+int compare(const Value& a, const Value& b)
+{
+    if (a.kind == Value::STRING) {
+        return a.string.compare(b.string);
+    }
+    if (a.kind == Value::INTEGER && b.kind == Value::INTEGER) {
+        return a.integer < b.integer ? -1 : (a.integer > b.integer ? 1 : 0);
+    }
+    if (a.is_integer() && b.is_integer()) {
+        if (a.kind != b.kind) {
+            return a.kind == Value::UNSIGNED ? 1 : -1;
+        }
+        return a.unsigned_integer < b.unsigned_integer
+                ? -1
+                : (a.unsigned_integer > b.unsigned_integer ? 1 : 0);
+    }
+    double x = a.as_real();
+    double y = b.as_real();
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+}  // namespace
+
+
+struct PyPredicate::Node {
+    enum class Op {
+        AND,
+        OR,
+        NOT,
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+        IN,
+        NOT_IN,
+        BETWEEN,
+        ALL_BITS,
+        ANY_BITS,
+        IN_POLYGON
+    };
+
+    Op op;
+    std::vector<std::unique_ptr<Node>> children;
+    std::vector<PyDynamicDataPath> fields;
+    // Comparison operand, range bounds, or polygon vertices (x, y, x, ...)
+    std::vector<Value> values;
+    // IN sets, by field class
+    std::vector<int64_t> integers;
+    std::vector<uint64_t> unsigned_integers;
+    std::vector<double> reals;
+    std::unordered_set<std::string> strings;
+
+    bool evaluate(const DynamicData& sample) const;
+
+    bool contains(const Value& value) const;
+};
+
+
+bool PyPredicate::Node::contains(const Value& value) const
+{
+    switch (value.kind) {
+    case Value::INTEGER:
+        return std::binary_search(
+                this->integers.begin(),
+                this->integers.end(),
+                value.integer);
+    case Value::UNSIGNED:
+        return std::binary_search(
+                this->unsigned_integers.begin(),
+                this->unsigned_integers.end(),
+                value.unsigned_integer);
+    case Value::REAL:
+        return std::binary_search(
+                this->reals.begin(),
+                this->reals.end(),
+                value.real);
+    default:
+        return this->strings.count(value.string) > 0;
+    }
+}
+
+
+bool PyPredicate::Node::evaluate(const DynamicData& sample) const
+{
+    switch (this->op) {
+    case Op::AND:
+        for (auto& child : this->children) {
+            if (!child->evaluate(sample)) return false;
+        }
+        return true;
+    case Op::OR:
+        for (auto& child : this->children) {
+            if (child->evaluate(sample)) return true;
+        }
+        return false;
+    case Op::NOT:
+        return !this->children[0]->evaluate(sample);
+    case Op::IN_POLYGON: {
+        // Ray casting: count the edges crossed by a ray from the point
+        double x = read_field(sample, this->fields[0]).as_real();
+        double y = read_field(sample, this->fields[1]).as_real();
+        bool inside = false;
+        size_t count = this->values.size() / 2;
+        for (size_t i = 0, j = count - 1; i < count; j = i++) {
+            double xi = this->values[2 * i].real;
+            double yi = this->values[2 * i + 1].real;
+            double xj = this->values[2 * j].real;
+            double yj = this->values[2 * j + 1].real;
+            if ((yi > y) != (yj > y)
+                && x < (xj - xi) * (y - yi) / (yj - yi) + xi) {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+    default:
+        break;
+    }
+
+    auto value = read_field(sample, this->fields[0]);
+    switch (this->op) {
+    case Op::EQ:
+        return compare(value, this->values[0]) == 0;
+    case Op::NE:
+        return compare(value, this->values[0]) != 0;
+    case Op::LT:
+        return compare(value, this->values[0]) < 0;
+    case Op::LE:
+        return compare(value, this->values[0]) <= 0;
+    case Op::GT:
+        return compare(value, this->values[0]) > 0;
+    case Op::GE:
+        return compare(value, this->values[0]) >= 0;
+    case Op::IN:
+        return this->contains(value);
+    case Op::NOT_IN:
+        return !this->contains(value);
+    case Op::BETWEEN:
+        return compare(value, this->values[0]) >= 0
+                && compare(value, this->values[1]) <= 0;
+    case Op::ALL_BITS:
+        return (value.bits() & this->values[0].bits())
+                == this->values[0].bits();
+    case Op::ANY_BITS:
+        return (value.bits() & this->values[0].bits()) != 0;
+    default:
+        return false;
+    }
+}
+
+
+namespace {
+
+typedef PyPredicate::Node Node;
+typedef PyPredicate::Node::Op Op;
+
+
+[[noreturn]] void invalid(const std::string& message)
+{
+    throw dds::core::InvalidArgumentError(
+            "invalid predicate expression: " + message);
+}
+
+
+Value literal(const SExpr& expr)
+{
+    Value value { Value::INTEGER, 0, 0, 0, std::string() };
+    if (expr.kind == SExpr::STRING) {
+        value.kind = Value::STRING;
+        value.string = expr.text;
+        return value;
+    }
+    if (expr.kind != SExpr::ATOM) {
+        invalid("expected a literal");
+    }
+    if (expr.text == "true" || expr.text == "false") {
+        value.integer = expr.text == "true" ? 1 : 0;
+        return value;
+    }
+
+    const char* text = expr.text.c_str();
+    char* end = nullptr;
+    errno = 0;
+    // Decimal, or hexadecimal for masks
+    bool hex = expr.text.size() > 2 && expr.text[0] == '0'
+            && (expr.text[1] == 'x' || expr.text[1] == 'X');
+    int base = hex ? 16 : 10;
+    long long integer = std::strtoll(text, &end, base);
+    if (*end == '\0' && errno == 0) {
+        value.integer = integer;
+        return value;
+    }
+    // Integers past int64 that fit in a uint64, such as bitmasks
+    errno = 0;
+    unsigned long long unsigned_integer = std::strtoull(text, &end, base);
+    if (*end == '\0' && errno == 0 && text[0] != '-') {
+        return Value::from_unsigned(unsigned_integer);
+    }
+    double real = std::strtod(text, &end);
+    if (*end != '\0' || expr.text.empty()) {
+        invalid("not a number: " + expr.text);
+    }
+    value.kind = Value::REAL;
+    value.real = real;
+    return value;
+}
+
+
+// Checks that a literal can be compared with a field
+Value operand(const SExpr& expr, FieldClass field, const std::string& path)
+{
+    auto value = literal(expr);
+    if ((field == FieldClass::STRING) != (value.kind == Value::STRING)) {
+        invalid("literal " + expr.text + " doesn't match the type of "
+                + path);
+    }
+    return value;
+}
+
+
+PyDynamicDataPath field_path(const SExpr& expr, const DynamicType& type)
+{
+    if (expr.kind != SExpr::ATOM) {
+        invalid("expected a field path");
+    }
+    return PyDynamicDataPath::compile(type, expr.text);
+}
+
+
+std::unique_ptr<Node> compile_node(const SExpr& expr, const DynamicType& type)
+{
+    if (expr.kind != SExpr::LIST || expr.items.empty()
+        || expr.items[0].kind != SExpr::ATOM) {
+        invalid("expected (operator ...)");
+    }
+    auto& name = expr.items[0].text;
+    auto& args = expr.items;
+    std::unique_ptr<Node> node(new Node());
+
+    if (name == "and" || name == "or" || name == "not") {
+        node->op = name == "and" ? Op::AND : (name == "or" ? Op::OR : Op::NOT);
+        if (args.size() < 2 || (node->op == Op::NOT && args.size() != 2)) {
+            invalid("wrong number of operands for " + name);
+        }
+        for (size_t i = 1; i < args.size(); ++i) {
+            node->children.push_back(compile_node(args[i], type));
+        }
+        return node;
+    }
+
+    if (name == "in_polygon") {
+        node->op = Op::IN_POLYGON;
+        if (args.size() != 4 || args[3].kind != SExpr::LIST
+            || args[3].items.size() < 3) {
+            invalid("in_polygon expects two fields and three or more "
+                    "vertices");
+        }
+        for (size_t i = 1; i < 3; ++i) {
+            node->fields.push_back(field_path(args[i], type));
+            if (field_class(node->fields.back()) == FieldClass::STRING) {
+                invalid("in_polygon fields must be numeric");
+            }
+        }
+        for (auto& vertex : args[3].items) {
+            if (vertex.kind != SExpr::LIST || vertex.items.size() != 2) {
+                invalid("polygon vertices must be (x y) pairs");
+            }
+            for (auto& coordinate : vertex.items) {
+                auto value =
+                        operand(coordinate, FieldClass::REAL, "in_polygon");
+                value.real = value.as_real();
+                value.kind = Value::REAL;
+                node->values.push_back(value);
+            }
+        }
+        return node;
+    }
+
+    static const std::vector<std::pair<std::string, Op>> comparisons = {
+        { "==", Op::EQ },        { "!=", Op::NE },
+        { "<", Op::LT },         { "<=", Op::LE },
+        { ">", Op::GT },         { ">=", Op::GE },
+        { "in", Op::IN },        { "not_in", Op::NOT_IN },
+        { "between", Op::BETWEEN }, { "all_bits", Op::ALL_BITS },
+        { "any_bits", Op::ANY_BITS }
+    };
+    auto it = std::find_if(
+            comparisons.begin(),
+            comparisons.end(),
+            [&name](const std::pair<std::string, Op>& c) -> bool {
+                return c.first == name;
+            });
+    if (it == comparisons.end()) {
+        invalid("unknown operator " + name);
+    }
+    node->op = it->second;
+
+    size_t operands = node->op == Op::BETWEEN ? 2 : 1;
+    if (args.size() != 2 + operands) {
+        invalid("wrong number of operands for " + name);
+    }
+    node->fields.push_back(field_path(args[1], type));
+    auto& path = node->fields[0].path();
+    auto field = field_class(node->fields[0]);
+
+    if (node->op == Op::IN || node->op == Op::NOT_IN) {
+        if (args[2].kind != SExpr::LIST) {
+            invalid(name + " expects a list of literals");
+        }
+        for (auto& item : args[2].items) {
+            auto value = operand(item, field, path);
+            if (field == FieldClass::STRING) {
+                node->strings.insert(value.string);
+            } else if (field == FieldClass::REAL) {
+                node->reals.push_back(value.as_real());
+            } else if (value.kind == Value::INTEGER) {
+                node->integers.push_back(value.integer);
+            } else if (value.kind == Value::UNSIGNED) {
+                node->unsigned_integers.push_back(value.unsigned_integer);
+            } else if (value.real == static_cast<double>(
+                               static_cast<int64_t>(value.real))) {
+                node->integers.push_back(static_cast<int64_t>(value.real));
+            }
+            // A fractional value never matches an integer field
+        }
+        std::sort(node->integers.begin(), node->integers.end());
+        std::sort(
+                node->unsigned_integers.begin(),
+                node->unsigned_integers.end());
+        std::sort(node->reals.begin(), node->reals.end());
+        return node;
+    }
+
+    for (size_t i = 0; i < operands; ++i) {
+        node->values.push_back(operand(args[2 + i], field, path));
+    }
+    if ((node->op == Op::ALL_BITS || node->op == Op::ANY_BITS)
+        && (field != FieldClass::INTEGER
+            || !node->values[0].is_integer())) {
+        invalid(name + " expects an integer field and mask");
+    }
+    return node;
+}
+
+
+void write_literal(std::ostringstream& out, py::handle value)
+{
+    if (py::isinstance<PyPredicateParameter>(value)) {
+        out << '%' << py::cast<PyPredicateParameter>(value).index;
+    } else if (py::isinstance<py::bool_>(value)) {
+        out << (py::cast<bool>(value) ? "true" : "false");
+    } else if (py::isinstance<py::int_>(value)) {
+        out << py::cast<std::string>(py::str(value));
+    } else if (py::isinstance<py::float_>(value)) {
+        out << py::cast<std::string>(py::repr(value));
+    } else if (py::isinstance<py::str>(value)) {
+        out << '"';
+        for (char c : py::cast<std::string>(value)) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    } else if (py::isinstance<py::iterable>(value)) {
+        out << '(';
+        bool first = true;
+        for (auto item : value) {
+            if (!first) out << ' ';
+            first = false;
+            write_literal(out, item);
+        }
+        out << ')';
+    } else {
+        throw py::type_error(
+                "unsupported predicate literal: "
+                + py::cast<std::string>(py::repr(value)));
+    }
+}
+
+
+void write_path(std::ostringstream& out, py::handle path)
+{
+    auto text = py::cast<std::string>(path);
+    if (text.empty()
+        || std::any_of(text.begin(), text.end(), [](char c) -> bool {
+               return std::isspace(static_cast<unsigned char>(c)) || c == '('
+                       || c == ')' || c == '"' || c == '\'' || c == '%';
+           })) {
+        throw py::value_error("invalid predicate field path: " + text);
+    }
+    out << text;
+}
+
+
+void write_predicate(std::ostringstream& out, py::handle predicate)
+{
+    if (!py::isinstance<py::tuple>(predicate)
+        && !py::isinstance<py::list>(predicate)) {
+        throw py::type_error(
+                "a predicate is a tuple such as (\"<\", \"x\", 10)");
+    }
+    auto items = py::cast<py::sequence>(predicate);
+    if (items.size() < 2) {
+        throw py::value_error("a predicate needs an operator and operands");
+    }
+    auto op = py::cast<std::string>(items[0]);
+    out << '(' << op;
+    if (op == "and" || op == "or" || op == "not") {
+        for (size_t i = 1; i < items.size(); ++i) {
+            out << ' ';
+            write_predicate(out, items[i]);
+        }
+    } else if (op == "in_polygon") {
+        // ("in_polygon", (x_path, y_path), vertices)
+        if (items.size() != 3) {
+            throw py::value_error(
+                    "in_polygon expects (x_path, y_path) and the vertices");
+        }
+        for (auto path : items[1]) {
+            out << ' ';
+            write_path(out, path);
+        }
+        out << ' ';
+        write_literal(out, items[2]);
+    } else {
+        out << ' ';
+        write_path(out, items[1]);
+        for (size_t i = 2; i < items.size(); ++i) {
+            out << ' ';
+            write_literal(out, items[i]);
+        }
+    }
+    out << ')';
+}
+
+
+std::string predicate_expression(py::handle predicate)
+{
+    if (py::isinstance<py::str>(predicate)) {
+        return py::cast<std::string>(predicate);
+    }
+    return PyPredicate::expression(predicate);
+}
+
+}  // namespace
+
+
+PyPredicate::PyPredicate(std::unique_ptr<Node> root) : _root(std::move(root))
+{
+}
+
+
+PyPredicate::~PyPredicate()
+{
+}
+
+
+std::unique_ptr<PyPredicate> PyPredicate::compile(
+        const std::string& expression,
+        const std::vector<std::string>& parameters,
+        const DynamicType& type)
+{
+    ExpressionParser parser(expression, parameters);
+    return std::unique_ptr<PyPredicate>(
+            new PyPredicate(compile_node(parser.parse_all(), type)));
+}
+
+
+bool PyPredicate::evaluate(const DynamicData& sample) const
+{
+    try {
+        return this->_root->evaluate(sample);
+    } catch (const dds::core::Exception&) {
+        return false;
+    }
+}
+
+
+std::string PyPredicate::expression(py::handle predicate)
+{
+    std::ostringstream out;
+    write_predicate(out, predicate);
+    return out.str();
+}
+
+
+const char* const PyPredicateFilter::FILTER_NAME = "PredicateFilter";
+
+
+PyPredicate& PyPredicateFilter::compile(
+        const std::string& expression,
+        const std::vector<std::string>& parameters,
+        const dds::core::optional<DynamicType>& type_code,
+        const std::string&,
+        PyPredicate* old_compile_data)
+{
+    if (!has_value(type_code)) {
+        throw dds::core::PreconditionNotMetError(
+                "the predicate filter needs the type of the topic");
+    }
+    auto predicate =
+            PyPredicate::compile(expression, parameters, get_value(type_code));
+    delete old_compile_data;
+    return *predicate.release();
+}
+
+
+bool PyPredicateFilter::evaluate(
+        PyPredicate& compile_data,
+        const DynamicData& sample,
+        const rti::topic::FilterSampleInfo&)
+{
+    return compile_data.evaluate(sample);
+}
+
+
+void PyPredicateFilter::finalize(PyPredicate& compile_data)
+{
+    delete &compile_data;
+}
+
+
+template<>
+void init_class_defs(
+        py::class_<PyPredicateFilter, rti::topic::ContentFilterBase>& cls)
+{
+    py::class_<PyPredicateParameter>(cls, "Parameter")
+            .def(py::init([](uint32_t index) {
+                     return PyPredicateParameter { index };
+                 }),
+                 py::arg("index"),
+                 "Refer to the filter parameter at index in a predicate.")
+            .def_readonly(
+                    "index",
+                    &PyPredicateParameter::index,
+                    "The index of the filter parameter.");
+
+    cls.def(py::init<>(),
+            "Create a content filter that evaluates predicates natively. "
+            "Register it with DomainParticipant.register_contentfilter() "
+            "under PredicateFilter.filter_name on the participants of the "
+            "DataReaders and, to filter on the writer side, of the "
+            "DataWriters.")
+            .def_property_readonly_static(
+                    "filter_name",
+                    [](py::object&) {
+                        return std::string(PyPredicateFilter::FILTER_NAME);
+                    },
+                    "The name filters created by PredicateFilter.filter() "
+                    "use.")
+            .def_static(
+                    "expression",
+                    [](py::object predicate) {
+                        return predicate_expression(predicate);
+                    },
+                    py::arg("predicate"),
+                    "Get the filter expression of a predicate tree. A "
+                    "predicate is a tuple: (\"and\", p1, p2, ...), (\"or\", "
+                    "...), (\"not\", p), (op, path, value) with op one of "
+                    "==, !=, <, <=, >, >=, (\"in\", path, values), "
+                    "(\"not_in\", path, values), (\"between\", path, low, "
+                    "high), (\"all_bits\", path, mask), (\"any_bits\", "
+                    "path, mask) or (\"in_polygon\", (x_path, y_path), "
+                    "vertices). Values are numbers, strings, or "
+                    "PredicateFilter.Parameter(index).")
+            .def_static(
+                    "filter",
+                    [](py::object predicate,
+                       const std::vector<std::string>& parameters,
+                       const std::string& name) {
+                        dds::topic::Filter filter(
+                                predicate_expression(predicate),
+                                parameters);
+                        filter->name(name);
+                        return filter;
+                    },
+                    py::arg("predicate"),
+                    py::arg("parameters") = std::vector<std::string>(),
+                    py::arg("name") =
+                            std::string(PyPredicateFilter::FILTER_NAME),
+                    "Create a Filter for a ContentFilteredTopic from a "
+                    "predicate tree or expression. Each parameter holds a "
+                    "literal, such as 10 or \"RED\", or a list of literals "
+                    "such as (1 2 3).")
+            .def_static(
+                    "matches",
+                    [](py::object predicate,
+                       const DynamicData& sample,
+                       const std::vector<std::string>& parameters) {
+                        auto expression = predicate_expression(predicate);
+                        py::gil_scoped_release release;
+                        return PyPredicate::compile(
+                                       expression,
+                                       parameters,
+                                       sample.type())
+                                ->evaluate(sample);
+                    },
+                    py::arg("predicate"),
+                    py::arg("sample"),
+                    py::arg("parameters") = std::vector<std::string>(),
+                    "Evaluate a predicate tree or expression on a sample.");
+}
+
+
+template<>
+void process_inits<PyPredicateFilter>(py::module& m, ClassInitList& l)
+{
+    l.push_back([m]() mutable {
+        return init_class<PyPredicateFilter, rti::topic::ContentFilterBase>(
+                m,
+                "PredicateFilter");
+    });
+}
+
+}  // namespace pyrti
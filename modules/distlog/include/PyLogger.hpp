@@ -17,10 +17,29 @@
 #include "PyLoggerOptions.hpp"
 #include "PyLogLevel.hpp"
 #include "PyMessageParams.hpp"
+#include <memory>
 #include <mutex>
 
 namespace pyrti {
     class PyLoggerOptions;
+    class PyAsyncLogSink;
+
+    enum class PyLogOverflowPolicy {
+        DROP_OLDEST,
+        BLOCK,
+        SAMPLE
+    };
+
+    struct PyAsyncLogMetrics {
+        // Records accepted into the queue
+        uint64_t queued;
+        // Records discarded by the overflow policy
+        uint64_t dropped;
+        // Records handed to the Distributed Logger
+        uint64_t published;
+        uint64_t depth;
+        uint64_t capacity;
+    };
 
     class PyLogger {
     public:
@@ -42,16 +61,23 @@ namespace pyrti {
         static void debug(const std::string&);
         static void trace(const std::string&);
         static void log(PyLogLevel, const std::string&);
+        static void enable_async(size_t, PyLogOverflowPolicy, size_t, uint32_t);
+        static void disable_async();
+        static bool async_enabled();
+        static PyAsyncLogMetrics async_metrics();
 
     private:
         PyLogger();
+        static bool enqueue(PyLogLevel, const std::string&, const std::string&, const DDS_Time_t*);
         RTI_DL_DistLogger* _instance;
         static std::unique_ptr<PyLogger> _py_instance;
         static bool _options_set;
         static std::recursive_mutex _lock;
+        static std::shared_ptr<PyAsyncLogSink> _async_sink;
 #if rti_connext_version_lt(6, 0, 0, 0)
         static std::unique_ptr<PyLoggerOptions> _options;
 #endif
+        friend class PyAsyncLogSink;
     };
 
     void init_logger(py::module&);
@@ -11,13 +11,298 @@
 
 #include "PyConnext.hpp"
 #include "PyLogger.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace pyrti {
 
+/*
+    Bounded lock-free queue (D. Vyukov's array-based queue). Each cell's
+    sequence number tells producers and consumers whether it is free or
+    holds a value for their turn. Any thread can pop, which lets producers
+    drop the oldest record when the queue is full.
+ */
+template<typename T>
+class PyBoundedQueue {
+public:
+    explicit PyBoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        this->_mask = size - 1;
+        this->_cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            this->_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        this->_enqueue_pos.store(0, std::memory_order_relaxed);
+        this->_dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    // Leaves value untouched when the queue is full
+    bool try_push(T& value) {
+        Cell* cell;
+        size_t pos = this->_enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &this->_cells[pos & this->_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+            if (diff == 0) {
+                if (this->_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = this->_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        Cell* cell;
+        size_t pos = this->_dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &this->_cells[pos & this->_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+            if (diff == 0) {
+                if (this->_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = this->_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(pos + this->_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        size_t head = this->_dequeue_pos.load(std::memory_order_relaxed);
+        size_t tail = this->_enqueue_pos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const {
+        return this->_mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    size_t _mask;
+    // Keep the producer and consumer positions on different cache lines
+    char _pad0[64];
+    std::atomic<size_t> _enqueue_pos;
+    char _pad1[64];
+    std::atomic<size_t> _dequeue_pos;
+    char _pad2[64];
+};
+
+
+struct PyLogRecord {
+    int level;
+    std::string message;
+    std::string category;
+    DDS_Time_t timestamp;
+};
+
+
+/*
+    Queues log records from any thread and publishes them in batches from
+    a background thread, taking the logger lock once per batch.
+ */
+class PyAsyncLogSink {
+public:
+    PyAsyncLogSink(size_t capacity, PyLogOverflowPolicy policy, size_t batch_size, uint32_t sample_rate)
+            : _queue(capacity),
+              _policy(policy),
+              _batch_size(batch_size),
+              _sample_rate(sample_rate),
+              _queued(0),
+              _dropped(0),
+              _published(0),
+              _sampled(0),
+              _blocked(0),
+              _sleeping(false),
+              _stop(false) {
+        this->_thread = std::thread(&PyAsyncLogSink::run, this);
+    }
+
+    ~PyAsyncLogSink() {
+        this->close();
+    }
+
+    void push(PyLogRecord& record) {
+        bool pushed = false;
+        switch (this->_policy) {
+        case PyLogOverflowPolicy::DROP_OLDEST:
+            while (!this->_queue.try_push(record)) {
+                PyLogRecord oldest;
+                if (this->_queue.try_pop(oldest)) ++this->_dropped;
+            }
+            pushed = true;
+            break;
+        case PyLogOverflowPolicy::BLOCK:
+            pushed = this->_queue.try_push(record);
+            if (!pushed) {
+                std::unique_lock<std::mutex> lock(this->_mutex);
+                ++this->_blocked;
+                // The timeout covers a pop that missed the blocked count
+                while (!this->_stop && !(pushed = this->_queue.try_push(record))) {
+                    this->_space.wait_for(lock, std::chrono::milliseconds(1));
+                }
+                --this->_blocked;
+            }
+            // Once closed there is no thread left to make room
+            while (!pushed) {
+                this->drain();
+                pushed = this->_queue.try_push(record);
+            }
+            break;
+        case PyLogOverflowPolicy::SAMPLE:
+            // Past half capacity, keep one record out of sample_rate
+            if (this->_queue.size() >= this->_queue.capacity() / 2
+                    && this->_sampled++ % this->_sample_rate != 0) {
+                break;
+            }
+            pushed = this->_queue.try_push(record);
+            break;
+        }
+
+        if (!pushed) {
+            ++this->_dropped;
+            return;
+        }
+        ++this->_queued;
+        // The sink may have been closed, and drained for the last time,
+        // while this record was being pushed
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->_stop.load()) {
+            this->drain();
+            return;
+        }
+        if (this->_sleeping.load()) {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_ready.notify_one();
+        }
+    }
+
+    // Publishes the queued records and stops the thread. Records pushed
+    // after that are published by the thread that pushes them.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (this->_stop) return;
+            this->_stop = true;
+            this->_ready.notify_one();
+            this->_space.notify_all();
+        }
+        if (this->_thread.joinable()) this->_thread.join();
+        this->drain();
+    }
+
+    PyAsyncLogMetrics metrics() const {
+        PyAsyncLogMetrics metrics;
+        metrics.queued = this->_queued.load();
+        metrics.dropped = this->_dropped.load();
+        metrics.published = this->_published.load();
+        metrics.depth = this->_queue.size();
+        metrics.capacity = this->_queue.capacity();
+        return metrics;
+    }
+
+private:
+    void run() {
+        std::vector<PyLogRecord> batch;
+        batch.reserve(this->_batch_size);
+        PyLogRecord record;
+        while (true) {
+            while (batch.size() < this->_batch_size && this->_queue.try_pop(record)) {
+                batch.push_back(std::move(record));
+            }
+            if (!batch.empty()) {
+                if (this->_blocked.load() > 0) {
+                    std::lock_guard<std::mutex> lock(this->_mutex);
+                    this->_space.notify_all();
+                }
+                this->publish(batch);
+                batch.clear();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            if (this->_stop) break;
+            this->_sleeping = true;
+            // The timeout covers a push that missed the sleeping flag
+            this->_ready.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+                return this->_stop || this->_queue.size() > 0;
+            });
+            this->_sleeping = false;
+        }
+    }
+
+    // Publishes the queued records from the calling thread
+    void drain() {
+        std::vector<PyLogRecord> batch;
+        PyLogRecord record;
+        while (this->_queue.try_pop(record)) {
+            batch.push_back(std::move(record));
+            if (batch.size() == this->_batch_size) {
+                this->publish(batch);
+                batch.clear();
+            }
+        }
+        if (!batch.empty()) this->publish(batch);
+    }
+
+    void publish(const std::vector<PyLogRecord>& batch) {
+        std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
+        if (PyLogger::_py_instance) {
+            for (auto& record : batch) {
+                RTI_DL_DistLogger_MessageParams params;
+                params.log_level = record.level;
+                params.message = record.message.c_str();
+                params.category = record.category.empty() ? NULL : record.category.c_str();
+                params.timestamp = record.timestamp;
+                RTI_DL_DistLogger_logMessageWithParams(PyLogger::_py_instance->_instance, &params);
+            }
+        }
+        this->_published += batch.size();
+    }
+
+    PyBoundedQueue<PyLogRecord> _queue;
+    PyLogOverflowPolicy _policy;
+    size_t _batch_size;
+    uint32_t _sample_rate;
+    std::atomic<uint64_t> _queued;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<uint64_t> _published;
+    std::atomic<uint64_t> _sampled;
+    std::atomic<int> _blocked;
+    std::atomic<bool> _sleeping;
+    std::atomic<bool> _stop;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::condition_variable _space;
+    std::thread _thread;
+};
+
+
 bool PyLogger::_options_set = false;
 std::recursive_mutex PyLogger::_lock;
 std::unique_ptr<PyLogger> PyLogger::_py_instance;
+std::shared_ptr<PyAsyncLogSink> PyLogger::_async_sink;
 #if rti_connext_version_lt(6, 0, 0, 0)
 std::unique_ptr<PyLoggerOptions> PyLogger::_options;
 #endif
@@ -61,6 +346,7 @@ bool PyLogger::options(const PyLoggerOptions& options) {
 }
 
 void PyLogger::finalize() {
+    PyLogger::disable_async();
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     if (PyLogger::_py_instance == nullptr) {
         return;
@@ -103,6 +389,7 @@ void PyLogger::verbosity(const rti::config::LogCategory& category, const rti::co
 }
 
 void PyLogger::log(PyLogLevel level, const std::string& message, const std::string& category) {
+    if (PyLogger::enqueue(level, message, category, nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_logMessageWithLevelCategory(
         PyLogger::instance()._instance,
@@ -112,6 +399,7 @@ void PyLogger::log(PyLogLevel level, const std::string& message, const std::stri
 }
 
 void PyLogger::log(const PyMessageParams& params) {
+    if (PyLogger::enqueue(PyLogLevel(params._params.log_level), params._message, params._category, &params._params.timestamp)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_logMessageWithParams(
         PyLogger::instance()._instance,
@@ -120,51 +408,153 @@ void PyLogger::log(const PyMessageParams& params) {
 }
 
 void PyLogger::fatal(const std::string& message) {
+    if (PyLogger::enqueue(PyLogLevel::PY_DISTLOG_FATAL, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_fatal(PyLogger::instance()._instance, message.c_str());
 }
 
 void PyLogger::severe(const std::string& message) {
+    if (PyLogger::enqueue(PyLogLevel::PY_DISTLOG_SEVERE, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_severe(PyLogger::instance()._instance, message.c_str());
 }
 
 void PyLogger::error(const std::string& message) {
+    if (PyLogger::enqueue(PyLogLevel::PY_DISTLOG_ERROR, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_error(PyLogger::instance()._instance, message.c_str());
 }
 
 void PyLogger::warning(const std::string& message) {
+    if (PyLogger::enqueue(PyLogLevel::PY_DISTLOG_WARNING, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_warning(PyLogger::instance()._instance, message.c_str());
 }
 
 void PyLogger::notice(const std::string& message) {
+    if (PyLogger::enqueue(PyLogLevel::PY_DISTLOG_NOTICE, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_notice(PyLogger::instance()._instance, message.c_str());
 }
 
 void PyLogger::info(const std::string& message) {
+    if (PyLogger::enqueue(PyLogLevel::PY_DISTLOG_INFO, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_info(PyLogger::instance()._instance, message.c_str());
 }
 
 void PyLogger::debug(const std::string& message) {
+    if (PyLogger::enqueue(PyLogLevel::PY_DISTLOG_DEBUG, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_debug(PyLogger::instance()._instance, message.c_str());
 }
 
 void PyLogger::trace(const std::string& message) {
+    if (PyLogger::enqueue(PyLogLevel::PY_DISTLOG_TRACE, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_trace(PyLogger::instance()._instance, message.c_str());
 }
 
 void PyLogger::log(PyLogLevel level, const std::string& message) {
+    if (PyLogger::enqueue(level, message, "", nullptr)) return;
     std::lock_guard<std::recursive_mutex> lock(PyLogger::_lock);
     RTI_DL_DistLogger_log(PyLogger::instance()._instance, (int)level, message.c_str());
 }
 
+bool PyLogger::enqueue(PyLogLevel level, const std::string& message, const std::string& category, const DDS_Time_t* timestamp) {
+    auto sink = std::atomic_load(&PyLogger::_async_sink);
+    if (!sink) return false;
+
+    PyLogRecord record;
+    record.level = (int)level;
+    record.message = message;
+    record.category = category;
+    if (timestamp != nullptr) {
+        record.timestamp = *timestamp;
+    } else {
+        // Keep the time of the call rather than the time of publication
+        auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        record.timestamp.sec = (DDS_Long)(now / 1000000000);
+        record.timestamp.nanosec = (DDS_UnsignedLong)(now % 1000000000);
+    }
+    sink->push(record);
+    return true;
+}
+
+void PyLogger::enable_async(size_t capacity, PyLogOverflowPolicy policy, size_t batch_size, uint32_t sample_rate) {
+    if (capacity == 0) throw dds::core::InvalidArgumentError("capacity must be positive");
+    if (batch_size == 0) throw dds::core::InvalidArgumentError("batch_size must be positive");
+    if (sample_rate == 0) throw dds::core::InvalidArgumentError("sample_rate must be positive");
+
+    PyLogger::instance();
+    PyLogger::disable_async();
+    std::atomic_store(
+        &PyLogger::_async_sink,
+        std::make_shared<PyAsyncLogSink>(capacity, policy, batch_size, sample_rate));
+}
+
+void PyLogger::disable_async() {
+    auto sink = std::atomic_exchange(&PyLogger::_async_sink, std::shared_ptr<PyAsyncLogSink>());
+    if (sink) sink->close();
+}
+
+bool PyLogger::async_enabled() {
+    return (bool)std::atomic_load(&PyLogger::_async_sink);
+}
+
+PyAsyncLogMetrics PyLogger::async_metrics() {
+    auto sink = std::atomic_load(&PyLogger::_async_sink);
+    if (!sink) throw dds::core::PreconditionNotMetError("asynchronous logging is not enabled");
+    return sink->metrics();
+}
+
 void init_logger(py::module& m) {
+    py::enum_<PyLogOverflowPolicy>(m, "OverflowPolicy")
+        .value(
+            "DROP_OLDEST",
+            PyLogOverflowPolicy::DROP_OLDEST,
+            "Discard the oldest queued record to make room for a new one."
+        )
+        .value(
+            "BLOCK",
+            PyLogOverflowPolicy::BLOCK,
+            "Wait until the queue has room."
+        )
+        .value(
+            "SAMPLE",
+            PyLogOverflowPolicy::SAMPLE,
+            "Once the queue is half full, keep one record out of "
+            "sample_rate; discard new records when it is full."
+        );
+
+    py::class_<PyAsyncLogMetrics>(m, "AsyncMetrics")
+        .def_readonly(
+            "queued",
+            &PyAsyncLogMetrics::queued,
+            "The number of records accepted into the queue."
+        )
+        .def_readonly(
+            "dropped",
+            &PyAsyncLogMetrics::dropped,
+            "The number of records discarded by the overflow policy."
+        )
+        .def_readonly(
+            "published",
+            &PyAsyncLogMetrics::published,
+            "The number of records passed to the Distributed Logger."
+        )
+        .def_readonly(
+            "depth",
+            &PyAsyncLogMetrics::depth,
+            "The number of records in the queue."
+        )
+        .def_readonly(
+            "capacity",
+            &PyAsyncLogMetrics::capacity,
+            "The capacity of the queue."
+        );
+
     py::class_<PyLogger> cls(m, "Logger");
     cls
         .def_static(
@@ -287,11 +677,44 @@ void init_logger(py::module& m) {
             py::call_guard<py::gil_scoped_release>(),
             "Log a trace message."
         )
+        .def_static(
+            "enable_async",
+            &PyLogger::enable_async,
+            py::arg("capacity") = 8192,
+            py::arg("overflow_policy") = PyLogOverflowPolicy::DROP_OLDEST,
+            py::arg("batch_size") = 256,
+            py::arg("sample_rate") = 10,
+            py::call_guard<py::gil_scoped_release>(),
+            "Queue log messages in a bounded lock-free queue and publish "
+            "them in batches of up to batch_size from a background thread. "
+            "The capacity is rounded up to a power of two. The "
+            "overflow_policy decides what happens when the queue is full. "
+            "Messages keep the time they were logged at. Enabling it again "
+            "publishes the queued messages and applies the new settings."
+        )
+        .def_static(
+            "disable_async",
+            &PyLogger::disable_async,
+            py::call_guard<py::gil_scoped_release>(),
+            "Publish the queued messages and go back to publishing each "
+            "message on the thread that logs it."
+        )
+        .def_static(
+            "async_enabled",
+            &PyLogger::async_enabled,
+            "Whether messages are published asynchronously."
+        )
+        .def_static(
+            "async_metrics",
+            &PyLogger::async_metrics,
+            "The counters of the asynchronous queue."
+        )
         .def_static(
             "finalize",
             &PyLogger::finalize,
             py::call_guard<py::gil_scoped_release>(),
-            "Destroy the Logger. It should not be accessed after this call."
+            "Publish the queued messages and destroy the Logger. It should "
+            "not be accessed after this call."
         );
 }
 
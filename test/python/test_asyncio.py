@@ -0,0 +1,227 @@
+ #
+ # (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ #
+ # RTI grants Licensee a license to use, modify, compile, and create derivative
+ # works of the Software solely for use with RTI products.  The Software is
+ # provided "as is", with no warranty of any type, including any warranty for
+ # fitness for any purpose. RTI is under no obligation to maintain or support
+ # the Software.  RTI shall not be liable for any incidental or consequential
+ # damages arising out of the use or inability to use the software.
+ #
+
+import rti.connextdds as dds
+import gc
+import pytest
+import sys
+import threading
+import utils
+import weakref
+
+asyncio = pytest.importorskip("asyncio")
+
+pytestmark = [
+    pytest.mark.skipif(
+        not hasattr(asyncio, "get_running_loop"),
+        reason="Python 3.7+ needed to use asyncio functionality",
+    ),
+    pytest.mark.skipif(
+        sys.platform == "win32", reason="AsyncioWaitSet requires add_reader"
+    ),
+]
+
+DOMAIN_ID = 0
+
+
+@pytest.fixture
+def event_loop():
+    loop = asyncio.new_event_loop()
+    yield loop
+    loop.close()
+
+
+def test_asyncio_waitset_guard_condition(event_loop):
+    async def run():
+        guard = dds.GuardCondition()
+        with dds.AsyncioWaitSet() as waitset:
+            waitset += guard
+            # Two concurrent waits are resolved by the same notification
+            waits = [waitset.wait(), waitset.wait()]
+            threading.Timer(0.1, lambda: setattr(guard, "trigger_value", True)).start()
+            results = await asyncio.gather(*waits)
+            for triggered in results:
+                assert guard in triggered
+            guard.trigger_value = False
+
+            with pytest.raises(asyncio.TimeoutError):
+                await waitset.wait(dds.Duration.from_milliseconds(100))
+
+    event_loop.run_until_complete(run())
+
+
+def test_asyncio_waitset_close_cancels_waits(event_loop):
+    async def run():
+        waitset = dds.AsyncioWaitSet()
+        waitset += dds.GuardCondition()
+        pending = waitset.wait()
+        waitset.close()
+        assert waitset.closed
+        with pytest.raises(asyncio.CancelledError):
+            await pending
+
+    event_loop.run_until_complete(run())
+
+
+def test_asyncio_waitset_drops_timed_out_waits(event_loop):
+    async def run():
+        with dds.AsyncioWaitSet() as waitset:
+            waitset += dds.GuardCondition()
+            future = waitset.wait()
+            timed_out = weakref.ref(future)
+            with pytest.raises(asyncio.TimeoutError):
+                await asyncio.wait_for(future, 0.05)
+            del future
+            # The next wait() releases the cancelled future
+            pending = waitset.wait()
+            gc.collect()
+            assert timed_out() is None
+            pending.cancel()
+
+    event_loop.run_until_complete(run())
+
+def test_take_async_iter(event_loop):
+    system = utils.TestSystem(DOMAIN_ID, "StringTopicType")
+
+    async def run():
+        received = []
+        with system.reader.take_async_iter(max_batch_size=2, queue_size=3) as it:
+            threading.Timer(
+                0.1, lambda: [system.writer.write(str(i)) for i in range(5)]
+            ).start()
+            async for data, info in it:
+                assert info.valid
+                received.append(data)
+                # The iterator never holds more than queue_size samples
+                assert it.queued <= 3
+                if len(received) == 5:
+                    break
+        assert it.closed
+        return received
+
+    assert event_loop.run_until_complete(run()) == [str(i) for i in range(5)]
+    assert len(system.reader.read()) == 0
+
+
+def test_take_async_batches(event_loop):
+    system = utils.TestSystem(DOMAIN_ID, "StringTopicType")
+    for i in range(5):
+        system.writer.write(str(i))
+    utils.wait(system.reader, count=5)
+
+    async def run():
+        batches = system.reader.take_async_batches(max_batch_size=2)
+        sizes = []
+        async for batch in batches:
+            sizes.append(len(batch))
+            if sum(sizes) == 5:
+                batches.close()
+        return sizes
+
+    assert event_loop.run_until_complete(run()) == [2, 2, 1]
+
+
+def test_executor_pool(event_loop):
+    system = utils.TestSystem(DOMAIN_ID, "StringTopicType")
+    participant = system.writer.publisher.participant
+    assert participant.executor_pool is None
+    pool = dds.ExecutorPool(thread_count=2, name_prefix="test")
+    assert pool.thread_count == 2
+    participant.executor_pool = pool
+    assert participant.executor_pool is pool
+
+    async def run():
+        await asyncio.gather(*[system.writer.write_async(str(i)) for i in range(4)])
+        await system.writer.wait_for_acknowledgments_async(dds.Duration(10))
+
+    event_loop.run_until_complete(run())
+    utils.wait(system.reader, count=4)
+    metrics = pool.metrics
+    assert metrics.submitted == 5
+    assert metrics.completed == 5
+    assert metrics.queue_depth == 0
+    assert 1 <= metrics.max_queue_depth <= 5
+    assert metrics.max_run_time >= metrics.mean_run_time
+    pool.reset_metrics()
+    assert pool.metrics.submitted == 0
+
+    # The WaitSet has no participant and uses the default pool
+    default_submitted = dds.ExecutorPool.default.metrics.submitted
+    guard = dds.GuardCondition()
+    guard.trigger_value = True
+    waitset = dds.WaitSet()
+    waitset += guard
+
+    async def wait():
+        return await waitset.wait_async(dds.Duration(1))
+
+    assert guard in event_loop.run_until_complete(wait())
+    assert dds.ExecutorPool.default.metrics.submitted == default_submitted + 1
+
+    participant.executor_pool = None
+    pool.close()
+    assert pool.closed
+
+
+
+def test_executor_pool_close_cancels_queued(event_loop):
+    pool = dds.ExecutorPool(thread_count=1)
+    dds.ExecutorPool.default = pool
+    guard = dds.GuardCondition()
+    waitset = dds.WaitSet()
+    waitset += guard
+
+    async def run():
+        # The first wait occupies the only thread; the second stays queued
+        running = waitset.wait_async(dds.Duration.from_milliseconds(500))
+        queued = waitset.wait_async(dds.Duration.from_milliseconds(500))
+        await asyncio.sleep(0.1)
+        pool.close()
+        with pytest.raises(asyncio.CancelledError):
+            await queued
+        await asyncio.gather(running, return_exceptions=True)
+
+    try:
+        event_loop.run_until_complete(asyncio.wait_for(run(), 10))
+    finally:
+        dds.ExecutorPool.default = None
+    assert pool.closed
+
+
+def test_merged_reader_async(event_loop):
+    system = utils.TestSystem(DOMAIN_ID, "StringTopicType")
+    topic = dds.StringTopicType.Topic(system.participant, "StringTopicType2")
+    reader = dds.StringTopicType.DataReader(
+        system.participant, topic, system.reader.qos
+    )
+    writer = dds.StringTopicType.DataWriter(
+        system.participant, topic, system.writer.qos
+    )
+
+    def write():
+        for i in range(4):
+            w = system.writer if i % 2 == 0 else writer
+            w.write(str(i), dds.Time(100 + i))
+
+    async def run():
+        received = []
+        merged = dds.StringTopicType.MergedReader(
+            [system.reader, reader], max_latency=dds.Duration.from_milliseconds(200)
+        )
+        threading.Timer(0.1, write).start()
+        async for batch in merged:
+            received.extend(s.data for s in batch)
+            if len(received) == 4:
+                merged.close()
+        return received
+
+    assert event_loop.run_until_complete(run()) == [str(i) for i in range(4)]
+
@@ -0,0 +1,117 @@
+ #
+ # (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ #
+ # RTI grants Licensee a license to use, modify, compile, and create derivative
+ # works of the Software solely for use with RTI products.  The Software is
+ # provided "as is", with no warranty of any type, including any warranty for
+ # fitness for any purpose. RTI is under no obligation to maintain or support
+ # the Software.  RTI shall not be liable for any incidental or consequential
+ # damages arising out of the use or inability to use the software.
+ #
+
+import rti.connextdds as dds
+import pytest
+import utils
+
+DOMAIN_ID = 0
+
+
+def test_bytes_buffer_protocol():
+    payload = bytes(range(256)) * 16
+    for source in (payload, bytearray(payload), memoryview(payload)):
+        sample = dds.BytesTopicType(source)
+        assert len(sample) == len(payload)
+        assert bytes(sample) == payload
+
+    sample = dds.BytesTopicType(payload)
+    view = memoryview(sample)
+    assert view.format == "B"
+    assert view.nbytes == len(payload)
+    view[0] = 42
+    assert sample[0] == 42
+
+    # Same length: copied in place, so the view sees the new contents
+    sample.data = bytearray(len(payload))
+    assert view[0] == 0
+    # Resizing would free the memory the view points to
+    with pytest.raises(BufferError):
+        sample.data = b"abc"
+    with pytest.raises(BufferError):
+        sample.data = [1, 2]
+    assert len(sample) == len(payload)
+    view.release()
+
+    sample.data = b"abc"
+    assert sample.data == [97, 98, 99]
+    sample.data = [1, 2]
+    assert bytes(sample) == b"\x01\x02"
+    assert bytes(dds.BytesTopicType()) == b""
+    assert memoryview(dds.BytesTopicType()).nbytes == 0
+
+
+def test_keyed_bytes_buffer_protocol():
+    sample = dds.KeyedBytesTopicType("key", b"\x01\x02\x03")
+    assert sample.key == "key"
+    assert bytes(sample) == b"\x01\x02\x03"
+    assert dds.KeyedBytesTopicType(("k", bytearray(b"xy"))).value == [120, 121]
+    memoryview(sample)[1] = 9
+    assert sample.value == [1, 9, 3]
+    sample.value = memoryview(b"zz")
+    assert bytes(sample) == b"zz"
+    with memoryview(sample) as view:
+        with pytest.raises(BufferError):
+            sample.value = b"longer"
+        assert bytes(view) == b"zz"
+    sample.value = b"longer"
+    assert bytes(sample) == b"longer"
+
+
+def test_string_types_from_buffers():
+    assert dds.StringTopicType(bytearray(b"hello")).data == "hello"
+    sample = dds.StringTopicType()
+    sample.data = memoryview(b"world")
+    assert bytes(sample) == b"world"
+    with pytest.raises(ValueError):
+        sample.data = b"a\x00b"
+
+    keyed = dds.KeyedStringTopicType("key", bytearray(b"value"))
+    assert keyed.value == "value"
+    keyed.value = memoryview(b"other")
+    assert keyed.value == "other"
+
+
+def test_write_bytes_like():
+    participant = utils.create_participant(DOMAIN_ID)
+    topic = dds.BytesTopicType.Topic(participant, "BytesTopicType")
+    reader_qos = participant.implicit_subscriber.default_datareader_qos
+    reader_qos << dds.Durability.transient_local
+    reader_qos << dds.Reliability.reliable()
+    reader_qos << dds.History.keep_all
+    writer_qos = participant.implicit_publisher.default_datawriter_qos
+    writer_qos << dds.Durability.transient_local
+    writer_qos << dds.Reliability.reliable()
+    writer_qos << dds.History.keep_all
+    reader = dds.BytesTopicType.DataReader(participant, topic, reader_qos)
+    writer = dds.BytesTopicType.DataWriter(participant, topic, writer_qos)
+
+    payload = bytes(range(100)) * 100
+    writer.write(dds.BytesTopicType(payload))
+    writer.write(dds.BytesTopicType(bytearray(payload[:10])))
+    utils.wait(reader, count=2)
+    samples = reader.take()
+    assert bytes(samples[0].data) == payload
+    assert bytes(samples[1].data) == payload[:10]
+
+
+def test_take_into_exported_bytes():
+    participant = utils.create_participant(DOMAIN_ID)
+    topic = dds.BytesTopicType.Topic(participant, "BytesTopicType")
+    reader = dds.BytesTopicType.DataReader(participant, topic)
+    sample = dds.BytesTopicType(b"abc")
+    info = dds.SampleInfo()
+    with memoryview(sample):
+        with pytest.raises(BufferError):
+            reader.take_into([sample], [info])
+        with pytest.raises(BufferError):
+            reader.take_next_into(sample, info)
+    assert reader.take_into([sample], [info]) == 0
@@ -67,3 +67,41 @@ def test_sending_dict():
             # Makes for easy debugging
             assert type(s2.data) == type(s1)
             assert s2.data == s1
+
+
+def test_sending_dicts_reuses_clean_sample():
+    system = utils.TestSystem(0, "PerformanceTest")
+    system.writer.write({"myID": 7, "myOctSeq": [1, 2, 3]})
+    system.writer.write({"myID": 8})
+    utils.wait(system.reader, count=2)
+    samples = system.reader.take()
+    assert samples[0].data["myID"] == 7
+    assert len(samples[0].data["myOctSeq"]) == 3
+    # Fields missing from the dictionary must not leak from a previous write
+    assert samples[1].data["myID"] == 8
+    assert len(samples[1].data["myOctSeq"]) == 0
+
+
+def test_dict_round_trip():
+    nested = dds.StructType("Nested")
+    nested.add_member(dds.Member("coord", COORD_TYPE))
+    nested.add_member(dds.Member("coords", dds.SequenceType(COORD_TYPE, 5)))
+    nested.add_member(dds.Member("values", dds.SequenceType(dds.Int32Type(), 5)))
+
+    my_dict = {
+        "coord": {"x": 1, "y": 2},
+        "coords": [{"x": 3, "y": 4}, {"x": 5, "y": 6}],
+        "values": [7, 8, 9],
+    }
+    sample = dds.DynamicData(nested, my_dict)
+    assert sample["coord.y"] == 2
+    assert sample["coords[1].x"] == 5
+    assert sample.to_dict() == my_dict
+
+    # Keys that are not the interned member names are found by value
+    key = "".join(["co", "ord"])
+    sample.update({key: {"x": 10}})
+    assert sample.to_dict()["coord"] == {"x": 10, "y": 0}
+
+    with pytest.raises(dds.InvalidArgumentError):
+        dds.DynamicData(COORD_TYPE, {"z": 1})
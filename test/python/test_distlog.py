@@ -0,0 +1,147 @@
+ #
+ # (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ #
+ # RTI grants Licensee a license to use, modify, compile, and create derivative
+ # works of the Software solely for use with RTI products.  The Software is
+ # provided "as is", with no warranty of any type, including any warranty for
+ # fitness for any purpose. RTI is under no obligation to maintain or support
+ # the Software.  RTI shall not be liable for any incidental or consequential
+ # damages arising out of the use or inability to use the software.
+ #
+
+import rti.connextdds as dds
+import rti.logging.distlog as distlog
+import pytest
+import threading
+import time
+
+MESSAGE_COUNT = 2000
+
+
+@pytest.fixture
+def logger():
+    distlog.Logger.init()
+    yield distlog.Logger
+    distlog.Logger.disable_async()
+
+
+def wait_for(condition, timeout=10):
+    deadline = time.time() + timeout
+    while not condition():
+        if time.time() > deadline:
+            return False
+        time.sleep(0.01)
+    return True
+
+
+def log_from_threads(logger, count, thread_count=4):
+    def run(index):
+        for i in range(count // thread_count):
+            logger.info("message {} from thread {}".format(i, index))
+
+    threads = [
+        threading.Thread(target=run, args=(i,)) for i in range(thread_count)
+    ]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+
+def test_async_enable_disable(logger):
+    assert not logger.async_enabled()
+    with pytest.raises(dds.PreconditionNotMetError):
+        logger.async_metrics()
+    with pytest.raises(dds.InvalidArgumentError):
+        logger.enable_async(capacity=0)
+    with pytest.raises(dds.InvalidArgumentError):
+        logger.enable_async(batch_size=0)
+    with pytest.raises(dds.InvalidArgumentError):
+        logger.enable_async(sample_rate=0)
+
+    logger.enable_async(capacity=100)
+    assert logger.async_enabled()
+    metrics = logger.async_metrics()
+    # Rounded up to a power of two
+    assert metrics.capacity == 128
+    assert metrics.queued == 0
+    assert metrics.dropped == 0
+    assert metrics.published == 0
+    assert metrics.depth == 0
+
+    logger.disable_async()
+    assert not logger.async_enabled()
+    # Logging synchronously again
+    logger.info("synchronous message")
+
+
+def test_async_drop_oldest(logger):
+    logger.enable_async(
+        capacity=4, overflow_policy=distlog.OverflowPolicy.DROP_OLDEST
+    )
+    log_from_threads(logger, MESSAGE_COUNT)
+    metrics = logger.async_metrics()
+    # Every record is queued; the ones dropped to make room were queued too
+    assert metrics.queued == MESSAGE_COUNT
+    assert wait_for(
+        lambda: logger.async_metrics().published
+        + logger.async_metrics().dropped
+        == MESSAGE_COUNT
+    )
+    assert logger.async_metrics().depth == 0
+
+
+def test_async_block(logger):
+    logger.enable_async(
+        capacity=4, overflow_policy=distlog.OverflowPolicy.BLOCK, batch_size=2
+    )
+    log_from_threads(logger, MESSAGE_COUNT)
+    assert logger.async_metrics().queued == MESSAGE_COUNT
+    assert wait_for(
+        lambda: logger.async_metrics().published == MESSAGE_COUNT
+    )
+    metrics = logger.async_metrics()
+    assert metrics.dropped == 0
+    assert metrics.depth == 0
+
+
+def test_async_sample(logger):
+    logger.enable_async(
+        capacity=4,
+        overflow_policy=distlog.OverflowPolicy.SAMPLE,
+        sample_rate=5,
+    )
+    log_from_threads(logger, MESSAGE_COUNT)
+    metrics = logger.async_metrics()
+    # Records are either queued or discarded, never both
+    assert metrics.queued + metrics.dropped == MESSAGE_COUNT
+    assert wait_for(
+        lambda: logger.async_metrics().published
+        == logger.async_metrics().queued
+    )
+    assert logger.async_metrics().depth == 0
+
+
+def test_async_disable_while_logging(logger):
+    stop = threading.Event()
+
+    def run():
+        while not stop.is_set():
+            logger.info("message")
+
+    threads = [threading.Thread(target=run) for _ in range(4)]
+    for t in threads:
+        t.start()
+    # Producers race with the sink being closed and replaced
+    for policy in [
+        distlog.OverflowPolicy.DROP_OLDEST,
+        distlog.OverflowPolicy.BLOCK,
+        distlog.OverflowPolicy.SAMPLE,
+    ] * 3:
+        logger.enable_async(capacity=8, overflow_policy=policy)
+        time.sleep(0.02)
+        logger.disable_async()
+    stop.set()
+    for t in threads:
+        t.join()
+    assert not logger.async_enabled()
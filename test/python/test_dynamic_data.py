@@ -238,6 +238,32 @@ def test_dynamic_data_buffer_numpy():
         data["myLongSeq"] = my_array_short
 
 
+def test_dynamic_data_get_values_numpy():
+    np = pytest.importorskip("numpy")
+    data = dds.DynamicData(COMPLEX)
+    data["myLongSeq"] = np.arange(10, dtype=np.int32)
+
+    values = data.get_values_array("myLongSeq")
+    assert values.dtype == np.int32
+    assert np.array_equal(values, np.arange(10, dtype=np.int32))
+    assert np.array_equal(
+        data.get_values_array(COMPLEX.compile_path("myLongSeq")), values
+    )
+
+    out = np.zeros(16, np.int32)
+    assert data.get_values_into("myLongSeq", out) == 10
+    assert np.array_equal(out[:10], values)
+
+    with pytest.raises(ValueError):
+        data.get_values_into("myLongSeq", np.zeros(4, np.int32))
+
+    with pytest.raises(TypeError):
+        data.get_values_into("myLongSeq", np.zeros(16, np.int16))
+
+    with pytest.raises(TypeError):
+        data.get_values_array("myEnum")
+
+
 def test_union():
     test_union = dds.DynamicData(UNION)
     simple = dds.DynamicData(SIMPLE)
@@ -282,3 +308,86 @@ def test_multidim_array():
     assert(info.index == 1)
 
 
+def test_compiled_path():
+    data = dds.DynamicData(COMPLEX)
+    seq_path = COMPLEX.compile_path("myLongSeq")
+    elem_path = COMPLEX.compile_path("myLongSeq[2]")
+    multi_path = COMPLEX.compile_path("myMultiDimArray[1, 0, 1]")
+    enum_path = COMPLEX.compile_path("myEnum")
+    assert str(elem_path) == "myLongSeq[2]"
+
+    data[seq_path] = list(range(1, 11))
+    assert data[elem_path] == 3
+    assert data.get_values(seq_path) == dds.Int32Seq(list(range(1, 11)))
+    data[elem_path] = 42
+    assert data["myLongSeq[2]"] == 42
+
+    data[multi_path] = 7
+    assert data["myMultiDimArray[1, 0, 1]"] == 7
+    assert data.get_value(multi_path) == 7
+
+    data[enum_path] = ENUM_TYPE["GREEN"]
+    assert data[enum_path] == ENUM_TYPE["GREEN"]
+
+    union_sample = dds.DynamicData(UNION_DEFAULT_TYPE)
+    key_path = UNION_DEFAULT_TYPE.compile_path("case1.key")
+    union_sample[key_path] = 234
+    assert union_sample.member_exists("case1")
+    assert union_sample[key_path] == 234
+
+    with pytest.raises(dds.InvalidArgumentError):
+        COMPLEX.compile_path("nonexistent")
+
+    with pytest.raises(dds.InvalidArgumentError):
+        COMPLEX.compile_path("myMultiDimArray[0][0][0]")
+
+    with pytest.raises(dds.InvalidArgumentError):
+        COMPLEX.compile_path("myString[0]")
+
+
+def test_cdr_buffer_protocol():
+    data = dds.DynamicData(PRIMITIVES)
+    data["myLong"] = 42
+    data["myDouble"] = 1.5
+
+    cdr = data.to_cdr_bytes()
+    assert isinstance(cdr, bytes)
+    assert list(cdr) == [x & 0xFF for x in data.to_cdr_buffer()]
+
+    buffer = bytearray(len(cdr) + 8)
+    assert data.to_cdr_into(buffer, 8) == len(cdr)
+    assert bytes(buffer[8:]) == cdr
+    with pytest.raises(ValueError):
+        data.to_cdr_into(bytearray(len(cdr) - 1))
+
+    copy = dds.DynamicData(PRIMITIVES)
+    copy.from_cdr_buffer(memoryview(buffer)[8:])
+    assert copy == data
+
+
+def test_to_dict():
+    data = dds.DynamicData(COMPLEX)
+    data["myLongSeq"] = [1, 2, 3]
+    data["myString"] = "hello"
+    data["myStringSeq"] = ["a", "b"]
+    data["myEnum"] = ENUM_TYPE["GREEN"]
+
+    assert data.to_dict() == {
+        "myLongSeq": [1, 2, 3],
+        "myLongArray": [0] * 10,
+        "myOptional": None,
+        "myString": "hello",
+        "myStringSeq": ["a", "b"],
+        "myEnum": 3,
+        "myEnumSeq": [],
+        "myMultiDimArray": [0] * 8,
+    }
+    data["myOptional"] = 5
+    assert data.to_dict()["myOptional"] == 5
+
+    test_union = dds.DynamicData(UNION)
+    simple = dds.DynamicData(SIMPLE)
+    simple["key"] = 10
+    simple["value"] = 20
+    test_union["red_green"] = simple
+    assert test_union.to_dict() == {"red_green": {"key": 10, "value": 20}}
@@ -0,0 +1,428 @@
+ #
+ # (c) 2020 Copyright, Real-Time Innovations, Inc.  All rights reserved.
+ #
+ # RTI grants Licensee a license to use, modify, compile, and create derivative
+ # works of the Software solely for use with RTI products.  The Software is
+ # provided "as is", with no warranty of any type, including any warranty for
+ # fitness for any purpose. RTI is under no obligation to maintain or support
+ # the Software.  RTI shall not be liable for any incidental or consequential
+ # damages arising out of the use or inability to use the software.
+ #
+
+import rti.connextdds as dds
+import pytest
+import threading
+import time
+import utils
+
+DOMAIN_ID = 0
+
+
+def test_loaned_samples_to_columns():
+    np = pytest.importorskip("numpy")
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    sample = system.writer.create_data()
+    for i in range(5):
+        sample["myID"] = i
+        system.writer.write(sample, dds.Time(100 + i))
+    utils.wait(system.reader, count=5)
+
+    id_path = sample.type.compile_path("myID")
+    with system.reader.take() as samples:
+        columns = samples.to_columns(["myID"])
+        compiled = samples.to_columns([id_path], info_fields=[])
+
+    assert np.array_equal(columns["myID"], np.arange(5, dtype=np.int32))
+    assert np.array_equal(compiled["myID"], columns["myID"])
+    assert columns["valid"].all()
+    assert list(columns["source_timestamp"]) == [
+        (100 + i) * 1000000000 for i in range(5)
+    ]
+    assert columns["instance_handle"].shape == (5,)
+    assert list(compiled.keys()) == ["myID"]
+
+    with system.reader.take() as samples:
+        columns = samples.to_columns(["myID"], info_fields=["valid"])
+        assert len(columns["myID"]) == 0
+        assert len(columns["valid"]) == 0
+
+    with pytest.raises(TypeError):
+        with system.reader.read() as samples:
+            samples.to_columns([sample.type.compile_path("myOctSeq")])
+
+
+def test_write_columns():
+    np = pytest.importorskip("numpy")
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    ids = np.arange(5, dtype=np.int32)
+    timestamps = np.arange(100, 105, dtype=np.int64) * 1000000000
+    system.writer.write_columns({"myID": ids}, timestamps=timestamps)
+    utils.wait(system.reader, count=5)
+
+    with system.reader.take() as samples:
+        columns = samples.to_columns(["myID"])
+    assert np.array_equal(columns["myID"], ids)
+    assert np.array_equal(columns["source_timestamp"], timestamps)
+
+    with pytest.raises(TypeError):
+        system.writer.write_columns({"myID": ids.astype(np.int64)})
+
+    with pytest.raises(ValueError):
+        system.writer.write_columns({"myID": ids}, timestamps=timestamps[:2])
+
+
+def test_instances_from_key_columns():
+    np = pytest.importorskip("numpy")
+    keyed_type = dds.StructType("KeyedLong")
+    keyed_type.add_member(dds.Member("id", dds.Int32Type(), is_key=True))
+    keyed_type.add_member(dds.Member("value", dds.Int32Type()))
+    participant = dds.DomainParticipant(DOMAIN_ID)
+    topic = dds.DynamicData.Topic(participant, "KeyedLong", keyed_type)
+    writer = dds.DynamicData.DataWriter(dds.Publisher(participant), topic)
+
+    ids = np.arange(5, dtype=np.int32)
+    handles = writer.register_instances({"id": ids})
+    assert len(handles) == 5
+    assert list(writer.lookup_instances({"id": ids})) == list(handles)
+    sample = writer.create_data()
+    sample["id"] = 3
+    assert writer.lookup_instance(sample) == handles[3]
+
+    timestamps = np.full(2, 200 * 1000000000, dtype=np.int64)
+    writer.dispose_instances({"id": ids[:2]}, timestamps=timestamps)
+    writer.unregister_instances({"id": ids})
+    assert all(h.is_nil for h in writer.lookup_instances({"id": ids}))
+
+    with pytest.raises(TypeError):
+        writer.lookup_instances({"id": ids.astype(np.int64)})
+
+def test_loaned_samples_to_cdr_bytes():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    sample = system.writer.create_data()
+    for i in range(3):
+        sample["myID"] = i
+        system.writer.write(sample)
+    utils.wait(system.reader, count=3)
+
+    with system.reader.take() as samples:
+        buffer = memoryview(samples.to_cdr_bytes())
+
+    received = []
+    while len(buffer) > 0:
+        length = int.from_bytes(buffer[:4], "little")
+        data = system.writer.create_data()
+        data.from_cdr_buffer(buffer[4 : 4 + length])
+        received.append(data["myID"])
+        buffer = buffer[4 + length :]
+    assert received == [0, 1, 2]
+
+
+def test_loaned_samples_to_dicts():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    sample = system.writer.create_data()
+    for i in range(3):
+        sample["myID"] = i
+        sample["myOctSeq"] = [i] * i
+        system.writer.write(sample)
+    utils.wait(system.reader, count=3)
+
+    with system.reader.take() as samples:
+        dicts = samples.to_dicts()
+    assert [d["myID"] for d in dicts] == [0, 1, 2]
+    assert [d["myOctSeq"] for d in dicts] == [[], [1], [2, 2]]
+
+
+def test_loaned_samples_views():
+    point = dds.StructType("ViewPoint")
+    point.add_member(dds.Member("x", dds.Int32Type()))
+    point.add_member(dds.Member("y", dds.Int32Type()))
+    shape = dds.StructType("ViewShape")
+    shape.add_member(dds.Member("id", dds.Int32Type()))
+    shape.add_member(dds.Member("center", point))
+    shape.add_member(dds.Member("points", dds.SequenceType(point, 4)))
+
+    participant = utils.create_participant(DOMAIN_ID)
+    topic = dds.DynamicData.Topic(participant, "ViewShape", shape)
+    writer_qos = participant.implicit_publisher.default_datawriter_qos
+    writer_qos << dds.Reliability.reliable()
+    writer_qos << dds.Durability.transient_local
+    reader_qos = participant.implicit_subscriber.default_datareader_qos
+    reader_qos << dds.Reliability.reliable()
+    reader_qos << dds.Durability.transient_local
+    writer = dds.DynamicData.DataWriter(participant.implicit_publisher, topic, writer_qos)
+    reader = dds.DynamicData.DataReader(participant.implicit_subscriber, topic, reader_qos)
+
+    writer.write(
+        dds.DynamicData(
+            shape,
+            {"id": 1, "center": {"x": 2, "y": 3}, "points": [{"x": 4, "y": 5}]},
+        )
+    )
+    utils.wait(reader)
+
+    samples = reader.take()
+    view, info = samples.views()[0]
+    assert info.valid
+    center = view["center"]
+    assert isinstance(center, dds.DynamicData.View)
+    assert center.path == "center"
+    assert center["y"] == 3
+    assert view["points"][0]["x"] == 4
+    assert len(view["points"]) == 1
+    assert view["points[0].y"] == 5
+    # Compiled paths are relative to the view, like string keys
+    assert center[point.compile_path("x")] == 2
+    assert view[shape.compile_path("center.y")] == 3
+    assert center.to_dict() == {"x": 2, "y": 3}
+    copy = view.copy()
+
+    samples.return_loan()
+    assert not center.valid
+    with pytest.raises(dds.AlreadyClosedError):
+        center["x"]
+    assert copy["center.x"] == 2
+
+
+def test_windowed_aggregator():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    specs = [
+        ("myID", "count", dds.Duration(5)),
+        ("myID", "mean", dds.Duration(5)),
+        ("myID", "max", dds.Duration(100)),
+        ("myID", "p50", dds.Duration(100)),
+    ]
+    with dds.WindowedAggregator(system.reader, specs) as aggregator:
+        sample = system.writer.create_data()
+        for i in range(10):
+            sample["myID"] = i
+            system.writer.write(sample, dds.Time(100 + i))
+        for _ in range(100):
+            if aggregator.sample_count == 10:
+                break
+            time.sleep(0.1)
+
+        results = {r.aggregate: r for r in aggregator.results()}
+        # The 5s windows end at the newest timestamp and hold ids 4 to 9
+        assert results["count"].value == 6
+        assert results["count"].count == 6
+        assert results["mean"].value == 6.5
+        assert results["max"].value == 9
+        assert results["p50"].value == 4.5
+        assert results["max"].count == 10
+        assert results["max"].window_end == dds.Time(109)
+        assert results["mean"].path == "myID"
+        # The samples were taken from the reader
+        assert len(system.reader.read()) == 0
+    assert aggregator.closed
+
+
+def test_windowed_aggregator_callback():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    batches = []
+    aggregator = dds.WindowedAggregator(
+        system.reader,
+        [("myID", "sum", dds.Duration(60))],
+        period=dds.Duration.from_milliseconds(50),
+        callback=batches.append,
+    )
+    sample = system.writer.create_data()
+    for i in range(3):
+        sample["myID"] = i
+        system.writer.write(sample)
+    for _ in range(100):
+        if batches and batches[-1] and batches[-1][0].value == 3:
+            break
+        time.sleep(0.1)
+    aggregator.close()
+    assert batches[-1][0].count == 3
+    assert batches[-1][0].value == 3
+
+
+
+def test_windowed_aggregator_closed_from_callback():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    holder = {}
+    done = threading.Event()
+
+    def callback(results):
+        # Closes and drops the last reference from the aggregator's thread
+        holder.pop("aggregator").close()
+        done.set()
+
+    holder["aggregator"] = dds.WindowedAggregator(
+        system.reader,
+        [("myID", "sum", dds.Duration(60))],
+        period=dds.Duration.from_milliseconds(20),
+        callback=callback,
+    )
+    assert done.wait(10)
+    time.sleep(0.1)
+    assert "aggregator" not in holder
+
+
+def test_windowed_aggregator_invalid_specs():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    with pytest.raises(dds.InvalidArgumentError):
+        dds.WindowedAggregator(
+            system.reader, [("myID", "median", dds.Duration(1))]
+        )
+    with pytest.raises(dds.InvalidArgumentError):
+        dds.WindowedAggregator(
+            system.reader, [("myID", "p101", dds.Duration(1))]
+        )
+    with pytest.raises(TypeError):
+        dds.WindowedAggregator(
+            system.reader, [("myOctSeq", "mean", dds.Duration(1))]
+        )
+    with pytest.raises(dds.InvalidArgumentError):
+        dds.WindowedAggregator(
+            system.reader,
+            [("myID", "mean", dds.Duration(1))],
+            callback=print,
+        )
+
+
+def predicate_type():
+    point = dds.StructType("Point")
+    point.add_member(dds.Member("x", dds.Float64Type()))
+    point.add_member(dds.Member("y", dds.Float64Type()))
+    vehicle = dds.StructType("Vehicle")
+    vehicle.add_member(dds.Member("id", dds.Int32Type()))
+    vehicle.add_member(dds.Member("flags", dds.Uint32Type()))
+    vehicle.add_member(dds.Member("serial", dds.Uint64Type()))
+    vehicle.add_member(dds.Member("color", dds.StringType(16)))
+    vehicle.add_member(dds.Member("position", point))
+    return vehicle
+
+
+def test_predicate_filter_matches():
+    sample = dds.DynamicData(predicate_type())
+    sample["id"] = 7
+    sample["flags"] = 0b1101
+    sample["color"] = "RED"
+    sample["position.x"] = 1.5
+    sample["position.y"] = 2.5
+
+    square = [(0, 0), (0, 10), (10, 10), (10, 0)]
+    matches = dds.PredicateFilter.matches
+    assert matches(("==", "id", 7), sample)
+    assert not matches(("!=", "id", 7), sample)
+    assert matches(("between", "position.x", 1, 2), sample)
+    assert matches(("in", "color", ["RED", "BLUE"]), sample)
+    assert matches(("not_in", "id", {1, 2, 3}), sample)
+    assert matches(("all_bits", "flags", 0b0101), sample)
+    assert not matches(("any_bits", "flags", 0b0010), sample)
+    assert matches(("in_polygon", ("position.x", "position.y"), square), sample)
+    assert matches(
+        (
+            "and",
+            (">", "id", 5),
+            ("or", ("<", "position.y", 0), ("not", ("==", "color", "BLUE"))),
+        ),
+        sample,
+    )
+
+    parameter = dds.PredicateFilter.Parameter(0)
+    assert matches(("in", "id", parameter), sample, ["(5 6 7)"])
+    assert not matches(("<", "position.x", parameter), sample, ["1.5"])
+    assert matches("(>= position.x %0)", sample, ["1.5"])
+
+    assert (
+        dds.PredicateFilter.expression(("in", "color", ["A", 'say "hi"']))
+        == '(in color ("A" "say \\"hi\\""))'
+    )
+
+    # uint64 values past the int64 range compare as unsigned
+    sample["serial"] = 2 ** 63 + 1
+    assert matches((">", "serial", 2 ** 63), sample)
+    assert matches((">", "serial", -1), sample)
+    assert matches(("in", "serial", [2 ** 63 + 1]), sample)
+    assert not matches(("in", "serial", [-(2 ** 63) + 1]), sample)
+    assert matches(("all_bits", "serial", 2 ** 63 + 1), sample)
+
+    with pytest.raises(dds.InvalidArgumentError):
+        matches(("<", "color", 3), sample)
+    with pytest.raises(dds.InvalidArgumentError):
+        matches(("all_bits", "position.x", 1), sample)
+    with pytest.raises(dds.InvalidArgumentError):
+        matches("(< id", sample)
+
+
+def test_predicate_content_filtered_topic():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    system.participant.register_contentfilter(
+        dds.PredicateFilter(), dds.PredicateFilter.filter_name
+    )
+    cft = dds.DynamicData.ContentFilteredTopic(
+        system.topic,
+        "PerformanceTestCft",
+        dds.PredicateFilter.filter(
+            ("in", "myID", dds.PredicateFilter.Parameter(0)), ["(1 3)"]
+        ),
+    )
+    reader = dds.DynamicData.DataReader(
+        system.participant.implicit_subscriber, cft, system.reader.qos
+    )
+    sample = system.writer.create_data()
+    for i in range(5):
+        sample["myID"] = i
+        system.writer.write(sample)
+    utils.wait(system.reader, count=5)
+    utils.wait(reader, count=2)
+    time.sleep(0.5)
+    assert [s.data["myID"] for s in reader.take()] == [1, 3]
+
+
+class ThresholdBatchFilter(dds.DynamicData.WriterContentFilterBatch):
+    def __init__(self):
+        super().__init__()
+        self.batch_sizes = []
+
+    def compile(self, expression, parameters, type_code, type_class_name, old):
+        return int(parameters[0])
+
+    def evaluate(self, compile_data, sample, meta_data):
+        return sample["myID"] < compile_data
+
+    def finalize(self, compile_data):
+        pass
+
+    def evaluate_batch(self, compile_data, sample, meta_data):
+        self.batch_sizes.append(len(compile_data))
+        value = sample["myID"]
+        return [value < threshold for threshold in compile_data]
+
+
+def test_writer_content_filter_batch():
+    content_filter = ThresholdBatchFilter()
+    assert not content_filter.key_only
+    content_filter.key_only = True
+    assert content_filter.key_only
+    content_filter.key_only = False
+
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    system.participant.register_contentfilter(content_filter, "ThresholdFilter")
+    readers = []
+    for threshold in (2, 4):
+        cft_filter = dds.Filter("myID < %0", [str(threshold)])
+        cft_filter.name = "ThresholdFilter"
+        cft = dds.DynamicData.ContentFilteredTopic(
+            system.topic, "ThresholdCft" + str(threshold), cft_filter
+        )
+        readers.append(
+            dds.DynamicData.DataReader(
+                system.participant.implicit_subscriber, cft, system.reader.qos
+            )
+        )
+
+    sample = system.writer.create_data()
+    for i in range(5):
+        sample["myID"] = i
+        system.writer.write(sample)
+    utils.wait(readers[0], count=2)
+    utils.wait(readers[1], count=4)
+    time.sleep(0.5)
+    assert [s.data["myID"] for s in readers[0].take()] == [0, 1]
+    assert [s.data["myID"] for s in readers[1].take()] == [0, 1, 2, 3]
+    # Writer-side filtering, when used, evaluates both readers at once
+    assert all(size <= 2 for size in content_filter.batch_sizes)
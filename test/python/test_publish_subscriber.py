@@ -10,6 +10,9 @@
  #
 
 import rti.connextdds as dds
+import pytest
+import threading
+import time
 import utils
 
 DOMAIN_ID = 0
@@ -73,3 +76,354 @@ def test_write_w_operator_mix():
         dds.KeyedStringTopicType("hello", "hello"),
         dds.Time(123),
     )
+
+
+def test_batch_listener():
+    system = utils.TestSystem(DOMAIN_ID, "StringTopicType")
+    received = []
+    done = threading.Event()
+
+    class Listener(dds.StringTopicType.DataReaderBatchListener):
+        def __init__(self):
+            super().__init__(
+                max_batch_size=4, max_delay=dds.Duration.from_milliseconds(50)
+            )
+
+        def on_data_batch(self, reader, samples):
+            assert len(samples) > 0
+            received.extend(s.data for s in samples if s.info.valid)
+            if len(received) >= 10:
+                done.set()
+
+    listener = Listener()
+    assert listener.max_batch_size == 4
+    system.reader.bind_listener(listener, dds.StatusMask.data_available())
+    for i in range(10):
+        system.writer.write(str(i))
+
+    assert done.wait(10)
+    assert received == [str(i) for i in range(10)]
+    system.reader.bind_listener(None, dds.StatusMask.NONE)
+
+
+def test_batch_listener_unbound_from_callback():
+    system = utils.TestSystem(DOMAIN_ID, "StringTopicType")
+    done = threading.Event()
+
+    class Listener(dds.StringTopicType.DataReaderBatchListener):
+        def __init__(self):
+            super().__init__(max_batch_size=1)
+
+        def on_data_batch(self, reader, samples):
+            # Destroys the listener on its own dispatch thread
+            reader.bind_listener(None, dds.StatusMask.NONE)
+            done.set()
+
+    system.reader.bind_listener(Listener(), dds.StatusMask.data_available())
+    system.writer.write("first")
+    assert done.wait(10)
+
+    # Once stopped, samples are left in the reader
+    system.writer.write("second")
+    utils.wait(system.reader)
+    assert [s.data for s in system.reader.take()] == ["second"]
+
+
+def test_take_next_from_threads():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    count = 40
+    for i in range(count):
+        sample = system.writer.create_data()
+        sample["myID"] = i
+        system.writer.write(sample)
+    utils.wait(system.reader, count=count)
+
+    # take_next releases the GIL and resolves the reader's type concurrently
+    received = []
+    lock = threading.Lock()
+
+    def take_all():
+        while True:
+            sample = system.reader.take_next()
+            if sample is None:
+                return
+            with lock:
+                received.append(sample.data["myID"])
+
+    threads = [threading.Thread(target=take_all) for _ in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert sorted(received) == list(range(count))
+
+
+def test_entities_use_the_topic_type():
+    # The type map keeps the first type registered under a name, but each
+    # Topic, and the entities created from it, use the type it was given
+    participant = utils.create_participant(DOMAIN_ID)
+    type_a = dds.StructType("ShadowedType")
+    type_a.add_member(dds.Member("a", dds.Int32Type()))
+    type_b = dds.StructType("ShadowedType")
+    type_b.add_member(dds.Member("b", dds.Int32Type()))
+    dds.DynamicData.Topic(participant, "ShadowedTopicA", type_a)
+    topic = dds.DynamicData.Topic(participant, "ShadowedTopicB", type_b)
+    reader_qos = participant.implicit_subscriber.default_datareader_qos
+    reader_qos << dds.Reliability.reliable()
+    reader_qos << dds.History.keep_all
+    writer_qos = participant.implicit_publisher.default_datawriter_qos
+    writer_qos << dds.Reliability.reliable()
+    writer_qos << dds.History.keep_all
+    reader = dds.DynamicData.DataReader(
+        dds.Subscriber(participant), topic, reader_qos
+    )
+    writer = dds.DynamicData.DataWriter(
+        dds.Publisher(participant), topic, writer_qos
+    )
+    assert writer.create_data().type == type_b
+    writer.write({"b": 7})
+    utils.wait(reader)
+    assert reader.take_next().data["b"] == 7
+
+
+def test_take_into():
+    system = utils.TestSystem(DOMAIN_ID, "PerformanceTest")
+    for i in range(5):
+        sample = system.writer.create_data()
+        sample["myID"] = i
+        system.writer.write(sample)
+    utils.wait(system.reader, count=5)
+
+    # The samples and infos are filled in place and reused across calls
+    sample = system.writer.create_data()
+    info = dds.SampleInfo()
+    assert system.reader.read_next_into(sample, info)
+    assert info.valid
+    assert sample["myID"] == 0
+    # Only takes samples that haven't been read yet
+    assert system.reader.take_next_into(sample, info)
+    assert sample["myID"] == 1
+
+    samples = [system.writer.create_data() for _ in range(3)]
+    infos = [dds.SampleInfo() for _ in range(3)]
+    ids = []
+    while True:
+        count = system.reader.take_into(samples, infos)
+        if count == 0:
+            break
+        ids += [samples[i]["myID"] for i in range(count) if infos[i].valid]
+    assert ids == [0, 2, 3, 4]
+    assert not system.reader.take_next_into(sample, info)
+
+
+def test_last_value_cache():
+    system = utils.TestSystem(DOMAIN_ID, "KeyedStringTopicType")
+    with dds.KeyedStringTopicType.LastValueCache(system.reader) as cache:
+        for i in range(3):
+            system.writer.write(dds.KeyedStringTopicType("a", str(i)))
+        system.writer.write(dds.KeyedStringTopicType("b", "0"))
+
+        def latest():
+            return {s.data.key: s for s in cache.snapshot()}
+
+        for _ in range(100):
+            if "b" in latest() and latest()["a"].data.value == "2":
+                break
+            time.sleep(0.1)
+        handle_a = latest()["a"].info.instance_handle
+        assert handle_a in cache
+        assert len(cache) == 2
+        assert cache.get(handle_a).data.value == "2"
+        assert cache.get(dds.InstanceHandle.nil()) is None
+        assert sorted(s.data.key for s in cache.snapshot()) == ["a", "b"]
+        # The samples were taken from the reader
+        assert len(system.reader.read()) == 0
+
+        generation = cache.generation
+        changed, _ = cache.changed_since(generation)
+        assert changed == []
+        system.writer.write(dds.KeyedStringTopicType("b", "1"))
+        for _ in range(100):
+            changed, new_generation = cache.changed_since(generation)
+            if changed:
+                break
+            time.sleep(0.1)
+        assert [s.data.value for s in changed] == ["1"]
+        assert new_generation > generation
+        assert cache.stale(dds.Duration(60)) == []
+    assert cache.closed
+
+
+def test_instance_map():
+    system = utils.TestSystem(DOMAIN_ID, "KeyedStringTopicType")
+    for key in "abc":
+        system.writer.write(dds.KeyedStringTopicType(key, "0"))
+    system.writer.write(dds.KeyedStringTopicType("a", "1"))
+    utils.wait(system.reader, count=4)
+
+    instances = dds.KeyedStringTopicType.InstanceMap()
+    assert instances.update(system.reader.take()) == 4
+    assert len(instances) == 3
+    handle_a = system.writer.lookup_instance(dds.KeyedStringTopicType("a", ""))
+    assert handle_a in instances
+    assert instances[handle_a].value == "1"
+    assert sorted(s.key for s in instances.values()) == ["a", "b", "c"]
+    assert set(instances) == set(instances.keys())
+
+    # Handles hash by their key hash, like the native map
+    state = {h: v.key for h, v in instances.items()}
+    assert state[handle_a] == "a"
+    assert hash(handle_a) == hash(
+        system.writer.lookup_instance(dds.KeyedStringTopicType("a", ""))
+    )
+
+    handle_b = system.writer.lookup_instance(dds.KeyedStringTopicType("b", ""))
+    system.writer.dispose_instance(handle_b)
+    utils.wait(system.reader)
+    assert instances.update(system.reader.take()) == 1
+    assert handle_b not in instances
+    assert instances.get(handle_b) is None
+
+    instances[handle_b] = "b"
+    assert instances.pop(handle_b) == "b"
+    del instances[handle_a]
+    assert len(instances) == 1
+    instances.clear()
+    assert not instances
+
+
+def test_vectorized_instances():
+    system = utils.TestSystem(DOMAIN_ID, "KeyedStringTopicType")
+    keys = [dds.KeyedStringTopicType(str(i), "") for i in range(4)]
+    handles = system.writer.register_instances(keys)
+    assert len(handles) == 4
+    assert all(not h.is_nil for h in handles)
+    assert list(system.writer.lookup_instances(keys)) == list(handles)
+    unknown = system.writer.lookup_instances([dds.KeyedStringTopicType("x", "")])
+    assert unknown[0].is_nil
+
+    for key in keys:
+        system.writer.write(key)
+    utils.wait(system.reader, count=4)
+    system.reader.take()
+
+    system.writer.dispose_instances(handles[:2], dds.Time(200))
+    system.writer.dispose_instances(keys[2:])
+    utils.wait(system.reader, count=4)
+    samples = system.reader.take()
+    assert all(
+        s.info.state.instance_state == dds.InstanceState.NOT_ALIVE_DISPOSED
+        for s in samples
+    )
+
+    system.writer.unregister_instances(keys[:2])
+    system.writer.unregister_instances(handles[2:])
+    assert all(h.is_nil for h in system.writer.lookup_instances(keys))
+
+
+def test_merged_reader():
+    system = utils.TestSystem(DOMAIN_ID, "StringTopicType")
+    topic = dds.StringTopicType.Topic(system.participant, "StringTopicType2")
+    reader = dds.StringTopicType.DataReader(
+        system.participant, topic, system.reader.qos
+    )
+    writer = dds.StringTopicType.DataWriter(
+        system.participant, topic, system.writer.qos
+    )
+    for i in range(0, 6, 2):
+        system.writer.write(str(i), dds.Time(100 + i))
+    for i in range(1, 6, 2):
+        writer.write(str(i), dds.Time(100 + i))
+    utils.wait(system.reader, count=3)
+    utils.wait(reader, count=3)
+
+    with dds.StringTopicType.MergedReader(
+        [system.reader, reader],
+        max_latency=dds.Duration.from_milliseconds(200),
+        max_batch_size=4,
+    ) as merged:
+        received = []
+        for batch in merged:
+            assert len(batch) <= 4
+            received.extend(s.data for s in batch)
+            if len(received) == 6:
+                break
+        assert received == [str(i) for i in range(6)]
+        assert merged.merged_count == 6
+        assert merged.late_count == 0
+        assert merged.pending == 0
+        assert merged.take() == []
+        assert merged.wait(dds.Duration.from_milliseconds(10)) == []
+    assert merged.closed
+    assert list(merged) == []
+
+
+def test_sample_recorder_replayer(tmp_path):
+    system = utils.TestSystem(DOMAIN_ID, "KeyedStringTopicType")
+    path = str(tmp_path / "samples.log")
+    with dds.KeyedStringTopicType.SampleRecorder(path, system.reader) as recorder:
+        for i in range(4):
+            system.writer.write(
+                dds.KeyedStringTopicType("ab"[i % 2], str(i)), dds.Time(100 + i)
+            )
+        handle_b = system.writer.lookup_instance(dds.KeyedStringTopicType("b", ""))
+        system.writer.dispose_instance(handle_b, dds.Time(110))
+        for _ in range(100):
+            if recorder.record_count == 5:
+                break
+            time.sleep(0.1)
+        assert recorder.record_count == 5
+    assert recorder.closed
+    assert recorder.size > 0
+
+    topic = dds.KeyedStringTopicType.Topic(system.participant, "KeyedStringTopicType2")
+    reader = dds.KeyedStringTopicType.DataReader(
+        system.participant, topic, system.reader.qos
+    )
+    writer = dds.KeyedStringTopicType.DataWriter(
+        system.participant, topic, system.writer.qos
+    )
+    with dds.KeyedStringTopicType.SampleReplayer(path, writer, rate=0) as replayer:
+        assert replayer.type_name == system.topic.type_name
+        assert replayer.topic_names == [system.topic.name]
+        assert replayer.record_count == 5
+        assert replayer.wait(dds.Duration(10))
+        assert replayer.finished
+        assert replayer.replayed_count == 5
+
+    utils.wait(reader, count=4)
+    samples = reader.take()
+    assert [s.data.value for s in samples if s.info.valid] == ["0", "1", "2", "3"]
+    assert [s.info.source_timestamp for s in samples if s.info.valid] == [
+        dds.Time(100 + i) for i in range(4)
+    ]
+
+    # Only the instance "a", starting at the third sample
+    replayer = dds.KeyedStringTopicType.SampleReplayer(
+        path,
+        [writer],
+        rate=0,
+        start=dds.Time(101),
+        instance=system.writer.lookup_instance(dds.KeyedStringTopicType("a", "")),
+    )
+    assert replayer.wait(dds.Duration(10))
+    assert replayer.replayed_count == 1
+    utils.wait(reader)
+    assert [s.data.value for s in reader.take()] == ["2"]
+
+    other_topic = dds.KeyedStringTopicType.Topic(
+        system.participant, "KeyedStringTopicType3", "OtherTypeName"
+    )
+    other_writer = dds.KeyedStringTopicType.DataWriter(system.participant, other_topic)
+    with pytest.raises(dds.InvalidArgumentError):
+        dds.KeyedStringTopicType.SampleReplayer(path, other_writer)
+
+    # An index that doesn't match the log is rebuilt from the records
+    index_path = tmp_path / "samples.log.idx"
+    index = index_path.read_bytes()
+    index_path.write_bytes(index[:24] + b"\xff" * (len(index) - 24))
+    replayer = dds.KeyedStringTopicType.SampleReplayer(path, writer, rate=0)
+    assert replayer.record_count == 5
+    assert replayer.wait(dds.Duration(10))
+    assert replayer.replayed_count == 5
+